@@ -83,9 +83,22 @@ int main( int argc, char **argv )
 	VeyonCore::pluginManager().registerExtraPluginInterface( new ConfigCommands( core ) );
 	VeyonCore::pluginManager().registerExtraPluginInterface( new PluginsCommands( core ) );
 
+	const auto module = arguments.value( 1 );
+
+	// only load the plugin providing the requested module unless all modules have to be listed
+	QObjectList pluginObjects;
+	const auto modulePluginObject = VeyonCore::pluginManager().commandLinePluginObject( module );
+	if( modulePluginObject )
+	{
+		pluginObjects.append( modulePluginObject );
+	}
+	else
+	{
+		pluginObjects = VeyonCore::pluginManager().pluginObjects( CommandLinePluginInterface_iid );
+	}
+
 	QHash<CommandLinePluginInterface *, QObject *> commandLinePluginInterfaces;
-	const auto pluginObjects = VeyonCore::pluginManager().pluginObjects();
-	for( auto pluginObject : pluginObjects )
+	for( auto pluginObject : qAsConst(pluginObjects) )
 	{
 		auto commandLinePluginInterface = qobject_cast<CommandLinePluginInterface *>( pluginObject );
 		if( commandLinePluginInterface )
@@ -94,8 +107,6 @@ int main( int argc, char **argv )
 		}
 	}
 
-	const auto module = arguments.value( 1 );
-
 	for( auto it = commandLinePluginInterfaces.constBegin(), end = commandLinePluginInterfaces.constEnd(); it != end; ++it )
 	{
 		if( it.key()->commandLineModuleName() == module )
@@ -45,6 +45,7 @@ ServiceConfigurationPage::ServiceConfigurationPage( QWidget* parent ) :
 
 	Configuration::UiMapping::setFlags( ui->networkPortNumbersGroupBox, Configuration::Property::Flag::Advanced );
 	Configuration::UiMapping::setFlags( ui->miscNetworkSettingsGroupBox, Configuration::Property::Flag::Advanced );
+	Configuration::UiMapping::setFlags( ui->bandwidthGroupBox, Configuration::Property::Flag::Advanced );
 
 	updateServiceControl();
 	populateVncServerPluginComboBox();
@@ -68,6 +69,7 @@ void ServiceConfigurationPage::resetWidgets()
 {
 	FOREACH_VEYON_SERVICE_CONFIG_PROPERTY(INIT_WIDGET_FROM_PROPERTY);
 	FOREACH_VEYON_NETWORK_CONFIG_PROPERTY(INIT_WIDGET_FROM_PROPERTY);
+	FOREACH_VEYON_BANDWIDTH_CONFIG_PROPERTY(INIT_WIDGET_FROM_PROPERTY);
 	FOREACH_VEYON_VNC_SERVER_CONFIG_PROPERTY(INIT_WIDGET_FROM_PROPERTY);
 }
 
@@ -77,6 +79,7 @@ void ServiceConfigurationPage::connectWidgetsToProperties()
 {
 	FOREACH_VEYON_SERVICE_CONFIG_PROPERTY(CONNECT_WIDGET_TO_PROPERTY);
 	FOREACH_VEYON_NETWORK_CONFIG_PROPERTY(CONNECT_WIDGET_TO_PROPERTY);
+	FOREACH_VEYON_BANDWIDTH_CONFIG_PROPERTY(CONNECT_WIDGET_TO_PROPERTY);
 	FOREACH_VEYON_VNC_SERVER_CONFIG_PROPERTY(CONNECT_WIDGET_TO_PROPERTY);
 }
 
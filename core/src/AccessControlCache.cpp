@@ -0,0 +1,142 @@
+/*
+ * AccessControlCache.cpp - implementation of the AccessControlCache class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "AccessControlCache.h"
+#include "VeyonConfiguration.h"
+
+
+AccessControlCache::AccessControlCache( QObject* parent ) :
+	QObject( parent )
+{
+	connect( &VeyonCore::config(), &VeyonConfiguration::configurationChanged, this, &AccessControlCache::clear );
+}
+
+
+
+AccessControlCache::RuleSetPointer AccessControlCache::rules()
+{
+	QMutexLocker locker( &m_mutex );
+
+	if( m_rules.isNull() )
+	{
+		m_rules = compileRules();
+	}
+
+	return m_rules;
+}
+
+
+
+QStringList AccessControlCache::groupsOfUser( const QString& user, const Lookup& lookup )
+{
+	return cachedLookup( m_groupsOfUsers, user, lookup );
+}
+
+
+
+QStringList AccessControlCache::locationsOfComputer( const QString& computer, const Lookup& lookup )
+{
+	return cachedLookup( m_locationsOfComputers, computer, lookup );
+}
+
+
+
+void AccessControlCache::clear()
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_rules.reset();
+	m_groupsOfUsers.clear();
+	m_locationsOfComputers.clear();
+}
+
+
+
+AccessControlCache::RuleSetPointer AccessControlCache::compileRules()
+{
+	const QJsonArray accessControlRules = VeyonCore::config().accessControlRules();
+
+	auto ruleSet = QSharedPointer<RuleSet>::create();
+	ruleSet->reserve( accessControlRules.size() );
+
+	for( const auto& accessControlRule : accessControlRules )
+	{
+		CompiledRule compiledRule{ AccessControlRule( accessControlRule ), {}, {} };
+		const auto& rule = compiledRule.rule;
+
+		// disabled rules never match, so drop them right away
+		if( rule.action() == AccessControlRule::Action::None )
+		{
+			continue;
+		}
+
+		if( rule.isConditionEnabled( AccessControlRule::Condition::MemberOfUserGroup ) )
+		{
+			compiledRule.userGroupRX.setPattern( rule.argument( AccessControlRule::Condition::MemberOfUserGroup ) );
+			compiledRule.userGroupRX.optimize();
+		}
+
+		if( rule.isConditionEnabled( AccessControlRule::Condition::AuthenticationMethod ) )
+		{
+			compiledRule.authMethodUid = Plugin::Uid( rule.argument( AccessControlRule::Condition::AuthenticationMethod ) );
+		}
+
+		ruleSet->append( compiledRule );
+	}
+
+	vDebug() << "compiled" << ruleSet->size() << "of" << accessControlRules.size() << "access control rules";
+
+	return ruleSet;
+}
+
+
+
+QStringList AccessControlCache::cachedLookup( Cache& cache, const QString& key, const Lookup& lookup )
+{
+	QMutexLocker locker( &m_mutex );
+
+	const auto it = cache.constFind( key );
+	if( it != cache.constEnd() && it->age.elapsed() < TimeToLive )
+	{
+		return it->value;
+	}
+
+	// do not block other threads while querying possibly slow backends
+	locker.unlock();
+
+	const auto value = lookup();
+
+	locker.relock();
+
+	if( cache.size() >= MaximumCacheSize && cache.contains( key ) == false )
+	{
+		cache.clear();
+	}
+
+	auto& entry = cache[key];
+	entry.value = value;
+	entry.age.start();
+
+	return value;
+}
@@ -0,0 +1,85 @@
+/*
+ * AccessControlCache.h - header file for the AccessControlCache class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSharedPointer>
+
+#include "AccessControlRule.h"
+#include "Plugin.h"
+
+// process-wide cache for the parsed access control rules and the results of
+// user group and location lookups - everything is invalidated whenever the
+// configuration changes, lookup results additionally expire after a while
+class VEYON_CORE_EXPORT AccessControlCache : public QObject
+{
+	Q_OBJECT
+public:
+	struct CompiledRule
+	{
+		AccessControlRule rule;
+		QRegularExpression userGroupRX;
+		Plugin::Uid authMethodUid;
+	};
+
+	using RuleSet = QVector<CompiledRule>;
+	using RuleSetPointer = QSharedPointer<const RuleSet>;
+	using Lookup = std::function<QStringList(void)>;
+
+	static constexpr int TimeToLive = 60000;
+	static constexpr int MaximumCacheSize = 4096;
+
+	explicit AccessControlCache( QObject* parent = nullptr );
+	~AccessControlCache() override = default;
+
+	RuleSetPointer rules();
+
+	QStringList groupsOfUser( const QString& user, const Lookup& lookup );
+	QStringList locationsOfComputer( const QString& computer, const Lookup& lookup );
+
+	void clear();
+
+private:
+	struct CacheEntry
+	{
+		QStringList value;
+		QElapsedTimer age;
+	};
+
+	using Cache = QHash<QString, CacheEntry>;
+
+	static RuleSetPointer compileRules();
+
+	QStringList cachedLookup( Cache& cache, const QString& key, const Lookup& lookup );
+
+	QMutex m_mutex{};
+	RuleSetPointer m_rules{};
+	Cache m_groupsOfUsers{};
+	Cache m_locationsOfComputers{};
+
+} ;
@@ -36,19 +36,13 @@
 #include "PlatformUserFunctions.h"
 
 
-AccessControlProvider::AccessControlProvider() :
+AccessControlProvider::AccessControlProvider( HostAddress::LookupMode lookupMode ) :
+	m_accessControlRules( VeyonCore::accessControlCache().rules() ),
 	m_userGroupsBackend( VeyonCore::userGroupsBackendManager().accessControlBackend() ),
 	m_networkObjectDirectory( VeyonCore::networkObjectDirectoryManager().configuredDirectory() ),
-	m_queryDomainGroups( VeyonCore::config().domainGroupsForAccessControlEnabled() )
+	m_queryDomainGroups( VeyonCore::config().domainGroupsForAccessControlEnabled() ),
+	m_lookupMode( lookupMode )
 {
-	const QJsonArray accessControlRules = VeyonCore::config().accessControlRules();
-
-	m_accessControlRules.reserve( accessControlRules.size() );
-
-	for( const auto& accessControlRule : accessControlRules )
-	{
-		m_accessControlRules.append( AccessControlRule( accessControlRule ) );
-	}
 }
 
 
@@ -78,16 +72,24 @@ QStringList AccessControlProvider::locations() const
 
 QStringList AccessControlProvider::locationsOfComputer( const QString& computer ) const
 {
-	const auto fqdn = HostAddress( computer ).convert( HostAddress::Type::FullyQualifiedDomainName );
-
-	vDebug() << "Searching for locations of computer" << computer << "via FQDN" << fqdn;
-
+	const auto fqdn = HostAddress( computer ).convert( HostAddress::Type::FullyQualifiedDomainName, m_lookupMode );
 	if( fqdn.isEmpty() )
 	{
-		vWarning() << "Empty FQDN - returning empty location list";
+		vWarning() << "Could not determine FQDN of computer" << computer << "- returning empty location list";
 		return {};
 	}
 
+	return VeyonCore::accessControlCache().locationsOfComputer( fqdn, [=]() {
+		return queryLocationsOfComputer( fqdn );
+	} );
+}
+
+
+
+QStringList AccessControlProvider::queryLocationsOfComputer( const QString& fqdn ) const
+{
+	vDebug() << "Searching for locations of computer via FQDN" << fqdn;
+
 	const auto computers = m_networkObjectDirectory->queryObjects( NetworkObject::Type::Host,
 																   NetworkObject::Property::HostAddress, fqdn );
 	if( computers.isEmpty() )
@@ -166,7 +168,7 @@ bool AccessControlProvider::processAuthorizedGroups( const QString& accessingUse
 {
 	vDebug() << "processing for user" << accessingUser;
 
-	const auto groupsOfAccessingUser = m_userGroupsBackend->groupsOfUser( accessingUser, m_queryDomainGroups );
+	const auto groupsOfAccessingUser = groupsOfUser( accessingUser );
 	const auto authorizedUserGroups = VeyonCore::config().authorizedUserGroups();
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
@@ -191,17 +193,12 @@ AccessControlRule::Action AccessControlProvider::processAccessControlRules( cons
 {
 	vDebug() << "processing rules for" << accessingUser << accessingComputer << localUser << localComputer << connectedUsers << authMethodUid;
 
-	for( const auto& rule : qAsConst( m_accessControlRules ) )
+	for( const auto& compiledRule : *m_accessControlRules )
 	{
-		// rule disabled?
-		if( rule.action() == AccessControlRule::Action::None )
-		{
-			// then continue with next rule
-			continue;
-		}
+		const auto& rule = compiledRule.rule;
 
 		if( rule.areConditionsIgnored() ||
-			matchConditions( rule, accessingUser, accessingComputer, localUser, localComputer, connectedUsers, authMethodUid ) )
+			matchConditions( compiledRule, accessingUser, accessingComputer, localUser, localComputer, connectedUsers, authMethodUid ) )
 		{
 			vDebug() << "rule" << rule.name() << "matched with action" << rule.action();
 			return rule.action();
@@ -224,12 +221,14 @@ bool AccessControlProvider::isAccessToLocalComputerDenied() const
 		return false;
 	}
 
-	for( const auto& rule : qAsConst( m_accessControlRules ) )
+	const auto localUser = VeyonCore::platform().userFunctions().currentUser();
+	const auto localComputer = HostAddress::localFQDN();
+
+	for( const auto& compiledRule : *m_accessControlRules )
 	{
-		if( matchConditions( rule, {}, {},
-							 VeyonCore::platform().userFunctions().currentUser(), HostAddress::localFQDN(), {}, {} ) )
+		if( matchConditions( compiledRule, {}, {}, localUser, localComputer, {}, {} ) )
 		{
-			switch( rule.action() )
+			switch( compiledRule.rule.action() )
 			{
 			case AccessControlRule::Action::Deny:
 				return true;
@@ -247,17 +246,24 @@ bool AccessControlProvider::isAccessToLocalComputerDenied() const
 
 
 
-bool AccessControlProvider::isMemberOfUserGroup( const QString &user,
-												 const QString &groupName ) const
+QStringList AccessControlProvider::groupsOfUser( const QString& user ) const
 {
-	const QRegularExpression groupNameRX( groupName );
+	return VeyonCore::accessControlCache().groupsOfUser( user, [=]() {
+		return m_userGroupsBackend->groupsOfUser( user, m_queryDomainGroups );
+	} );
+}
 
+
+
+bool AccessControlProvider::isMemberOfUserGroup( const QString &user,
+												 const QRegularExpression& groupNameRX ) const
+{
 	if( groupNameRX.isValid() )
 	{
-		return m_userGroupsBackend->groupsOfUser( user, m_queryDomainGroups ).indexOf( groupNameRX ) >= 0;
+		return groupsOfUser( user ).indexOf( groupNameRX ) >= 0;
 	}
 
-	return m_userGroupsBackend->groupsOfUser( user, m_queryDomainGroups ).contains( groupName );
+	return groupsOfUser( user ).contains( groupNameRX.pattern() );
 }
 
 
@@ -271,8 +277,8 @@ bool AccessControlProvider::isLocatedAt( const QString &computer, const QString
 
 bool AccessControlProvider::haveGroupsInCommon( const QString &userOne, const QString &userTwo ) const
 {
-	const auto userOneGroups = m_userGroupsBackend->groupsOfUser( userOne, m_queryDomainGroups );
-	const auto userTwoGroups = m_userGroupsBackend->groupsOfUser( userTwo, m_queryDomainGroups );
+	const auto userOneGroups = groupsOfUser( userOne );
+	const auto userTwoGroups = groupsOfUser( userTwo );
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
 	const auto userOneGroupSet = QSet<QString>{ userOneGroups.begin(), userOneGroups.end() };
@@ -300,7 +306,7 @@ bool AccessControlProvider::haveSameLocations( const QString &computerOne, const
 
 bool AccessControlProvider::isLocalHost( const QString &accessingComputer ) const
 {
-	return HostAddress( accessingComputer ).isLocalHost();
+	return HostAddress( accessingComputer ).isLocalHost( m_lookupMode );
 }
 
 
@@ -338,11 +344,13 @@ QString AccessControlProvider::lookupSubject( AccessControlRule::Subject subject
 
 
 
-bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
+bool AccessControlProvider::matchConditions( const AccessControlCache::CompiledRule& compiledRule,
 											 const QString& accessingUser, const QString& accessingComputer,
 											 const QString& localUser, const QString& localComputer,
 											 const QStringList& connectedUsers, Plugin::Uid authMethodUid ) const
 {
+	const auto& rule = compiledRule.rule;
+
 	bool hasConditions = false;
 
 	// normally all selected conditions have to match in order to make the whole rule match
@@ -356,7 +364,7 @@ bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
 	{
 		hasConditions = true;
 
-		const auto allowedAuthMethod = Plugin::Uid( rule.argument( AccessControlRule::Condition::AuthenticationMethod ) );
+		const auto& allowedAuthMethod = compiledRule.authMethodUid;
 		if( authMethodUid.isNull() ||
 			allowedAuthMethod.isNull() ||
 			( authMethodUid == allowedAuthMethod ) != matchResult )
@@ -371,10 +379,9 @@ bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
 
 		const auto condition = AccessControlRule::Condition::MemberOfUserGroup;
 		const auto user = lookupSubject( rule.subject( condition ), accessingUser, {}, localUser, {} );
-		const auto group = rule.argument( condition );
 
-		if( user.isEmpty() || group.isEmpty() ||
-			isMemberOfUserGroup( user, group ) != matchResult )
+		if( user.isEmpty() || compiledRule.userGroupRX.pattern().isEmpty() ||
+			isMemberOfUserGroup( user, compiledRule.userGroupRX ) != matchResult )
 		{
 			return false;
 		}
@@ -24,7 +24,8 @@
 
 #pragma once
 
-#include "AccessControlRule.h"
+#include "AccessControlCache.h"
+#include "HostAddress.h"
 #include "NetworkObject.h"
 #include "Plugin.h"
 
@@ -40,7 +41,7 @@ public:
 		ToBeConfirmed,
 	} ;
 
-	AccessControlProvider();
+	explicit AccessControlProvider( HostAddress::LookupMode lookupMode = HostAddress::LookupMode::Blocking );
 
 	QStringList userGroups() const;
 	QStringList locations() const;
@@ -61,7 +62,10 @@ public:
 	bool isAccessToLocalComputerDenied() const;
 
 private:
-	bool isMemberOfUserGroup( const QString& user, const QString& groupName ) const;
+	QStringList groupsOfUser( const QString& user ) const;
+	QStringList queryLocationsOfComputer( const QString& fqdn ) const;
+
+	bool isMemberOfUserGroup( const QString& user, const QRegularExpression& groupNameRX ) const;
 	bool isLocatedAt( const QString& computer, const QString& locationName ) const;
 	bool haveGroupsInCommon( const QString& userOne, const QString& userTwo ) const;
 	bool haveSameLocations( const QString& computerOne, const QString& computerTwo ) const;
@@ -73,7 +77,7 @@ private:
 						   const QString& accessingUser, const QString& accessingComputer,
 						   const QString& localUser, const QString& localComputer ) const;
 
-	bool matchConditions( const AccessControlRule& rule,
+	bool matchConditions( const AccessControlCache::CompiledRule& compiledRule,
 						  const QString& accessingUser, const QString& accessingComputer,
 						  const QString& localUser, const QString& localComputer,
 						  const QStringList& connectedUsers,
@@ -81,9 +85,10 @@ private:
 
 	static QStringList objectNames( const NetworkObjectList& objects );
 
-	QList<AccessControlRule> m_accessControlRules{};
+	AccessControlCache::RuleSetPointer m_accessControlRules;
 	UserGroupsBackendInterface* m_userGroupsBackend;
 	NetworkObjectDirectory* m_networkObjectDirectory;
 	bool m_queryDomainGroups;
+	HostAddress::LookupMode m_lookupMode;
 
 } ;
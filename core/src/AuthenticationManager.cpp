@@ -29,7 +29,8 @@
 AuthenticationManager::AuthenticationManager( QObject* parent ) :
 	QObject( parent )
 {
-	for( auto pluginObject : qAsConst( VeyonCore::pluginManager().pluginObjects() ) )
+	const auto pluginObjects = VeyonCore::pluginManager().pluginObjects( AuthenticationPluginInterface_iid );
+	for( auto pluginObject : pluginObjects )
 	{
 		auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
 		auto authenticationPluginInterface = qobject_cast<AuthenticationPluginInterface *>( pluginObject );
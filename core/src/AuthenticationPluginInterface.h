@@ -43,9 +43,16 @@ public:
 	virtual bool hasCredentials() const = 0;
 	virtual bool checkCredentials() const = 0;
 
-	// server side authentication
+	// server side authentication - called in the main thread unless isReentrant() returns true
 	virtual VncServerClient::AuthState performAuthentication( VncServerClient* client, VariantArrayMessage& message ) const = 0;
 
+	// return true if performAuthentication() may be called concurrently from worker threads, i.e. it
+	// only operates on the passed client and message and reads state which is never modified afterwards
+	virtual bool isReentrant() const
+	{
+		return false;
+	}
+
 	// client side authentication
 	virtual bool authenticate( QIODevice* socket ) const = 0;
 
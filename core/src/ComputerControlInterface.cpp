@@ -127,6 +127,9 @@ void ComputerControlInterface::stop()
 	m_userUpdateTimer.stop();
 	m_connectionWatchdogTimer.stop();
 
+	m_userSequenceNumber = -1;
+	m_activeFeaturesSequenceNumber = -1;
+
 	m_state = State::Disconnected;
 }
 
@@ -220,7 +223,11 @@ void ComputerControlInterface::updateActiveFeatures()
 
 	if( m_vncConnection && m_connection && state() == State::Connected )
 	{
-		VeyonCore::builtinFeatures().featureControl().queryActiveFeatures( { weakPointer() } );
+		// once subscribed, the server pushes all changes on its own
+		if( isSubscribed( StateSubscription::ActiveFeatures ) == false )
+		{
+			VeyonCore::builtinFeatures().featureControl().subscribeActiveFeatures( { weakPointer() } );
+		}
 	}
 	else
 	{
@@ -232,6 +239,31 @@ void ComputerControlInterface::updateActiveFeatures()
 
 
 
+bool ComputerControlInterface::acceptStateUpdate( StateSubscription subscription, int sequenceNumber )
+{
+	auto& lastSequenceNumber = subscription == StateSubscription::UserInformation ?
+								   m_userSequenceNumber : m_activeFeaturesSequenceNumber;
+
+	// ignore outdated updates
+	if( sequenceNumber <= lastSequenceNumber )
+	{
+		return false;
+	}
+
+	const auto wasSubscribed = isSubscribed( subscription );
+
+	lastSequenceNumber = sequenceNumber;
+
+	if( wasSubscribed == false )
+	{
+		updatePollTimers();
+	}
+
+	return true;
+}
+
+
+
 void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& featureMessage, bool wake )
 {
 	if( m_connection && m_connection->isConnected() )
@@ -242,6 +274,16 @@ void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& feature
 
 
 
+void ComputerControlInterface::sendFeatureMessage( const EncodedFeatureMessagePointer& featureMessage, bool wake )
+{
+	if( m_connection && m_connection->isConnected() )
+	{
+		m_connection->sendFeatureMessage( featureMessage, wake );
+	}
+}
+
+
+
 bool ComputerControlInterface::isMessageQueueEmpty()
 {
 	if( m_vncConnection && m_vncConnection->isConnected() )
@@ -257,32 +299,23 @@ void ComputerControlInterface::setUpdateMode( UpdateMode updateMode )
 {
 	m_updateMode = updateMode;
 
-	const auto computerMonitoringUpdateInterval = VeyonCore::config().computerMonitoringUpdateInterval();
-
-	switch( updateMode )
+	if( m_vncConnection )
 	{
-	case UpdateMode::Disabled:
-		if( m_vncConnection )
+		switch( updateMode )
 		{
+		case UpdateMode::Disabled:
 			m_vncConnection->setFramebufferUpdateInterval( UpdateIntervalDisabled );
+			break;
+		case UpdateMode::Monitoring:
+			m_vncConnection->setFramebufferUpdateInterval( VeyonCore::config().computerMonitoringUpdateInterval() );
+			break;
+		case UpdateMode::Live:
+			m_vncConnection->setFramebufferUpdateInterval( -1 );
+			break;
 		}
-
-		m_userUpdateTimer.stop();
-		m_activeFeaturesUpdateTimer.start( UpdateIntervalDisabled );
-		break;
-
-	case UpdateMode::Monitoring:
-	case UpdateMode::Live:
-		if( m_vncConnection )
-		{
-			m_vncConnection->setFramebufferUpdateInterval( updateMode == UpdateMode::Monitoring ?
-															   computerMonitoringUpdateInterval : -1 );
-		}
-
-		m_userUpdateTimer.start( computerMonitoringUpdateInterval );
-		m_activeFeaturesUpdateTimer.start( computerMonitoringUpdateInterval );
-		break;
 	}
+
+	updatePollTimers();
 }
 
 
@@ -339,6 +372,12 @@ void ComputerControlInterface::updateState()
 		m_state = State::Disconnected;
 	}
 
+	// subscriptions end with the connection and have to be renewed after reconnecting
+	if( m_state != State::Connected )
+	{
+		resetSubscriptions();
+	}
+
 	unlock();
 }
 
@@ -350,9 +389,9 @@ void ComputerControlInterface::updateUser()
 
 	if( m_vncConnection && m_connection && state() == State::Connected )
 	{
-		if( userLoginName().isEmpty() )
+		if( userLoginName().isEmpty() && isSubscribed( StateSubscription::UserInformation ) == false )
 		{
-			VeyonCore::builtinFeatures().monitoringMode().queryLoggedOnUserInfo( { weakPointer() } );
+			VeyonCore::builtinFeatures().monitoringMode().subscribeLoggedOnUserInfo( { weakPointer() } );
 		}
 	}
 	else
@@ -365,6 +404,46 @@ void ComputerControlInterface::updateUser()
 
 
 
+void ComputerControlInterface::updatePollTimers()
+{
+	// only poll servers which do not push state changes to subscribers
+	const auto interval = m_updateMode == UpdateMode::Disabled ?
+							  UpdateIntervalDisabled : VeyonCore::config().computerMonitoringUpdateInterval();
+
+	if( m_updateMode == UpdateMode::Disabled || isSubscribed( StateSubscription::UserInformation ) )
+	{
+		m_userUpdateTimer.stop();
+	}
+	else
+	{
+		m_userUpdateTimer.start( interval );
+	}
+
+	if( isSubscribed( StateSubscription::ActiveFeatures ) )
+	{
+		m_activeFeaturesUpdateTimer.stop();
+	}
+	else
+	{
+		m_activeFeaturesUpdateTimer.start( interval );
+	}
+}
+
+
+
+void ComputerControlInterface::resetSubscriptions()
+{
+	if( isSubscribed( StateSubscription::UserInformation ) || isSubscribed( StateSubscription::ActiveFeatures ) )
+	{
+		m_userSequenceNumber = -1;
+		m_activeFeaturesSequenceNumber = -1;
+
+		updatePollTimers();
+	}
+}
+
+
+
 void ComputerControlInterface::handleFeatureMessage( const FeatureMessage& message )
 {
 	Q_EMIT featureMessageReceived( message, weakPointer() );
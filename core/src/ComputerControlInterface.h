@@ -30,6 +30,7 @@
 #include <QTimer>
 
 #include "Computer.h"
+#include "EncodedFeatureMessage.h"
 #include "Feature.h"
 #include "Lockable.h"
 #include "VeyonCore.h"
@@ -37,7 +38,6 @@
 
 class QImage;
 
-class FeatureMessage;
 class VncConnection;
 class VeyonConnection;
 
@@ -51,6 +51,12 @@ public:
 		Live
 	};
 
+	// state which the server pushes on changes once subscribed to
+	enum class StateSubscription {
+		UserInformation,
+		ActiveFeatures
+	};
+
 	using Pointer = QSharedPointer<ComputerControlInterface>;
 
 	using State = VncConnection::State;
@@ -143,7 +149,15 @@ public:
 
 	void updateActiveFeatures();
 
+	bool isSubscribed( StateSubscription subscription ) const
+	{
+		return stateSequenceNumber( subscription ) >= 0;
+	}
+
+	bool acceptStateUpdate( StateSubscription subscription, int sequenceNumber );
+
 	void sendFeatureMessage( const FeatureMessage& featureMessage, bool wake );
+	void sendFeatureMessage( const EncodedFeatureMessagePointer& featureMessage, bool wake );
 	bool isMessageQueueEmpty();
 
 	void setUpdateMode( UpdateMode updateMode );
@@ -160,6 +174,13 @@ private:
 
 	void updateState();
 	void updateUser();
+	void updatePollTimers();
+	void resetSubscriptions();
+
+	int stateSequenceNumber( StateSubscription subscription ) const
+	{
+		return subscription == StateSubscription::UserInformation ? m_userSequenceNumber : m_activeFeaturesSequenceNumber;
+	}
 
 	void handleFeatureMessage( const FeatureMessage& message );
 
@@ -185,6 +206,8 @@ private:
 	QTimer m_connectionWatchdogTimer;
 	QTimer m_userUpdateTimer;
 	QTimer m_activeFeaturesUpdateTimer;
+	int m_userSequenceNumber{-1};
+	int m_activeFeaturesSequenceNumber{-1};
 
 	QStringList m_groups;
 
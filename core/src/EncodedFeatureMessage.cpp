@@ -0,0 +1,45 @@
+/*
+ * EncodedFeatureMessage.cpp - implementation of the EncodedFeatureMessage class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QBuffer>
+
+#include "EncodedFeatureMessage.h"
+
+
+QByteArray EncodedFeatureMessage::data( FeatureMessage::Codec codec ) const
+{
+	QMutexLocker locker( &m_mutex );
+
+	auto& data = m_data[static_cast<std::size_t>( codec )];
+
+	if( data.isEmpty() )
+	{
+		QBuffer buffer( &data );
+		buffer.open( QBuffer::WriteOnly );
+		m_message.send( &buffer, codec );
+	}
+
+	// implicitly shared, i.e. no copy of the actual data
+	return data;
+}
@@ -0,0 +1,62 @@
+/*
+ * EncodedFeatureMessage.h - header file for the EncodedFeatureMessage class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <array>
+
+#include <QMutex>
+#include <QSharedPointer>
+
+#include "FeatureMessage.h"
+
+// immutable feature message which is shared by all connections it is sent
+// through - it gets encoded at most once per codec regardless of the number
+// of connections and threads
+class VEYON_CORE_EXPORT EncodedFeatureMessage
+{
+public:
+	explicit EncodedFeatureMessage( const FeatureMessage& message ) :
+		m_message( message )
+	{
+	}
+
+	const FeatureMessage& message() const
+	{
+		return m_message;
+	}
+
+	QByteArray data( FeatureMessage::Codec codec ) const;
+
+private:
+	static constexpr int CodecCount = static_cast<int>( FeatureMessage::LatestCodec ) + 1;
+
+	const FeatureMessage m_message;
+
+	mutable QMutex m_mutex{};
+	mutable std::array<QByteArray, CodecCount> m_data{};
+
+} ;
+
+using EncodedFeatureMessagePointer = QSharedPointer<const EncodedFeatureMessage>;
@@ -22,6 +22,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "FeatureControl.h"
 #include "FeatureWorkerManager.h"
 #include "VeyonCore.h"
@@ -49,11 +51,28 @@ void FeatureControl::queryActiveFeatures( const ComputerControlInterfaceList& co
 
 
 
+void FeatureControl::subscribeActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	// servers without subscription support treat this as a query
+	sendFeatureMessage( FeatureMessage{ m_featureControlFeature.uid(), SubscribeActiveFeatures },
+						computerControlInterfaces, false );
+}
+
+
+
 bool FeatureControl::handleFeatureMessage( ComputerControlInterface::Pointer computerControlInterface,
 										  const FeatureMessage& message )
 {
 	if( message.featureUid() == m_featureControlFeature.uid() )
 	{
+		const auto sequenceNumber = message.argument( Argument::SequenceNumber );
+		if( sequenceNumber.isValid() &&
+			computerControlInterface->acceptStateUpdate( ComputerControlInterface::StateSubscription::ActiveFeatures,
+														 sequenceNumber.toInt() ) == false )
+		{
+			return true;
+		}
+
 		const auto featureUidStrings = message.argument( Argument::ActiveFeaturesList ).toStringList();
 
 		FeatureUidList activeFeatures{};
@@ -80,21 +99,76 @@ bool FeatureControl::handleFeatureMessage( VeyonServerInterface& server,
 {
 	if( m_featureControlFeature.uid() == message.featureUid() )
 	{
-		const auto featureUids = server.featureWorkerManager().runningWorkers();
-
-		QStringList featureUidStrings;
-		featureUidStrings.reserve( featureUids.size() );
+		FeatureMessage reply( message.featureUid(), message.command() );
+		addActiveFeatures( server, reply );
 
-		for( const auto& featureUid : featureUids )
+		if( message.command() == SubscribeActiveFeatures )
 		{
-			featureUidStrings.append( featureUid.toString() );
+			if( m_server == nullptr )
+			{
+				m_server = &server;
+				connect( &server.featureWorkerManager(), &FeatureWorkerManager::runningWorkersChanged,
+						 this, &FeatureControl::publishActiveFeatures );
+			}
+
+			const auto alreadySubscribed = std::any_of( m_subscribers.constBegin(), m_subscribers.constEnd(),
+				[&messageContext]( const MessageContext& subscriber ) {
+					return subscriber.ioDevice() == messageContext.ioDevice();
+				} );
+			if( alreadySubscribed == false )
+			{
+				m_subscribers.append( messageContext );
+			}
+
+			reply.addArgument( Argument::SequenceNumber, m_sequenceNumber );
 		}
 
-		FeatureMessage reply( message.featureUid(), message.command() );
-		reply.addArgument( Argument::ActiveFeaturesList, featureUidStrings );
-
 		return server.sendFeatureMessageReply( messageContext, reply );
 	}
 
 	return false;
 }
+
+
+
+void FeatureControl::addActiveFeatures( VeyonServerInterface& server, FeatureMessage& message )
+{
+	const auto featureUids = server.featureWorkerManager().runningWorkers();
+
+	QStringList featureUidStrings;
+	featureUidStrings.reserve( featureUids.size() );
+
+	for( const auto& featureUid : featureUids )
+	{
+		featureUidStrings.append( featureUid.toString() );
+	}
+
+	message.addArgument( Argument::ActiveFeaturesList, featureUidStrings );
+}
+
+
+
+void FeatureControl::publishActiveFeatures()
+{
+	// drop subscribers whose connections have been closed in the meantime
+	m_subscribers.erase( std::remove_if( m_subscribers.begin(), m_subscribers.end(),
+										 []( const MessageContext& subscriber ) {
+											 return subscriber.ioDevice() == nullptr;
+										 } ), m_subscribers.end() );
+
+	++m_sequenceNumber;
+
+	if( m_server == nullptr || m_subscribers.isEmpty() )
+	{
+		return;
+	}
+
+	FeatureMessage message( m_featureControlFeature.uid(), SubscribeActiveFeatures );
+	addActiveFeatures( *m_server, message );
+	message.addArgument( Argument::SequenceNumber, m_sequenceNumber );
+
+	for( const auto& subscriber : qAsConst( m_subscribers ) )
+	{
+		m_server->sendFeatureMessageReply( subscriber, message );
+	}
+}
@@ -33,7 +33,8 @@ class VEYON_CORE_EXPORT FeatureControl : public QObject, public FeatureProviderI
 public:
 	enum class Argument
 	{
-		ActiveFeaturesList
+		ActiveFeaturesList,
+		SequenceNumber
 	};
 	Q_ENUM(Argument)
 
@@ -41,6 +42,7 @@ public:
 	~FeatureControl() override = default;
 
 	void queryActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces );
+	void subscribeActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces );
 
 	Plugin::Uid uid() const override
 	{
@@ -99,11 +101,19 @@ private:
 	enum Commands
 	{
 		QueryActiveFeatures,
+		SubscribeActiveFeatures,
 	};
 
+	void addActiveFeatures( VeyonServerInterface& server, FeatureMessage& message );
+	void publishActiveFeatures();
+
 	const Feature m_featureControlFeature;
 	const FeatureList m_features;
 
 	FeatureUidList m_activeFeatures;
 
+	VeyonServerInterface* m_server{nullptr};
+	QList<MessageContext> m_subscribers{};
+	int m_sequenceNumber{0};
+
 };
@@ -34,12 +34,26 @@ Q_DECLARE_METATYPE(FeatureMessage)
 // clazy:excludeall=reserve-candidates
 
 FeatureManager::FeatureManager( QObject* parent ) :
+	FeatureManager( VeyonCore::pluginManager().pluginObjects( FeatureProviderInterface_iid ), parent )
+{
+}
+
+
+
+FeatureManager::FeatureManager( Feature::Uid featureUid, QObject* parent ) :
+	FeatureManager( VeyonCore::pluginManager().featurePluginObjects( featureUid ), parent )
+{
+}
+
+
+
+FeatureManager::FeatureManager( const QObjectList& pluginObjects, QObject* parent ) :
 	QObject( parent )
 {
 	qRegisterMetaType<Feature>();
 	qRegisterMetaType<FeatureMessage>();
 
-	for( const auto& pluginObject : qAsConst( VeyonCore::pluginManager().pluginObjects() ) )
+	for( const auto& pluginObject : pluginObjects )
 	{
 		auto featurePluginInterface = qobject_cast<FeatureProviderInterface *>( pluginObject );
 
@@ -52,6 +66,13 @@ FeatureManager::FeatureManager( QObject* parent ) :
 		}
 	}
 
+	updateRoutes();
+	updateDisabledFeatures();
+
+	// plugins may update their feature lists once the application has been loaded
+	connect( VeyonCore::instance(), &VeyonCore::applicationLoaded, this, &FeatureManager::updateRoutes );
+	connect( &VeyonCore::config(), &VeyonConfiguration::configurationChanged,
+			 this, &FeatureManager::updateDisabledFeatures );
 }
 
 
@@ -187,13 +208,13 @@ void FeatureManager::updateActiveFeatures( const ComputerControlInterfaceList& c
 bool FeatureManager::handleFeatureMessage( ComputerControlInterface::Pointer computerControlInterface,
 										  const FeatureMessage& message ) const
 {
-	vDebug() << "feature" << feature(message.featureUid()).name()
+	vDebug() << "feature" << message.featureUid()
 			 << "command" << message.command()
 			 << "arguments" << message.arguments();
 
 	bool handled = false;
 
-	for( const auto& featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	for( const auto& featureInterface : featureInterfaces( message.featureUid() ) )
 	{
 		if( featureInterface->handleFeatureMessage( computerControlInterface, message ) )
 		{
@@ -210,11 +231,11 @@ bool FeatureManager::handleFeatureMessage( VeyonServerInterface& server,
 										   const MessageContext& messageContext,
 										   const FeatureMessage& message ) const
 {
-	vDebug() << "feature" << feature(message.featureUid()).name()
+	vDebug() << "feature" << message.featureUid()
 			 << "command" << message.command()
 			 << "arguments" << message.arguments();
 
-	if( VeyonCore::config().disabledFeatures().contains( message.featureUid().toString() ) )
+	if( m_disabledFeatures.contains( message.featureUid() ) )
 	{
 		vWarning() << "ignoring message as feature" << message.featureUid() << "is disabled by configuration!";
 		return false;
@@ -222,7 +243,7 @@ bool FeatureManager::handleFeatureMessage( VeyonServerInterface& server,
 
 	bool handled = false;
 
-	for( const auto& featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	for( const auto& featureInterface : featureInterfaces( message.featureUid() ) )
 	{
 		if( featureInterface->handleFeatureMessage( server, messageContext, message ) )
 		{
@@ -237,13 +258,13 @@ bool FeatureManager::handleFeatureMessage( VeyonServerInterface& server,
 
 bool FeatureManager::handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) const
 {
-	vDebug() << "feature" << feature(message.featureUid()).name()
+	vDebug() << "feature" << message.featureUid()
 			 << "command" << message.command()
 			 << "arguments" << message.arguments();
 
 	bool handled = false;
 
-	for( const auto& featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	for( const auto& featureInterface : featureInterfaces( message.featureUid() ) )
 	{
 		if( featureInterface->handleFeatureMessage( worker, message ) )
 		{
@@ -253,3 +274,34 @@ bool FeatureManager::handleFeatureMessage( VeyonWorkerInterface& worker, const F
 
 	return handled;
 }
+
+
+
+void FeatureManager::updateRoutes()
+{
+	m_featureRoutes.clear();
+
+	for( const auto& featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	{
+		for( const auto& feature : featureInterface->featureList() )
+		{
+			auto& route = m_featureRoutes[feature.uid()];
+			if( route.contains( featureInterface ) == false )
+			{
+				route.append( featureInterface );
+			}
+		}
+	}
+}
+
+
+
+void FeatureManager::updateDisabledFeatures()
+{
+	m_disabledFeatures.clear();
+
+	for( const auto& disabledFeature : VeyonCore::config().disabledFeatures() )
+	{
+		m_disabledFeatures.insert( Feature::Uid( disabledFeature ) );
+	}
+}
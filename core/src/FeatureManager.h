@@ -24,7 +24,9 @@
 
 #pragma once
 
+#include <QHash>
 #include <QObject>
+#include <QSet>
 
 #include "Feature.h"
 #include "FeatureProviderInterface.h"
@@ -40,6 +42,7 @@ class VEYON_CORE_EXPORT FeatureManager : public QObject
 	Q_OBJECT
 public:
 	explicit FeatureManager( QObject* parent = nullptr );
+	explicit FeatureManager( Feature::Uid featureUid, QObject* parent = nullptr );
 
 	const FeatureList& features() const
 	{
@@ -74,10 +77,29 @@ public:
 	bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) const;
 
 private:
+	FeatureManager( const QObjectList& pluginObjects, QObject* parent );
+
+	void updateRoutes();
+	void updateDisabledFeatures();
+
+	const FeatureProviderInterfaceList& featureInterfaces( Feature::Uid featureUid ) const
+	{
+		const auto it = m_featureRoutes.constFind( featureUid );
+		if( it != m_featureRoutes.constEnd() )
+		{
+			return *it;
+		}
+
+		// unknown features (e.g. added dynamically later) are offered to all plugins
+		return m_featurePluginInterfaces;
+	}
+
 	FeatureList m_features{};
 	const FeatureList m_emptyFeatureList{};
 	QObjectList m_pluginObjects{};
 	FeatureProviderInterfaceList m_featurePluginInterfaces{};
+	QHash<Feature::Uid, FeatureProviderInterfaceList> m_featureRoutes{};
+	QSet<Feature::Uid> m_disabledFeatures{};
 	const Feature m_dummyFeature{};
 
 };
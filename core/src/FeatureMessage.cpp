@@ -22,14 +22,330 @@
  *
  */
 
+#include <QDataStream>
+#include <QVector>
+#include <QtEndian>
+
 #include "FeatureMessage.h"
 #include "VariantArrayMessage.h"
 
 
-bool FeatureMessage::send( QIODevice* ioDevice ) const
+namespace {
+
+// type tags of argument values in the binary encoding
+enum class BinaryType : quint8
+{
+	Invalid,
+	Bool,
+	Int,
+	UInt,
+	LongLong,
+	ULongLong,
+	String,
+	ByteArray,
+	Uuid,
+	Variant,
+};
+
+// byte arrays of at least this size are written directly to the I/O device
+// instead of being copied into the message buffer
+constexpr int DirectWriteThreshold = 4096;
+
+constexpr int MaxVarintSize = 10;
+constexpr int UuidSize = 16;
+
+quint64 zigZagEncode( qint64 value )
+{
+	return ( quint64( value ) << 1 ) ^ quint64( value >> 63 );
+}
+
+qint64 zigZagDecode( quint64 value )
+{
+	return qint64( value >> 1 ) ^ -qint64( value & 1 );
+}
+
+
+class BinaryWriter
+{
+public:
+	void writeByte( quint8 value )
+	{
+		m_buffer.append( char( value ) );
+	}
+
+	void writeVarint( quint64 value )
+	{
+		while( value >= 0x80 )
+		{
+			writeByte( quint8( value | 0x80 ) );
+			value >>= 7;
+		}
+		writeByte( quint8( value ) );
+	}
+
+	void writeRaw( const QByteArray& data )
+	{
+		m_buffer.append( data );
+	}
+
+	void writeBytes( const QByteArray& data )
+	{
+		writeVarint( quint64( data.size() ) );
+
+		if( data.size() >= DirectWriteThreshold )
+		{
+			// only reference the (implicitly shared) data
+			flushBuffer();
+			m_segments.append( data );
+			m_size += data.size();
+		}
+		else
+		{
+			writeRaw( data );
+		}
+	}
+
+	bool send( QIODevice* ioDevice )
+	{
+		flushBuffer();
+
+		if( m_size > VariantArrayMessage::MaxMessageSize )
+		{
+			vCritical() << "message too large:" << m_size;
+			return false;
+		}
+
+		const auto messageSize = qToBigEndian<VariantArrayMessage::MessageSize>( VariantArrayMessage::MessageSize( m_size ) );
+		if( ioDevice->write( reinterpret_cast<const char *>( &messageSize ), sizeof(messageSize) ) != sizeof(messageSize) )
+		{
+			return false;
+		}
+
+		for( const auto& segment : qAsConst(m_segments) )
+		{
+			if( ioDevice->write( segment ) != segment.size() )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+	void flushBuffer()
+	{
+		if( m_buffer.isEmpty() == false )
+		{
+			m_segments.append( m_buffer );
+			m_size += m_buffer.size();
+			m_buffer.clear();
+		}
+	}
+
+	QVector<QByteArray> m_segments{};
+	QByteArray m_buffer{};
+	qint64 m_size{0};
+
+} ;
+
+
+class BinaryReader
+{
+public:
+	BinaryReader( QIODevice* ioDevice, qint64 size ) :
+		m_ioDevice( ioDevice ),
+		m_remaining( size )
+	{
+	}
+
+	bool isValid() const
+	{
+		return m_valid;
+	}
+
+	bool atEnd() const
+	{
+		return m_remaining <= 0;
+	}
+
+	quint8 readByte()
+	{
+		char value = 0;
+		if( checkRemaining( 1 ) && m_ioDevice->getChar( &value ) == false )
+		{
+			m_valid = false;
+		}
+		return quint8( value );
+	}
+
+	quint64 readVarint()
+	{
+		quint64 value = 0;
+
+		for( int i = 0; i < MaxVarintSize && m_valid; ++i )
+		{
+			const auto byte = readByte();
+			value |= quint64( byte & 0x7f ) << ( 7 * i );
+			if( ( byte & 0x80 ) == 0 )
+			{
+				return value;
+			}
+		}
+
+		m_valid = false;
+		return 0;
+	}
+
+	QByteArray readRaw( qint64 size )
+	{
+		if( checkRemaining( size ) == false )
+		{
+			return {};
+		}
+
+		// read directly into the final byte array without intermediate buffers
+		auto data = m_ioDevice->read( size ); // Flawfinder: ignore
+		if( data.size() != size )
+		{
+			m_valid = false;
+			return {};
+		}
+
+		return data;
+	}
+
+	QByteArray readBytes()
+	{
+		return readRaw( qint64( readVarint() ) );
+	}
+
+	void skipRemaining()
+	{
+		if( m_remaining > 0 )
+		{
+			m_ioDevice->read( m_remaining ); // Flawfinder: ignore
+			m_remaining = 0;
+		}
+	}
+
+private:
+	bool checkRemaining( qint64 size )
+	{
+		if( m_valid == false || size < 0 || size > m_remaining )
+		{
+			m_valid = false;
+			return false;
+		}
+
+		m_remaining -= size;
+
+		return true;
+	}
+
+	QIODevice* m_ioDevice;
+	qint64 m_remaining;
+	bool m_valid{true};
+
+} ;
+
+
+void writeValue( BinaryWriter& writer, const QVariant& value )
+{
+	switch( value.userType() )
+	{
+	case QMetaType::UnknownType:
+		writer.writeByte( quint8( BinaryType::Invalid ) );
+		break;
+	case QMetaType::Bool:
+		writer.writeByte( quint8( BinaryType::Bool ) );
+		writer.writeByte( value.toBool() ? 1 : 0 );
+		break;
+	case QMetaType::Int:
+		writer.writeByte( quint8( BinaryType::Int ) );
+		writer.writeVarint( zigZagEncode( value.toInt() ) );
+		break;
+	case QMetaType::UInt:
+		writer.writeByte( quint8( BinaryType::UInt ) );
+		writer.writeVarint( value.toUInt() );
+		break;
+	case QMetaType::LongLong:
+		writer.writeByte( quint8( BinaryType::LongLong ) );
+		writer.writeVarint( zigZagEncode( value.toLongLong() ) );
+		break;
+	case QMetaType::ULongLong:
+		writer.writeByte( quint8( BinaryType::ULongLong ) );
+		writer.writeVarint( value.toULongLong() );
+		break;
+	case QMetaType::QString:
+		writer.writeByte( quint8( BinaryType::String ) );
+		writer.writeBytes( value.toString().toUtf8() );
+		break;
+	case QMetaType::QByteArray:
+		writer.writeByte( quint8( BinaryType::ByteArray ) );
+		writer.writeBytes( value.toByteArray() );
+		break;
+	case QMetaType::QUuid:
+		writer.writeByte( quint8( BinaryType::Uuid ) );
+		writer.writeRaw( value.toUuid().toRfc4122() );
+		break;
+	default:
+	{
+		// fall back to QDataStream serialization for all other types
+		QByteArray data;
+		QDataStream stream( &data, QIODevice::WriteOnly );
+		stream.setVersion( QDataStream::Qt_5_5 );
+		stream << value;
+
+		writer.writeByte( quint8( BinaryType::Variant ) );
+		writer.writeBytes( data );
+		break;
+	}
+	}
+}
+
+
+QVariant readValue( BinaryReader& reader )
+{
+	switch( BinaryType( reader.readByte() ) )
+	{
+	case BinaryType::Invalid: return {};
+	case BinaryType::Bool: return reader.readByte() != 0;
+	case BinaryType::Int: return int( zigZagDecode( reader.readVarint() ) );
+	case BinaryType::UInt: return uint( reader.readVarint() );
+	case BinaryType::LongLong: return qlonglong( zigZagDecode( reader.readVarint() ) );
+	case BinaryType::ULongLong: return qulonglong( reader.readVarint() );
+	case BinaryType::String: return QString::fromUtf8( reader.readBytes() );
+	case BinaryType::ByteArray: return reader.readBytes();
+	case BinaryType::Uuid: return QUuid::fromRfc4122( reader.readRaw( UuidSize ) );
+	case BinaryType::Variant:
+	{
+		QVariant value;
+		QDataStream stream( reader.readBytes() );
+		stream.setVersion( QDataStream::Qt_5_5 );
+		stream >> value;
+		return value;
+	}
+	}
+
+	vWarning() << "invalid value type";
+
+	return {};
+}
+
+}
+
+
+
+bool FeatureMessage::send( QIODevice* ioDevice, Codec codec ) const
 {
 	if( ioDevice )
 	{
+		if( codec == Codec::Binary )
+		{
+			return sendBinary( ioDevice );
+		}
+
 		VariantArrayMessage message( ioDevice );
 
 		message.write( m_featureUid );
@@ -48,16 +364,22 @@ bool FeatureMessage::send( QIODevice* ioDevice ) const
 
 bool FeatureMessage::isReadyForReceive( QIODevice* ioDevice )
 {
+	// all codecs use the same framing
 	return ioDevice != nullptr &&
 			VariantArrayMessage( ioDevice ).isReadyForReceive();
 }
 
 
 
-bool FeatureMessage::receive( QIODevice* ioDevice )
+bool FeatureMessage::receive( QIODevice* ioDevice, Codec codec )
 {
 	if( ioDevice != nullptr )
 	{
+		if( codec == Codec::Binary )
+		{
+			return receiveBinary( ioDevice );
+		}
+
 		VariantArrayMessage message( ioDevice );
 
 		if( message.receive() )
@@ -77,3 +399,91 @@ bool FeatureMessage::receive( QIODevice* ioDevice )
 
 	return false;
 }
+
+
+
+FeatureMessage::Codec FeatureMessage::negotiateCodec( const QVariant& peerCodec )
+{
+	// peers not knowing about codecs do not send anything and thus get the default codec
+	return Codec( qBound( int(Codec::DataStream), peerCodec.isValid() ? peerCodec.toInt() : 0, int(LatestCodec) ) );
+}
+
+
+
+bool FeatureMessage::sendBinary( QIODevice* ioDevice ) const
+{
+	BinaryWriter writer;
+
+	// arguments are always indexed by integers (see addArgument())
+	QVector<int> indexes;
+	indexes.reserve( m_arguments.size() );
+
+	for( auto it = m_arguments.constBegin(), end = m_arguments.constEnd(); it != end; ++it )
+	{
+		bool isIndex = false;
+		indexes.append( it.key().toInt( &isIndex ) );
+		if( isIndex == false )
+		{
+			vWarning() << "can't encode argument with non-integer key" << it.key();
+			return false;
+		}
+	}
+
+	writer.writeRaw( m_featureUid.toRfc4122() );
+	writer.writeVarint( zigZagEncode( m_command ) );
+	writer.writeVarint( quint64( m_arguments.size() ) );
+
+	auto index = indexes.constBegin();
+	for( auto it = m_arguments.constBegin(), end = m_arguments.constEnd(); it != end; ++it, ++index )
+	{
+		writer.writeVarint( zigZagEncode( *index ) );
+		writeValue( writer, it.value() );
+	}
+
+	return writer.send( ioDevice );
+}
+
+
+
+bool FeatureMessage::receiveBinary( QIODevice* ioDevice )
+{
+	VariantArrayMessage::MessageSize messageSize = 0;
+
+	if( ioDevice->read( reinterpret_cast<char *>( &messageSize ), sizeof(messageSize) ) != sizeof(messageSize) ) // Flawfinder: ignore
+	{
+		vWarning() << "could not read message size!";
+		return false;
+	}
+
+	messageSize = qFromBigEndian(messageSize);
+	if( messageSize > VariantArrayMessage::MaxMessageSize )
+	{
+		vCritical() << "invalid message size" << messageSize;
+		return false;
+	}
+
+	BinaryReader reader( ioDevice, messageSize );
+
+	m_featureUid = QUuid::fromRfc4122( reader.readRaw( UuidSize ) );
+	m_command = Command( zigZagDecode( reader.readVarint() ) );
+	m_arguments.clear();
+
+	const auto argumentCount = reader.readVarint();
+
+	for( quint64 i = 0; i < argumentCount && reader.isValid(); ++i )
+	{
+		const auto index = zigZagDecode( reader.readVarint() );
+		const auto value = readValue( reader );
+		m_arguments[QString::number( index )] = value;
+	}
+
+	if( reader.isValid() == false || reader.atEnd() == false )
+	{
+		vWarning() << "could not decode message!";
+		// skip remaining data of corrupt message to keep stream in sync
+		reader.skipRemaining();
+		return false;
+	}
+
+	return true;
+}
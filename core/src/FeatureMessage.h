@@ -46,6 +46,16 @@ public:
 		InitCommand = -2,
 	};
 
+	// wire formats in ascending order - the highest one supported by both peers
+	// is negotiated during the handshake
+	enum class Codec
+	{
+		DataStream,
+		Binary,
+	};
+
+	static constexpr Codec LatestCodec = Codec::Binary;
+
 	explicit FeatureMessage( FeatureUid featureUid = {}, Command command = InvalidCommand ) :
 		m_featureUid( featureUid ),
 		m_command( command ),
@@ -99,13 +109,18 @@ public:
 		return m_arguments[QString::number( static_cast<int>( index ) )];
 	}
 
-	bool send( QIODevice* ioDevice ) const;
+	bool send( QIODevice* ioDevice, Codec codec = Codec::DataStream ) const;
 
 	bool isReadyForReceive( QIODevice* ioDevice );
 
-	bool receive( QIODevice* ioDevice );
+	bool receive( QIODevice* ioDevice, Codec codec = Codec::DataStream );
+
+	static Codec negotiateCodec( const QVariant& peerCodec );
 
 private:
+	bool sendBinary( QIODevice* ioDevice ) const;
+	bool receiveBinary( QIODevice* ioDevice );
+
 	FeatureUid m_featureUid;
 	Command m_command;
 	Arguments m_arguments;
@@ -164,9 +164,12 @@ protected:
 							 const ComputerControlInterfaceList& computerControlInterfaces,
 							 bool wake = true )
 	{
+		// encode message only once for all computers
+		const EncodedFeatureMessagePointer encodedMessage( new EncodedFeatureMessage( message ) );
+
 		for( const auto& controlInterface : computerControlInterfaces )
 		{
-			controlInterface->sendFeatureMessage( message, wake );
+			controlInterface->sendFeatureMessage( encodedMessage, wake );
 		}
 	}
 
@@ -35,41 +35,66 @@
 #include "PlatformCoreFunctions.h"
 #include "PlatformUserFunctions.h"
 
+#ifdef Q_OS_LINUX
+#include <pwd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
 // clazy:excludeall=detaching-member
 
 FeatureWorkerManager::FeatureWorkerManager( VeyonServerInterface& server, FeatureManager& featureManager, QObject* parent ) :
 	QObject( parent ),
 	m_server( server ),
 	m_featureManager( featureManager ),
-	m_tcpServer( this ),
+	m_localServer( this ),
 	m_workersMutex( QMutex::Recursive )
 {
-	connect( &m_tcpServer, &QTcpServer::newConnection,
+	connect( &m_localServer, &QLocalServer::newConnection,
 			 this, &FeatureWorkerManager::acceptConnection );
 
-	if( !m_tcpServer.listen( QHostAddress::LocalHost,
-							 static_cast<quint16>( VeyonCore::config().featureWorkerManagerPort() + VeyonCore::sessionId() ) ) )
+	// workers in user sessions run with different privileges, therefore
+	// every connecting peer is verified individually instead
+	m_localServer.setSocketOptions( QLocalServer::WorldAccessOption );
+
+	QLocalServer::removeServer( serverName() );
+
+	if( m_localServer.listen( serverName() ) == false )
 	{
-		vCritical() << "can't listen on localhost!";
+		vCritical() << "can't listen on" << serverName() << m_localServer.errorString();
 	}
 
-	auto pendingMessagesTimer = new QTimer( this );
-	connect( pendingMessagesTimer, &QTimer::timeout, this, &FeatureWorkerManager::sendPendingMessages );
-
-	pendingMessagesTimer->start( 100 );
+	QTimer::singleShot( 0, this, &FeatureWorkerManager::fillWorkerPool );
 }
 
 
 
 FeatureWorkerManager::~FeatureWorkerManager()
 {
-	m_tcpServer.close();
+	m_localServer.close();
+
+	// nobody must be notified while the server is shutting down
+	blockSignals( true );
 
 	// properly shutdown all worker processes
 	while( m_workers.isEmpty() == false )
 	{
 		stopWorker( m_workers.firstKey() );
 	}
+
+	for( const auto& worker : qAsConst(m_workerPool) )
+	{
+		terminateWorker( worker );
+	}
+
+	if( m_roundTripLatency.count() > 0 )
+	{
+		vDebug() << m_roundTripLatency.toString();
+	}
 }
 
 
@@ -86,6 +111,24 @@ bool FeatureWorkerManager::startManagedSystemWorker( Feature::Uid featureUid )
 
 	Worker worker;
 
+	if( takePooledWorker( worker ) )
+	{
+		vDebug() << "Assigning pooled worker to feature" << featureUid;
+
+		FeatureMessage( featureUid, FeatureMessage::InitCommand ).send( worker.socket, FeatureMessage::LatestCodec );
+
+		m_workersMutex.lock();
+		m_workers[featureUid] = worker;
+		m_workersMutex.unlock();
+
+		Q_EMIT runningWorkersChanged();
+
+		// replace the pooled worker in the background
+		QTimer::singleShot( 0, this, &FeatureWorkerManager::fillWorkerPool );
+
+		return true;
+	}
+
 	worker.process = new QProcess;
 	worker.process->setProcessChannelMode( QProcess::ForwardedChannels );
 
@@ -99,6 +142,8 @@ bool FeatureWorkerManager::startManagedSystemWorker( Feature::Uid featureUid )
 	m_workers[featureUid] = worker;
 	m_workersMutex.unlock();
 
+	Q_EMIT runningWorkersChanged();
+
 	return true;
 }
 
@@ -138,6 +183,8 @@ bool FeatureWorkerManager::startUnmanagedSessionWorker( Feature::Uid featureUid
 	m_workers[featureUid] = worker;
 	m_workersMutex.unlock();
 
+	Q_EMIT runningWorkersChanged();
+
 	return true;
 }
 
@@ -151,35 +198,25 @@ bool FeatureWorkerManager::stopWorker( Feature::Uid featureUid )
 		return false;
 	}
 
-	QMutexLocker locker( &m_workersMutex );
+	m_workersMutex.lock();
 
 	if( m_workers.contains( featureUid ) )
 	{
 		vDebug() << "Stopping worker for feature" << featureUid;
 
-		auto& worker = m_workers[featureUid];
+		terminateWorker( m_workers[featureUid] );
 
-		if( worker.socket )
-		{
-			worker.socket->disconnect( this );
-			disconnect( worker.socket );
+		m_workers.remove( featureUid );
 
-			worker.socket->close();
-			worker.socket->deleteLater();
-		}
+		m_workersMutex.unlock();
 
-		if( worker.process )
-		{
-			auto killTimer = new QTimer;
-			connect( killTimer, &QTimer::timeout, worker.process, &QProcess::terminate );
-			connect( killTimer, &QTimer::timeout, worker.process, &QProcess::kill );
-			connect( killTimer, &QTimer::timeout, killTimer, &QTimer::deleteLater );
-			killTimer->start( 5000 );
-		}
+		Q_EMIT runningWorkersChanged();
 
-		m_workers.remove( featureUid );
+		return false;
 	}
 
+	m_workersMutex.unlock();
+
 	return false;
 }
 
@@ -240,43 +277,228 @@ FeatureUidList FeatureWorkerManager::runningWorkers()
 
 
 
+QString FeatureWorkerManager::serverName()
+{
+	return QStringLiteral("VeyonFeatureWorkerManager-%1").arg( VeyonCore::sessionId() );
+}
+
+
+
+#ifdef Q_OS_WIN
+static QByteArray queryProcessTokenUser( DWORD processId )
+{
+	const auto process = OpenProcess( PROCESS_QUERY_LIMITED_INFORMATION, false, processId );
+	if( process == nullptr )
+	{
+		return {};
+	}
+
+	QByteArray tokenUser;
+	HANDLE token = nullptr;
+
+	if( OpenProcessToken( process, TOKEN_QUERY, &token ) )
+	{
+		DWORD size = 0;
+		GetTokenInformation( token, TokenUser, nullptr, 0, &size );
+		tokenUser.resize( int(size) );
+
+		if( size == 0 || GetTokenInformation( token, TokenUser, tokenUser.data(), size, &size ) == false )
+		{
+			tokenUser.clear();
+		}
+
+		CloseHandle( token );
+	}
+
+	CloseHandle( process );
+
+	return tokenUser;
+}
+#endif
+
+
+
+bool FeatureWorkerManager::isTrustedPeer( QLocalSocket* socket, const QString& sessionUser )
+{
+#ifdef Q_OS_LINUX
+	struct ucred credentials{};
+	socklen_t credentialsLength = sizeof(credentials);
+
+	if( getsockopt( int( socket->socketDescriptor() ), SOL_SOCKET, SO_PEERCRED,
+					&credentials, &credentialsLength ) != 0 )
+	{
+		vWarning() << "could not query peer credentials";
+		return false;
+	}
+
+	if( credentials.uid == 0 || credentials.uid == geteuid() )
+	{
+		return true;
+	}
+
+	if( sessionUser.isEmpty() == false )
+	{
+		const auto sessionUserInfo = getpwnam( sessionUser.toUtf8().constData() );
+		if( sessionUserInfo && sessionUserInfo->pw_uid == credentials.uid )
+		{
+			return true;
+		}
+	}
+
+	vWarning() << "untrusted peer with UID" << credentials.uid << "and PID" << credentials.pid;
+
+	return false;
+#elif defined(Q_OS_WIN)
+	ULONG processId = 0;
+	if( GetNamedPipeClientProcessId( HANDLE( socket->socketDescriptor() ), &processId ) == false )
+	{
+		vWarning() << "could not query peer process ID" << GetLastError();
+		return false;
+	}
+
+	// workers are always started in the session of the server
+	DWORD peerSessionId = 0;
+	DWORD serverSessionId = 0;
+	if( ProcessIdToSessionId( processId, &peerSessionId ) == false ||
+		ProcessIdToSessionId( GetCurrentProcessId(), &serverSessionId ) == false ||
+		peerSessionId != serverSessionId )
+	{
+		vWarning() << "untrusted peer with PID" << processId << "in session" << peerSessionId;
+		return false;
+	}
+
+	const auto peerTokenUser = queryProcessTokenUser( processId );
+	const auto serverTokenUser = queryProcessTokenUser( GetCurrentProcessId() );
+	if( peerTokenUser.isEmpty() || serverTokenUser.isEmpty() )
+	{
+		vWarning() << "could not query token user of peer with PID" << processId;
+		return false;
+	}
+
+	const auto peerSid = reinterpret_cast<const TOKEN_USER *>( peerTokenUser.constData() )->User.Sid;
+	const auto serverSid = reinterpret_cast<const TOKEN_USER *>( serverTokenUser.constData() )->User.Sid;
+	if( EqualSid( peerSid, serverSid ) )
+	{
+		return true;
+	}
+
+	wchar_t name[MAX_PATH]; // Flawfinder: ignore
+	wchar_t domain[MAX_PATH]; // Flawfinder: ignore
+	DWORD nameSize = MAX_PATH;
+	DWORD domainSize = MAX_PATH;
+	SID_NAME_USE sidNameUse;
+
+	if( sessionUser.isEmpty() == false &&
+		LookupAccountSid( nullptr, peerSid, name, &nameSize, domain, &domainSize, &sidNameUse ) )
+	{
+		// user names of local accounts are reported without domain
+		const auto peerUser = QString::fromWCharArray( name );
+		const auto peerDomainUser = QString::fromWCharArray( domain ) + QLatin1Char('\\') + peerUser;
+		if( sessionUser.compare( peerUser, Qt::CaseInsensitive ) == 0 ||
+			sessionUser.compare( peerDomainUser, Qt::CaseInsensitive ) == 0 )
+		{
+			return true;
+		}
+	}
+
+	vWarning() << "untrusted peer with PID" << processId;
+
+	return false;
+#else
+	Q_UNUSED(socket)
+	Q_UNUSED(sessionUser)
+
+	return true;
+#endif
+}
+
+
+
 void FeatureWorkerManager::acceptConnection()
 {
 	vDebug() << "accepting connection";
 
-	QTcpSocket* socket = m_tcpServer.nextPendingConnection();
+	auto socket = m_localServer.nextPendingConnection();
+
+	if( isTrustedPeer( socket, VeyonCore::platform().userFunctions().currentUser() ) == false )
+	{
+		vCritical() << "rejecting connection from untrusted peer";
+		socket->abort();
+		socket->deleteLater();
+		return;
+	}
 
 	// connect to readyRead() signal of new connection
-	connect( socket, &QTcpSocket::readyRead,
+	connect( socket, &QLocalSocket::readyRead,
 			 this, [=] () { processConnection( socket ); } );
 
-	connect( socket, &QTcpSocket::disconnected,
+	connect( socket, &QLocalSocket::disconnected,
 			 this, [=] () { closeConnection( socket ); } );
 }
 
 
 
-void FeatureWorkerManager::processConnection( QTcpSocket* socket )
+void FeatureWorkerManager::processConnection( QLocalSocket* socket )
 {
 	FeatureMessage message;
-	message.receive( socket );
 
+	// workers may send bursts of messages so process all complete messages at once
+	while( message.isReadyForReceive( socket ) )
+	{
+		if( message.receive( socket, FeatureMessage::LatestCodec ) == false )
+		{
+			// stream can't be resynchronized reliably after a malformed message
+			vWarning() << "closing connection after receiving malformed message from worker";
+			socket->abort();
+			break;
+		}
+
+		processMessage( socket, message );
+	}
+}
+
+
+
+void FeatureWorkerManager::processMessage( QLocalSocket* socket, const FeatureMessage& message )
+{
 	m_workersMutex.lock();
 
+	// idle worker registering with its token
+	const auto pooledWorker = m_workerPool.find( message.featureUid() );
+	if( pooledWorker != m_workerPool.end() )
+	{
+		pooledWorker->socket = socket;
+		m_workersMutex.unlock();
+
+		vDebug() << "pooled worker ready";
+		return;
+	}
+
 	// set socket information
 	if( m_workers.contains( message.featureUid() ) )
 	{
-		if( m_workers[message.featureUid()].socket.isNull() )
+		auto& worker = m_workers[message.featureUid()];
+		if( worker.socket.isNull() )
+		{
+			worker.socket = socket;
+			sendPendingMessages( message.featureUid() );
+		}
+		else if( message.command() >= 0 && worker.roundTripTimer.isValid() )
 		{
-			m_workers[message.featureUid()].socket = socket;
-			sendPendingMessages();
+			m_roundTripLatency.add( worker.roundTripTimer.elapsed() );
+			worker.roundTripTimer.invalidate();
+
+			if( m_roundTripLatency.count() % RoundTripLatencySummaryInterval == 0 )
+			{
+				vDebug() << m_roundTripLatency.toString();
+			}
 		}
 
 		m_workersMutex.unlock();
 
 		if( message.command() >= 0 )
 		{
-			m_featureManager.handleFeatureMessage( m_server, MessageContext( socket ), message );
+			m_featureManager.handleFeatureMessage( m_server, MessageContext( socket, FeatureMessage::LatestCodec ), message );
 		}
 	}
 	else
@@ -289,16 +511,33 @@ void FeatureWorkerManager::processConnection( QTcpSocket* socket )
 
 
 
-void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
+void FeatureWorkerManager::closeConnection( QLocalSocket* socket )
 {
 	m_workersMutex.lock();
 
+	bool workersChanged = false;
+	bool poolChanged = false;
+
+	for( auto it = m_workerPool.begin(); it != m_workerPool.end(); )
+	{
+		if( it.value().socket == socket )
+		{
+			it = m_workerPool.erase( it );
+			poolChanged = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
 	for( auto it = m_workers.begin(); it != m_workers.end(); )
 	{
 		if( it.value().socket == socket )
 		{
 			vDebug() << "removing worker after socket has been closed";
 			it = m_workers.erase( it );
+			workersChanged = true;
 		}
 		else
 		{
@@ -308,6 +547,16 @@ void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
 
 	m_workersMutex.unlock();
 
+	if( poolChanged )
+	{
+		QTimer::singleShot( WorkerPoolRefillDelay, this, &FeatureWorkerManager::fillWorkerPool );
+	}
+
+	if( workersChanged )
+	{
+		Q_EMIT runningWorkersChanged();
+	}
+
 	socket->deleteLater();
 }
 
@@ -319,32 +568,145 @@ void FeatureWorkerManager::sendMessage( const FeatureMessage& message )
 
 	if( m_workers.contains( message.featureUid() ) )
 	{
-		m_workers[message.featureUid()].pendingMessages.append( message );
+		m_workers[message.featureUid()].pendingMessages.append( PendingMessage( message ) );
+		m_workersMutex.unlock();
+
+		sendPendingMessages( message.featureUid() );
 	}
 	else
 	{
+		m_workersMutex.unlock();
+
 		vWarning() << "worker does not exist for feature" << message.featureUid();
 	}
+}
 
-	m_workersMutex.unlock();
+
+
+void FeatureWorkerManager::sendPendingMessages( Feature::Uid featureUid )
+{
+	// sockets must only be written to from within their own thread
+	if( thread() != QThread::currentThread() )
+	{
+		QMetaObject::invokeMethod( this, [=]() { sendPendingMessages( featureUid ); }, Qt::QueuedConnection );
+		return;
+	}
+
+	QMutexLocker locker( &m_workersMutex );
+
+	const auto it = m_workers.find( featureUid );
+
+	// messages remain queued until the worker has connected
+	if( it == m_workers.end() || it->socket.isNull() )
+	{
+		return;
+	}
+
+	auto& worker = it.value();
+
+	while( worker.pendingMessages.isEmpty() == false )
+	{
+		const auto pendingMessage = worker.pendingMessages.takeFirst();
+		pendingMessage.message.send( worker.socket, FeatureMessage::LatestCodec );
+
+		// measure until the worker answers, including the time spent in the queue
+		if( worker.roundTripTimer.isValid() == false )
+		{
+			worker.roundTripTimer = pendingMessage.queueTimer;
+		}
+	}
 }
 
 
 
-void FeatureWorkerManager::sendPendingMessages()
+void FeatureWorkerManager::fillWorkerPool()
 {
-	m_workersMutex.lock();
+	const auto poolSize = VeyonCore::config().featureWorkerPoolSize();
+
+	QMutexLocker locker( &m_workersMutex );
+
+	// forget about pooled workers which exited unexpectedly
+	for( auto it = m_workerPool.begin(); it != m_workerPool.end(); )
+	{
+		if( it.value().process.isNull() )
+		{
+			it = m_workerPool.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
 
-	for( auto it = m_workers.begin(); it != m_workers.end(); ++it )
+	while( m_workerPool.size() < poolSize )
 	{
-		auto& worker = it.value();
+		const auto token = QUuid::createUuid();
+
+		Worker worker;
+		worker.process = new QProcess;
+		worker.process->setProcessChannelMode( QProcess::ForwardedChannels );
+
+		connect( worker.process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+				 worker.process, &QProcess::deleteLater );
+
+		// replace idle workers which exited or crashed - delayed so that failing workers aren't restarted in a tight loop
+		connect( worker.process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+				 this, [this, token]() {
+			QMutexLocker locker( &m_workersMutex );
+			if( m_workerPool.contains( token ) )
+			{
+				vDebug() << "pooled worker" << token << "exited";
+				QTimer::singleShot( WorkerPoolRefillDelay, this, &FeatureWorkerManager::fillWorkerPool );
+			}
+		} );
+
+		vDebug() << "Starting pooled worker" << token;
+		worker.process->start( VeyonCore::filesystem().workerFilePath(), { poolWorkerArgument(), token.toString() } );
+
+		m_workerPool[token] = worker;
+	}
+}
+
 
-		while( worker.socket && worker.pendingMessages.isEmpty() == false )
+
+bool FeatureWorkerManager::takePooledWorker( Worker& worker )
+{
+	QMutexLocker locker( &m_workersMutex );
+
+	for( auto it = m_workerPool.begin(); it != m_workerPool.end(); ++it )
+	{
+		// only workers which have finished initialization and connected back are usable
+		if( it.value().socket && it.value().process &&
+			it.value().process->state() == QProcess::Running )
 		{
-			worker.pendingMessages.first().send( worker.socket );
-			worker.pendingMessages.removeFirst();
+			worker = it.value();
+			m_workerPool.erase( it );
+			return true;
 		}
 	}
 
-	m_workersMutex.unlock();
+	return false;
+}
+
+
+
+void FeatureWorkerManager::terminateWorker( const Worker& worker )
+{
+	if( worker.socket )
+	{
+		worker.socket->disconnect( this );
+		disconnect( worker.socket );
+
+		worker.socket->close();
+		worker.socket->deleteLater();
+	}
+
+	if( worker.process )
+	{
+		auto killTimer = new QTimer;
+		connect( killTimer, &QTimer::timeout, worker.process, &QProcess::terminate );
+		connect( killTimer, &QTimer::timeout, worker.process, &QProcess::kill );
+		connect( killTimer, &QTimer::timeout, killTimer, &QTimer::deleteLater );
+		killTimer->start( 5000 );
+	}
 }
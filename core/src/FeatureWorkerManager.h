@@ -24,13 +24,15 @@
 
 #pragma once
 
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <QMutex>
 #include <QPointer>
 #include <QProcess>
-#include <QTcpServer>
-#include <QTcpSocket>
 
 #include "FeatureMessage.h"
+#include "LatencyHistogram.h"
 
 class FeatureManager;
 class VeyonServerInterface;
@@ -53,31 +55,69 @@ public:
 	bool isWorkerRunning( Feature::Uid featureUid );
 	FeatureUidList runningWorkers();
 
+	static QString serverName();
+	static QString poolWorkerArgument()
+	{
+		return QStringLiteral("pool");
+	}
+
+	static bool isTrustedPeer( QLocalSocket* socket, const QString& sessionUser = {} );
+
+Q_SIGNALS:
+	void runningWorkersChanged();
+
 private:
 	void acceptConnection();
-	void processConnection( QTcpSocket* socket );
-	void closeConnection( QTcpSocket* socket );
+	void processConnection( QLocalSocket* socket );
+	void processMessage( QLocalSocket* socket, const FeatureMessage& message );
+	void closeConnection( QLocalSocket* socket );
 
 	void sendMessage( const FeatureMessage& message );
 
-	void sendPendingMessages();
+	void sendPendingMessages( Feature::Uid featureUid );
+
+	void fillWorkerPool();
 
 	static constexpr auto UnmanagedSessionProcessRetryInterval = 5000;
+	static constexpr auto WorkerPoolRefillDelay = 1000;
+	static constexpr auto RoundTripLatencySummaryInterval = 100;
 
 	VeyonServerInterface& m_server;
 	FeatureManager& m_featureManager;
-	QTcpServer m_tcpServer;
+	QLocalServer m_localServer;
+
+	struct PendingMessage
+	{
+		explicit PendingMessage( const FeatureMessage& featureMessage ) :
+			message( featureMessage )
+		{
+			queueTimer.start();
+		}
+
+		FeatureMessage message;
+		QElapsedTimer queueTimer;
+	};
 
 	struct Worker
 	{
-		QPointer<QTcpSocket> socket;
+		QPointer<QLocalSocket> socket;
 		QPointer<QProcess> process;
-		QList<FeatureMessage> pendingMessages;
+		QList<PendingMessage> pendingMessages;
+		// started when the oldest message not yet answered by the worker was queued
+		QElapsedTimer roundTripTimer;
 	};
 
 	using WorkerMap = QMap<Feature::Uid, Worker>;
 	WorkerMap m_workers;
 
+	// idle managed system workers keyed by the token they register with
+	WorkerMap m_workerPool;
+
+	bool takePooledWorker( Worker& worker );
+	void terminateWorker( const Worker& worker );
+
 	QMutex m_workersMutex;
 
+	LatencyHistogram m_roundTripLatency{QStringLiteral("feature message round trip latency")};
+
 } ;
@@ -27,6 +27,7 @@
 #include <QUrl>
 
 #include "HostAddress.h"
+#include "HostAddressResolver.h"
 
 
 HostAddress::HostAddress( const QString& address ) :
@@ -37,7 +38,7 @@ HostAddress::HostAddress( const QString& address ) :
 
 
 
-bool HostAddress::isLocalHost() const
+bool HostAddress::isLocalHost( LookupMode lookupMode ) const
 {
 	if( type() == Type::Invalid || m_address.isEmpty() )
 	{
@@ -52,7 +53,13 @@ bool HostAddress::isLocalHost() const
 		return hostAddress.isLoopback() || allLocalAddresses.contains( hostAddress );
 	}
 
-	const auto addresses = QHostInfo::fromName( m_address ).addresses();
+	QHostInfo hostInfo;
+	if( lookupHost( m_address, lookupMode, &hostInfo ) == false )
+	{
+		return false;
+	}
+
+	const auto addresses = hostInfo.addresses();
 	for( const auto& address : addresses )
 	{
 		if( address.isLoopback() || allLocalAddresses.contains( address ) )
@@ -66,7 +73,7 @@ bool HostAddress::isLocalHost() const
 
 
 
-QString HostAddress::convert( HostAddress::Type targetType ) const
+QString HostAddress::convert( HostAddress::Type targetType, LookupMode lookupMode ) const
 {
 	if( m_type == targetType )
 	{
@@ -76,9 +83,9 @@ QString HostAddress::convert( HostAddress::Type targetType ) const
 	switch( targetType )
 	{
 	case Type::Invalid: return {};
-	case Type::IpAddress: return toIpAddress( m_address );
-	case Type::HostName: return toHostName( m_type, m_address );
-	case Type::FullyQualifiedDomainName: return toFQDN( m_type, m_address );
+	case Type::IpAddress: return toIpAddress( m_address, lookupMode );
+	case Type::HostName: return toHostName( m_type, m_address, lookupMode );
+	case Type::FullyQualifiedDomainName: return toFQDN( m_type, m_address, lookupMode );
 	}
 
 	vWarning() << "invalid address type" << targetType;
@@ -87,9 +94,9 @@ QString HostAddress::convert( HostAddress::Type targetType ) const
 
 
 
-QString HostAddress::tryConvert( HostAddress::Type targetType ) const
+QString HostAddress::tryConvert( HostAddress::Type targetType, LookupMode lookupMode ) const
 {
-	const auto address = convert( targetType );
+	const auto address = convert( targetType, lookupMode );
 	if( address.isEmpty() )
 	{
 		return m_address;
@@ -103,7 +110,7 @@ QString HostAddress::tryConvert( HostAddress::Type targetType ) const
 QStringList HostAddress::lookupIpAddresses() const
 {
 	const auto hostName = convert( Type::FullyQualifiedDomainName );
-	const auto hostInfo = QHostInfo::fromName( hostName );
+	const auto hostInfo = VeyonCore::hostAddressResolver().lookup( hostName );
 	if( hostInfo.error() != QHostInfo::NoError || hostInfo.addresses().isEmpty() )
 	{
 		vWarning() << "could not lookup IP addresses of host" << hostName << "error:" << hostInfo.errorString();
@@ -204,7 +211,23 @@ HostAddress::Type HostAddress::determineType( const QString& address )
 
 
 
-QString HostAddress::toIpAddress( const QString& hostName )
+bool HostAddress::lookupHost( const QString& name, LookupMode lookupMode, QHostInfo* hostInfo )
+{
+	auto& resolver = VeyonCore::hostAddressResolver();
+
+	if( lookupMode == LookupMode::CachedOnly )
+	{
+		return resolver.lookupCached( name, hostInfo );
+	}
+
+	*hostInfo = resolver.lookup( name );
+
+	return true;
+}
+
+
+
+QString HostAddress::toIpAddress( const QString& hostName, LookupMode lookupMode )
 {
 	if( hostName.isEmpty() )
 	{
@@ -213,7 +236,12 @@ QString HostAddress::toIpAddress( const QString& hostName )
 	}
 
 	// then try to resolve ist first
-	const auto hostInfo = QHostInfo::fromName( hostName );
+	QHostInfo hostInfo;
+	if( lookupHost( hostName, lookupMode, &hostInfo ) == false )
+	{
+		return {};
+	}
+
 	if( hostInfo.error() != QHostInfo::NoError || hostInfo.addresses().isEmpty() )
 	{
 		vWarning() << "could not lookup IP address of host" << hostName << "error:" << hostInfo.errorString();
@@ -228,7 +256,7 @@ QString HostAddress::toIpAddress( const QString& hostName )
 
 
 
-QString HostAddress::toHostName( HostAddress::Type type, const QString& address )
+QString HostAddress::toHostName( HostAddress::Type type, const QString& address, LookupMode lookupMode )
 {
 	if( address.isEmpty() )
 	{
@@ -243,7 +271,12 @@ QString HostAddress::toHostName( HostAddress::Type type, const QString& address
 
 	case Type::IpAddress:
 	{
-		const auto hostInfo = QHostInfo::fromName( address );
+		QHostInfo hostInfo;
+		if( lookupHost( address, lookupMode, &hostInfo ) == false )
+		{
+			return {};
+		}
+
 		if( hostInfo.error() != QHostInfo::NoError )
 		{
 			vWarning() << "could not lookup hostname for IP address" << address << "error:" << hostInfo.errorString();
@@ -264,7 +297,7 @@ QString HostAddress::toHostName( HostAddress::Type type, const QString& address
 }
 
 
-QString HostAddress::toFQDN( HostAddress::Type type, const QString& address )
+QString HostAddress::toFQDN( HostAddress::Type type, const QString& address, LookupMode lookupMode )
 {
 	if( address.isEmpty() )
 	{
@@ -275,11 +308,16 @@ QString HostAddress::toFQDN( HostAddress::Type type, const QString& address )
 	switch( type )
 	{
 	case Type::HostName:
-		return toFQDN( Type::IpAddress, toIpAddress( address ) );
+		return toFQDN( Type::IpAddress, toIpAddress( address, lookupMode ), lookupMode );
 
 	case Type::IpAddress:
 	{
-		const auto hostInfo = QHostInfo::fromName( address );
+		QHostInfo hostInfo;
+		if( lookupHost( address, lookupMode, &hostInfo ) == false )
+		{
+			return {};
+		}
+
 		if( hostInfo.error() != QHostInfo::NoError )
 		{
 			vWarning() << "could not lookup hostname for IP address" << address << "error:" << hostInfo.errorString();
@@ -26,6 +26,8 @@
 
 #include "VeyonCore.h"
 
+class QHostInfo;
+
 class VEYON_CORE_EXPORT HostAddress
 {
 	Q_GADGET
@@ -38,6 +40,12 @@ public:
 	};
 	Q_ENUM(Type)
 
+	enum class LookupMode {
+		Blocking,
+		CachedOnly
+	};
+	Q_ENUM(LookupMode)
+
 	explicit HostAddress( const QString& address );
 	~HostAddress() = default;
 
@@ -46,10 +54,10 @@ public:
 		return m_type;
 	}
 
-	bool isLocalHost() const;
+	bool isLocalHost( LookupMode lookupMode = LookupMode::Blocking ) const;
 
-	QString convert( Type targetType ) const;
-	QString tryConvert( Type targetType ) const;
+	QString convert( Type targetType, LookupMode lookupMode = LookupMode::Blocking ) const;
+	QString tryConvert( Type targetType, LookupMode lookupMode = LookupMode::Blocking ) const;
 
 	QStringList lookupIpAddresses() const;
 
@@ -60,9 +68,10 @@ public:
 
 private:
 	static Type determineType( const QString& address );
-	static QString toIpAddress( const QString& hostName );
-	static QString toHostName( Type type, const QString& address );
-	static QString toFQDN( Type type, const QString& address );
+	static bool lookupHost( const QString& name, LookupMode lookupMode, QHostInfo* hostInfo );
+	static QString toIpAddress( const QString& hostName, LookupMode lookupMode );
+	static QString toHostName( Type type, const QString& address, LookupMode lookupMode );
+	static QString toFQDN( Type type, const QString& address, LookupMode lookupMode );
 	static QString fqdnToHostName( const QString& fqdn );
 
 	Type m_type;
@@ -0,0 +1,212 @@
+/*
+ * HostAddressResolver.cpp - implementation of HostAddressResolver class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QThread>
+
+#include "HostAddressResolver.h"
+
+
+HostAddressResolver::HostAddressResolver( QObject* parent ) :
+	QObject( parent )
+{
+}
+
+
+
+QHostInfo HostAddressResolver::lookup( const QString& name )
+{
+	QHostInfo hostInfo;
+	if( findCacheEntry( name, &hostInfo ) != CacheState::Missing )
+	{
+		return hostInfo;
+	}
+
+	hostInfo = QHostInfo::fromName( name );
+	insert( name, hostInfo );
+
+	return hostInfo;
+}
+
+
+
+bool HostAddressResolver::lookupCached( const QString& name, QHostInfo* hostInfo )
+{
+	if( findCacheEntry( name, hostInfo ) != CacheState::Missing )
+	{
+		return true;
+	}
+
+	startLookup( name );
+
+	return false;
+}
+
+
+
+bool HostAddressResolver::lookup( const QString& name, QObject* context, const Callback& callback )
+{
+	if( name.isEmpty() )
+	{
+		return false;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	if( m_cache.contains( name ) )
+	{
+		locker.unlock();
+
+		// refresh expired entry if required
+		findCacheEntry( name, nullptr );
+
+		return true;
+	}
+
+	// all callers waiting for the same name share a single pending lookup
+	m_pendingCallbacks[name].append( { context, callback } );
+
+	locker.unlock();
+
+	startLookup( name );
+
+	return false;
+}
+
+
+
+bool HostAddressResolver::isCached( const QString& name )
+{
+	QMutexLocker locker( &m_mutex );
+
+	return m_cache.contains( name );
+}
+
+
+
+void HostAddressResolver::clear()
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_cache.clear();
+}
+
+
+
+HostAddressResolver::CacheState HostAddressResolver::findCacheEntry( const QString& name, QHostInfo* hostInfo )
+{
+	QMutexLocker locker( &m_mutex );
+
+	const auto it = m_cache.constFind( name );
+	if( it == m_cache.constEnd() )
+	{
+		return CacheState::Missing;
+	}
+
+	if( hostInfo )
+	{
+		*hostInfo = it->hostInfo;
+	}
+
+	const int timeToLive = it->hostInfo.error() == QHostInfo::NoError ? int(TimeToLive) : int(NegativeTimeToLive);
+	if( it->age.elapsed() < timeToLive )
+	{
+		return CacheState::Valid;
+	}
+
+	// serve stale entry while refreshing it
+	locker.unlock();
+	startLookup( name );
+
+	return CacheState::Expired;
+}
+
+
+
+void HostAddressResolver::insert( const QString& name, const QHostInfo& hostInfo )
+{
+	QMutexLocker locker( &m_mutex );
+
+	if( m_cache.size() >= MaximumCacheSize && m_cache.contains( name ) == false )
+	{
+		m_cache.clear();
+	}
+
+	auto& entry = m_cache[name];
+	entry.hostInfo = hostInfo;
+	entry.age.start();
+}
+
+
+
+void HostAddressResolver::startLookup( const QString& name )
+{
+	if( name.isEmpty() )
+	{
+		return;
+	}
+
+	// perform lookups in our own thread so that results are always delivered
+	// through its event loop
+	if( QThread::currentThread() != thread() )
+	{
+		QMetaObject::invokeMethod( this, [=]() { startLookup( name ); }, Qt::QueuedConnection );
+		return;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	if( m_pendingLookups.contains( name ) )
+	{
+		return;
+	}
+
+	m_pendingLookups.insert( name );
+
+	locker.unlock();
+
+	QHostInfo::lookupHost( name, this, [=]( const QHostInfo& hostInfo ) {
+		if( hostInfo.error() != QHostInfo::NoError )
+		{
+			vDebug() << "lookup of" << name << "failed:" << hostInfo.errorString();
+		}
+
+		insert( name, hostInfo );
+
+		m_mutex.lock();
+		m_pendingLookups.remove( name );
+		const auto callbacks = m_pendingCallbacks.take( name );
+		m_mutex.unlock();
+
+		Q_EMIT lookupFinished( name );
+
+		for( const auto& pendingCallback : callbacks )
+		{
+			if( pendingCallback.context )
+			{
+				// run callback in the thread of its context
+				QMetaObject::invokeMethod( pendingCallback.context, pendingCallback.callback );
+			}
+		}
+	} );
+}
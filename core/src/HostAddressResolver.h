@@ -0,0 +1,92 @@
+/*
+ * HostAddressResolver.h - declaration of HostAddressResolver class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostInfo>
+#include <QMutex>
+#include <QPointer>
+#include <QSet>
+
+#include "VeyonCore.h"
+
+// process-wide cache for forward and reverse host lookups - expired entries
+// are still served while being refreshed in the background, failed lookups are
+// cached for a shorter period of time
+class VEYON_CORE_EXPORT HostAddressResolver : public QObject
+{
+	Q_OBJECT
+public:
+	using Callback = std::function<void(void)>;
+
+	static constexpr int TimeToLive = 300000;
+	static constexpr int NegativeTimeToLive = 30000;
+	static constexpr int MaximumCacheSize = 4096;
+
+	explicit HostAddressResolver( QObject* parent = nullptr );
+	~HostAddressResolver() override = default;
+
+	QHostInfo lookup( const QString& name );
+	bool lookupCached( const QString& name, QHostInfo* hostInfo );
+	bool lookup( const QString& name, QObject* context, const Callback& callback );
+
+	bool isCached( const QString& name );
+
+	void clear();
+
+Q_SIGNALS:
+	void lookupFinished( const QString& name );
+
+private:
+	struct CacheEntry
+	{
+		QHostInfo hostInfo;
+		QElapsedTimer age;
+	};
+
+	struct PendingCallback
+	{
+		QPointer<QObject> context;
+		Callback callback;
+	};
+
+	enum class CacheState
+	{
+		Missing,
+		Expired,
+		Valid
+	};
+
+	CacheState findCacheEntry( const QString& name, QHostInfo* hostInfo );
+	void insert( const QString& name, const QHostInfo& hostInfo );
+	void startLookup( const QString& name );
+
+	QMutex m_mutex{};
+	QHash<QString, CacheEntry> m_cache{};
+	QSet<QString> m_pendingLookups{};
+	QHash<QString, QVector<PendingCallback>> m_pendingCallbacks{};
+
+} ;
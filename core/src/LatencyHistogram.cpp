@@ -0,0 +1,96 @@
+/*
+ * LatencyHistogram.cpp - implementation of LatencyHistogram class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "LatencyHistogram.h"
+
+
+void LatencyHistogram::add( qint64 milliseconds )
+{
+	milliseconds = qMax<qint64>( 0, milliseconds );
+
+	int bucket = 0;
+	while( bucket < BucketCount-1 && ( qint64(1) << bucket ) <= milliseconds )
+	{
+		++bucket;
+	}
+
+	++m_buckets[bucket];
+	++m_count;
+	m_sum += milliseconds;
+	m_max = qMax( m_max, milliseconds );
+}
+
+
+
+qint64 LatencyHistogram::percentile( int percent ) const
+{
+	if( m_count <= 0 )
+	{
+		return 0;
+	}
+
+	const auto threshold = ( m_count * qBound( 0, percent, 100 ) + 99 ) / 100;
+
+	qint64 accumulated = 0;
+	for( int bucket = 0; bucket < BucketCount; ++bucket )
+	{
+		accumulated += m_buckets[bucket];
+		if( accumulated >= threshold )
+		{
+			// report upper bound of bucket
+			return qMin( m_max, qint64(1) << bucket );
+		}
+	}
+
+	return m_max;
+}
+
+
+
+QString LatencyHistogram::toString() const
+{
+	QStringList buckets;
+
+	for( int bucket = 0; bucket < BucketCount; ++bucket )
+	{
+		if( m_buckets[bucket] > 0 && bucket == BucketCount-1 )
+		{
+			buckets.append( QStringLiteral(">=%1ms:%2").arg( qint64(1) << (bucket-1) ).arg( m_buckets[bucket] ) );
+		}
+		else if( m_buckets[bucket] > 0 )
+		{
+			buckets.append( QStringLiteral("<%1ms:%2").arg( qint64(1) << bucket ).arg( m_buckets[bucket] ) );
+		}
+	}
+
+	return QStringLiteral("%1: n=%2 avg=%3ms p50=%4ms p90=%5ms p99=%6ms max=%7ms [%8]")
+			.arg( m_name )
+			.arg( m_count )
+			.arg( m_count > 0 ? m_sum / m_count : 0 )
+			.arg( percentile( 50 ) )
+			.arg( percentile( 90 ) )
+			.arg( percentile( 99 ) )
+			.arg( m_max )
+			.arg( buckets.join( QLatin1Char(' ') ) );
+}
@@ -0,0 +1,60 @@
+/*
+ * LatencyHistogram.h - declaration of LatencyHistogram class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include "VeyonCore.h"
+
+// histogram with power-of-two millisecond buckets, i.e. bucket n counts
+// samples in the range [2^(n-1), 2^n) ms while the last bucket collects all
+// remaining samples
+class VEYON_CORE_EXPORT LatencyHistogram
+{
+public:
+	static constexpr int BucketCount = 16;
+
+	explicit LatencyHistogram( const QString& name ) :
+		m_name( name )
+	{
+	}
+
+	void add( qint64 milliseconds );
+
+	qint64 count() const
+	{
+		return m_count;
+	}
+
+	qint64 percentile( int percent ) const;
+
+	QString toString() const;
+
+private:
+	QString m_name;
+	std::array<qint64, BucketCount> m_buckets{};
+	qint64 m_count{0};
+	qint64 m_sum{0};
+	qint64 m_max{0};
+
+} ;
@@ -26,7 +26,7 @@
 
 #include <QPointer>
 
-#include "VeyonCore.h"
+#include "FeatureMessage.h"
 
 class QIODevice;
 
@@ -35,8 +35,9 @@ class VEYON_CORE_EXPORT MessageContext
 public:
 	using IODevice = QPointer<QIODevice>;
 
-	explicit MessageContext( QIODevice* ioDevice ) :
-		m_ioDevice( ioDevice )
+	explicit MessageContext( QIODevice* ioDevice, FeatureMessage::Codec codec = FeatureMessage::Codec::DataStream ) :
+		m_ioDevice( ioDevice ),
+		m_codec( codec )
 	{
 	}
 
@@ -47,7 +48,13 @@ public:
 		return m_ioDevice;
 	}
 
+	FeatureMessage::Codec codec() const
+	{
+		return m_codec;
+	}
+
 private:
 	IODevice m_ioDevice;
+	FeatureMessage::Codec m_codec;
 
 } ;
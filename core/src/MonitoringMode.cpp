@@ -23,6 +23,9 @@
  */
 
 #include <QtConcurrent>
+#include <QTimer>
+
+#include <algorithm>
 
 #include "MonitoringMode.h"
 #include "PlatformSessionFunctions.h"
@@ -45,13 +48,25 @@ MonitoringMode::MonitoringMode( QObject* parent ) :
 									Feature::Uid(), {}, {}, {} ),
 	m_features( { m_monitoringModeFeature, m_queryLoggedOnUserInfoFeature } )
 {
+	m_userInformationRetryTimer.setSingleShot( true );
+	m_userInformationRetryTimer.setInterval( UserInformationRetryInterval );
+	connect( &m_userInformationRetryTimer, &QTimer::timeout, this, &MonitoringMode::queryUserInformation );
 }
 
 
 
 void MonitoringMode::queryLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces )
 {
-	sendFeatureMessage( FeatureMessage{ m_queryLoggedOnUserInfoFeature.uid(), FeatureMessage::DefaultCommand },
+	sendFeatureMessage( FeatureMessage{ m_queryLoggedOnUserInfoFeature.uid(), QueryLoggedOnUserInfo },
+						computerControlInterfaces, false );
+}
+
+
+
+void MonitoringMode::subscribeLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	// servers without subscription support treat this as a query
+	sendFeatureMessage( FeatureMessage{ m_queryLoggedOnUserInfoFeature.uid(), SubscribeLoggedOnUserInfo },
 						computerControlInterfaces, false );
 }
 
@@ -62,6 +77,14 @@ bool MonitoringMode::handleFeatureMessage( ComputerControlInterface::Pointer com
 {
 	if( message.featureUid() == m_queryLoggedOnUserInfoFeature.uid() )
 	{
+		const auto sequenceNumber = message.argument( Argument::SequenceNumber );
+		if( sequenceNumber.isValid() &&
+			computerControlInterface->acceptStateUpdate( ComputerControlInterface::StateSubscription::UserInformation,
+														 sequenceNumber.toInt() ) == false )
+		{
+			return true;
+		}
+
 		computerControlInterface->setUserInformation( message.argument( Argument::UserLoginName ).toString(),
 													  message.argument( Argument::UserFullName ).toString(),
 													  message.argument( Argument::UserSessionId ).toInt() );
@@ -81,22 +104,23 @@ bool MonitoringMode::handleFeatureMessage( VeyonServerInterface& server,
 	if( m_queryLoggedOnUserInfoFeature.uid() == message.featureUid() )
 	{
 		FeatureMessage reply( message.featureUid(), message.command() );
+		addUserInformation( reply );
 
-		m_userDataLock.lockForRead();
-		if( m_userLoginName.isEmpty() )
+		if( message.command() == SubscribeLoggedOnUserInfo )
 		{
-			queryUserInformation();
-			reply.addArgument( Argument::UserLoginName, QString() );
-			reply.addArgument( Argument::UserFullName, QString() );
-			reply.addArgument( Argument::UserSessionId, -1 );
+			m_server = &server;
+
+			const auto alreadySubscribed = std::any_of( m_subscribers.constBegin(), m_subscribers.constEnd(),
+				[&messageContext]( const MessageContext& subscriber ) {
+					return subscriber.ioDevice() == messageContext.ioDevice();
+				} );
+			if( alreadySubscribed == false )
+			{
+				m_subscribers.append( messageContext );
+			}
+
+			reply.addArgument( Argument::SequenceNumber, m_sequenceNumber );
 		}
-		else
-		{
-			reply.addArgument( Argument::UserLoginName, m_userLoginName );
-			reply.addArgument( Argument::UserFullName, m_userFullName );
-			reply.addArgument( Argument::UserSessionId, m_userSessionId );
-		}
-		m_userDataLock.unlock();
 
 		return server.sendFeatureMessageReply( messageContext, reply );
 	}
@@ -106,6 +130,50 @@ bool MonitoringMode::handleFeatureMessage( VeyonServerInterface& server,
 
 
 
+void MonitoringMode::addUserInformation( FeatureMessage& message )
+{
+	m_userDataLock.lockForRead();
+	if( m_userLoginName.isEmpty() )
+	{
+		queryUserInformation();
+		message.addArgument( Argument::UserLoginName, QString() );
+		message.addArgument( Argument::UserFullName, QString() );
+		message.addArgument( Argument::UserSessionId, -1 );
+	}
+	else
+	{
+		message.addArgument( Argument::UserLoginName, m_userLoginName );
+		message.addArgument( Argument::UserFullName, m_userFullName );
+		message.addArgument( Argument::UserSessionId, m_userSessionId );
+	}
+	m_userDataLock.unlock();
+}
+
+
+
+void MonitoringMode::publishUserInformation()
+{
+	removeClosedSubscribers();
+
+	++m_sequenceNumber;
+
+	if( m_server == nullptr || m_subscribers.isEmpty() )
+	{
+		return;
+	}
+
+	FeatureMessage message( m_queryLoggedOnUserInfoFeature.uid(), SubscribeLoggedOnUserInfo );
+	addUserInformation( message );
+	message.addArgument( Argument::SequenceNumber, m_sequenceNumber );
+
+	for( const auto& subscriber : qAsConst( m_subscribers ) )
+	{
+		m_server->sendFeatureMessageReply( subscriber, message );
+	}
+}
+
+
+
 void MonitoringMode::queryUserInformation()
 {
 	// asynchronously query information about logged on user (which might block
@@ -115,9 +183,49 @@ void MonitoringMode::queryUserInformation()
 		const auto userFullName = VeyonCore::platform().userFunctions().fullName( userLoginName );
 		const auto userSessionId = VeyonCore::sessionId();
 		m_userDataLock.lockForWrite();
+		const auto changed = userLoginName != m_userLoginName ||
+							 userFullName != m_userFullName ||
+							 userSessionId != m_userSessionId;
 		m_userLoginName = userLoginName;
 		m_userFullName = userFullName;
 		m_userSessionId = userSessionId;
 		m_userDataLock.unlock();
+
+		// notify subscribers from within the main thread where their connections live
+		if( changed )
+		{
+			QMetaObject::invokeMethod( this, [this]() { publishUserInformation(); }, Qt::QueuedConnection );
+		}
+		else if( userLoginName.isEmpty() )
+		{
+			// nobody logged on yet - subscribers do not poll, so look again later
+			QMetaObject::invokeMethod( this, [this]() { retryUserInformationQuery(); }, Qt::QueuedConnection );
+		}
 	} );
 }
+
+
+
+void MonitoringMode::retryUserInformationQuery()
+{
+	removeClosedSubscribers();
+
+	if( m_subscribers.isEmpty() )
+	{
+		m_userInformationRetryTimer.stop();
+	}
+	else if( m_userInformationRetryTimer.isActive() == false )
+	{
+		m_userInformationRetryTimer.start();
+	}
+}
+
+
+
+void MonitoringMode::removeClosedSubscribers()
+{
+	m_subscribers.erase( std::remove_if( m_subscribers.begin(), m_subscribers.end(),
+										 []( const MessageContext& subscriber ) {
+											 return subscriber.ioDevice() == nullptr;
+										 } ), m_subscribers.end() );
+}
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <QTimer>
+
 #include "FeatureProviderInterface.h"
 
 class VEYON_CORE_EXPORT MonitoringMode : public QObject, FeatureProviderInterface, PluginInterface
@@ -35,7 +37,8 @@ public:
 	{
 		UserLoginName,
 		UserFullName,
-		UserSessionId
+		UserSessionId,
+		SequenceNumber
 	};
 	Q_ENUM(Argument)
 
@@ -82,6 +85,7 @@ public:
 	}
 
 	void queryLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces );
+	void subscribeLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces );
 
 	bool controlFeature( Feature::Uid featureUid, Operation operation, const QVariantMap& arguments,
 						const ComputerControlInterfaceList& computerControlInterfaces ) override
@@ -103,7 +107,19 @@ public:
 
 
 private:
+	enum Commands
+	{
+		QueryLoggedOnUserInfo = FeatureMessage::DefaultCommand,
+		SubscribeLoggedOnUserInfo
+	};
+
+	static constexpr int UserInformationRetryInterval = 5000;
+
 	void queryUserInformation();
+	void addUserInformation( FeatureMessage& message );
+	void publishUserInformation();
+	void retryUserInformationQuery();
+	void removeClosedSubscribers();
 
 	const Feature m_monitoringModeFeature;
 	const Feature m_queryLoggedOnUserInfoFeature;
@@ -114,4 +130,9 @@ private:
 	QString m_userFullName;
 	int m_userSessionId{0};
 
+	VeyonServerInterface* m_server{nullptr};
+	QList<MessageContext> m_subscribers{};
+	int m_sequenceNumber{0};
+	QTimer m_userInformationRetryTimer{this};
+
 };
@@ -31,7 +31,8 @@
 NetworkObjectDirectoryManager::NetworkObjectDirectoryManager( QObject* parent ) :
 	QObject( parent )
 {
-	for( auto pluginObject : qAsConst( VeyonCore::pluginManager().pluginObjects() ) )
+	const auto pluginObjects = VeyonCore::pluginManager().pluginObjects( NetworkObjectDirectoryPluginInterface_iid );
+	for( auto pluginObject : pluginObjects )
 	{
 		auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
 		auto directoryPluginInterface = qobject_cast<NetworkObjectDirectoryPluginInterface *>( pluginObject );
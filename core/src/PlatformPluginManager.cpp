@@ -30,7 +30,8 @@ PlatformPluginManager::PlatformPluginManager( PluginManager& pluginManager, QObj
 	QObject( parent ),
 	m_platformPlugin( nullptr )
 {
-	for( auto pluginObject : qAsConst( pluginManager.pluginObjects() ) )
+	const auto pluginObjects = pluginManager.pluginObjects( PlatformPluginInterface_iid );
+	for( auto pluginObject : pluginObjects )
 	{
 		auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
 		auto platformPluginInterface = qobject_cast<PlatformPluginInterface *>( pluginObject );
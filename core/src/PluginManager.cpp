@@ -22,13 +22,30 @@
  *
  */
 
+#include <algorithm>
+#include <array>
+
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QPluginLoader>
+#include <QSaveFile>
+#include <QStandardPaths>
 
+#include "AuthenticationPluginInterface.h"
+#include "CommandLinePluginInterface.h"
+#include "ConfigurationPagePluginInterface.h"
+#include "FeatureProviderInterface.h"
 #include "Logger.h"
+#include "NetworkObjectDirectoryPluginInterface.h"
+#include "PlatformPluginInterface.h"
 #include "PluginManager.h"
+#include "UserGroupsBackendInterface.h"
 #include "VeyonConfiguration.h"
+#include "VncServerPluginInterface.h"
 
 
 PluginManager::PluginManager( QObject* parent ) :
@@ -64,7 +81,23 @@ void PluginManager::loadPlatformPlugins()
 
 void PluginManager::loadPlugins()
 {
-	loadPlugins( QStringLiteral("*") + VeyonCore::sharedLibrarySuffix() );
+	const auto files = pluginFiles( QStringLiteral("*") + VeyonCore::sharedLibrarySuffix() );
+
+	// with an up-to-date manifest plugins are loaded on first use only
+	if( readManifest( files ) )
+	{
+		return;
+	}
+
+	QObjectList pluginObjects;
+	pluginObjects.reserve( files.size() );
+
+	for( const auto& fileInfo : files )
+	{
+		pluginObjects.append( loadPlugin( fileInfo.filePath() ) );
+	}
+
+	writeManifest( files, pluginObjects );
 }
 
 
@@ -73,6 +106,11 @@ void PluginManager::upgradePlugins()
 {
 	auto versions = VeyonCore::config().pluginVersions();
 
+	// plugins not loaded yet may still have to be upgraded or have their version recorded
+	loadPendingPlugins( [&versions]( const ManifestEntry& entry ) {
+		return versions.value( entry.uid.toString() ).toString() != entry.version;
+	} );
+
 	for( auto pluginInterface : qAsConst( m_pluginInterfaces ) )
 	{
 		const auto pluginUid = pluginInterface->uid().toString();
@@ -114,13 +152,22 @@ PluginUidList PluginManager::pluginUids() const
 {
 	PluginUidList pluginUidList;
 
-	pluginUidList.reserve( m_pluginInterfaces.size() );
+	pluginUidList.reserve( m_pluginInterfaces.size() + m_manifest.size() );
 
 	for( auto pluginInterface : qAsConst( m_pluginInterfaces ) )
 	{
 		pluginUidList += pluginInterface->uid();
 	}
 
+	// include plugins which have not been loaded yet
+	for( const auto& entry : m_manifest )
+	{
+		if( entry.loaded == false && entry.uid.isNull() == false && pluginUidList.contains( entry.uid ) == false )
+		{
+			pluginUidList += entry.uid;
+		}
+	}
+
 	std::sort( pluginUidList.begin(), pluginUidList.end() );
 
 	return pluginUidList;
@@ -138,11 +185,113 @@ QString PluginManager::pluginName( Plugin::Uid pluginUid ) const
 		}
 	}
 
+	for( const auto& entry : m_manifest )
+	{
+		if( entry.uid == pluginUid )
+		{
+			return entry.name;
+		}
+	}
+
 	return {};
 }
 
 
 
+QObjectList PluginManager::pluginObjects( const char* interfaceId )
+{
+	loadPendingPlugins( [interfaceId]( const ManifestEntry& entry ) {
+		return entry.interfaces.contains( QLatin1String( interfaceId ) );
+	} );
+
+	QObjectList objects;
+
+	for( auto pluginObject : qAsConst(m_pluginObjects) )
+	{
+		if( pluginObject->qt_metacast( interfaceId ) )
+		{
+			objects.append( pluginObject );
+		}
+	}
+
+	return objects;
+}
+
+
+
+QObjectList PluginManager::featurePluginObjects( Feature::Uid featureUid )
+{
+	const auto providers = [this, featureUid]() {
+		QObjectList objects;
+
+		for( auto pluginObject : qAsConst(m_pluginObjects) )
+		{
+			const auto featureProviderInterface = qobject_cast<FeatureProviderInterface *>( pluginObject );
+			if( featureProviderInterface == nullptr )
+			{
+				continue;
+			}
+
+			const auto& features = featureProviderInterface->featureList();
+			if( std::any_of( features.constBegin(), features.constEnd(),
+							 [featureUid]( const Feature& feature ) { return feature.uid() == featureUid; } ) )
+			{
+				objects.append( pluginObject );
+			}
+		}
+
+		return objects;
+	};
+
+	// builtin features or plugins loaded before
+	auto objects = providers();
+	if( objects.isEmpty() == false )
+	{
+		return objects;
+	}
+
+	const auto isInManifest = std::any_of( m_manifest.constBegin(), m_manifest.constEnd(),
+		[featureUid]( const ManifestEntry& entry ) { return entry.features.contains( featureUid ); } );
+
+	if( isInManifest )
+	{
+		loadPendingPlugins( [featureUid]( const ManifestEntry& entry ) {
+			return entry.features.contains( featureUid );
+		} );
+	}
+	else
+	{
+		// feature might be added dynamically so consider all feature plugins
+		loadPendingPlugins( []( const ManifestEntry& entry ) {
+			return entry.interfaces.contains( QLatin1String( FeatureProviderInterface_iid ) );
+		} );
+	}
+
+	return providers();
+}
+
+
+
+QObject* PluginManager::commandLinePluginObject( const QString& moduleName )
+{
+	loadPendingPlugins( [&moduleName]( const ManifestEntry& entry ) {
+		return entry.commandLineModule == moduleName;
+	} );
+
+	for( auto pluginObject : qAsConst(m_pluginObjects) )
+	{
+		const auto commandLinePluginInterface = qobject_cast<CommandLinePluginInterface *>( pluginObject );
+		if( commandLinePluginInterface && commandLinePluginInterface->commandLineModuleName() == moduleName )
+		{
+			return pluginObject;
+		}
+	}
+
+	return nullptr;
+}
+
+
+
 void PluginManager::initPluginSearchPath()
 {
 	QDir dir( QCoreApplication::applicationDirPath() );
@@ -162,36 +311,241 @@ void PluginManager::initPluginSearchPath()
 
 void PluginManager::loadPlugins( const QString& nameFilter )
 {
-	const auto plugins = QDir( QStringLiteral( "plugins:" ) ).entryInfoList( { nameFilter } );
-	for( const auto& fileInfo : plugins )
+	const auto files = pluginFiles( nameFilter );
+	for( const auto& fileInfo : files )
+	{
+		loadPlugin( fileInfo.filePath() );
+	}
+}
+
+
+
+QObject* PluginManager::loadPlugin( const QString& filePath )
+{
+	auto pluginLoader = new QPluginLoader( filePath, this );
+	auto pluginObject = pluginLoader->instance();
+	auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
+
+	if( pluginObject == nullptr || pluginInterface == nullptr )
+	{
+		delete pluginLoader;
+		return nullptr;
+	}
+
+	if( m_pluginInterfaces.contains( pluginInterface ) )
+	{
+		delete pluginLoader;
+		return pluginObject;
+	}
+
+	if( m_noDebugMessages == false )
+	{
+		vDebug() << "discovered plugin" << pluginInterface->name() << "at" << filePath;
+	}
+	m_pluginInterfaces += pluginInterface;	// clazy:exclude=reserve-candidates
+	m_pluginObjects += pluginObject;		// clazy:exclude=reserve-candidates
+	m_pluginLoaders += pluginLoader;		// clazy:exclude=reserve-candidates
+
+	return pluginObject;
+}
+
+
+
+void PluginManager::loadPendingPlugins( const ManifestFilter& filter )
+{
+	for( auto& entry : m_manifest )
+	{
+		if( entry.loaded == false && ( filter == nullptr || filter( entry ) ) )
+		{
+			entry.loaded = true;
+			loadPlugin( entry.filePath );
+		}
+	}
+}
+
+
+
+QFileInfoList PluginManager::pluginFiles( const QString& nameFilter )
+{
+	auto files = QDir( QStringLiteral( "plugins:" ) ).entryInfoList( { nameFilter }, QDir::Files, QDir::Name );
+
+	// skip simple shared libraries
+	files.erase( std::remove_if( files.begin(), files.end(), []( const QFileInfo& fileInfo ) {
+					 const auto fileName = fileInfo.fileName();
+					 return fileName.startsWith( QLatin1String("lib") ) &&
+							fileName.startsWith( QLatin1String("libveyon") ) == false;
+				 } ), files.end() );
+
+	return files;
+}
+
+
+
+QString PluginManager::manifestFilePath()
+{
+	const auto cacheLocation = QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation );
+	if( cacheLocation.isEmpty() )
+	{
+		return {};
+	}
+
+	return cacheLocation + QStringLiteral("/Veyon/plugins-%1.json").arg( VeyonCore::versionString() );
+}
+
+
+
+bool PluginManager::readManifest( const QFileInfoList& pluginFiles )
+{
+	QFile manifestFile( manifestFilePath() );
+	if( manifestFile.open( QFile::ReadOnly ) == false )
+	{
+		return false;
+	}
+
+	const auto plugins = QJsonDocument::fromJson( manifestFile.readAll() ).object().
+						 value( QStringLiteral("plugins") ).toArray();
+
+	// any added, removed or modified plugin file invalidates the whole manifest
+	if( plugins.size() != pluginFiles.size() )
+	{
+		return false;
+	}
+
+	QVector<ManifestEntry> manifest;
+	manifest.reserve( pluginFiles.size() );
+
+	for( int i = 0; i < pluginFiles.size(); ++i )
 	{
-		const auto fileName = fileInfo.fileName();
+		const auto& fileInfo = pluginFiles[i];
+		const auto plugin = plugins[i].toObject();
+
+		if( plugin.value( QStringLiteral("file") ).toString() != fileInfo.fileName() ||
+			plugin.value( QStringLiteral("size") ).toVariant().toLongLong() != fileInfo.size() ||
+			plugin.value( QStringLiteral("lastModified") ).toVariant().toLongLong() != fileInfo.lastModified().toMSecsSinceEpoch() )
+		{
+			return false;
+		}
 
-		// skip simple shared libraries
-		if( fileName.startsWith( QLatin1String("lib") ) &&
-			fileName.startsWith( QLatin1String("libveyon") ) == false )
+		ManifestEntry entry;
+		entry.filePath = fileInfo.filePath();
+		entry.uid = Plugin::Uid( plugin.value( QStringLiteral("uid") ).toString() );
+		entry.name = plugin.value( QStringLiteral("name") ).toString();
+		entry.version = plugin.value( QStringLiteral("version") ).toString();
+		entry.commandLineModule = plugin.value( QStringLiteral("commandLineModule") ).toString();
+		entry.commands = plugin.value( QStringLiteral("commands") ).toVariant().toStringList();
+		entry.interfaces = plugin.value( QStringLiteral("interfaces") ).toVariant().toStringList();
+
+		for( const auto& feature : plugin.value( QStringLiteral("features") ).toArray() )
 		{
-			continue;
+			entry.features.append( Feature::Uid( feature.toString() ) );
 		}
 
-		auto pluginLoader = new QPluginLoader( fileInfo.filePath(), this );
-		auto pluginObject = pluginLoader->instance();
-		auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
+		// plugins without a valid interface could not be loaded when generating the manifest
+		entry.loaded = entry.uid.isNull();
 
-		if( pluginObject && pluginInterface &&
-			m_pluginInterfaces.contains( pluginInterface ) == false )
+		for( auto pluginInterface : qAsConst(m_pluginInterfaces) )
 		{
-			if( m_noDebugMessages == false )
+			if( pluginInterface->uid() == entry.uid )
 			{
-				vDebug() << "discovered plugin" << pluginInterface->name() << "at" << fileInfo.filePath();
+				entry.loaded = true;
 			}
-			m_pluginInterfaces += pluginInterface;	// clazy:exclude=reserve-candidates
-			m_pluginObjects += pluginObject;		// clazy:exclude=reserve-candidates
-			m_pluginLoaders += pluginLoader;			// clazy:exclude=reserve-candidates
 		}
-		else
+
+		manifest.append( entry );
+	}
+
+	m_manifest = manifest;
+
+	if( m_noDebugMessages == false )
+	{
+		vDebug() << "deferring loading of" << m_manifest.size() << "plugins listed in" << manifestFile.fileName();
+	}
+
+	return true;
+}
+
+
+
+void PluginManager::writeManifest( const QFileInfoList& pluginFiles, const QObjectList& pluginObjects )
+{
+	static const std::array<const char *, 8> interfaceIds{ {
+		PlatformPluginInterface_iid,
+		FeatureProviderInterface_iid,
+		UserGroupsBackendInterface_iid,
+		ConfigurationPagePluginInterface_iid,
+		CommandLinePluginInterface_iid,
+		VncServerPluginInterface_iid,
+		AuthenticationPluginInterface_iid,
+		NetworkObjectDirectoryPluginInterface_iid,
+	} };
+
+	QJsonArray plugins;
+
+	for( int i = 0; i < pluginFiles.size(); ++i )
+	{
+		const auto& fileInfo = pluginFiles[i];
+
+		QJsonObject plugin{
+			{ QStringLiteral("file"), fileInfo.fileName() },
+			{ QStringLiteral("size"), fileInfo.size() },
+			{ QStringLiteral("lastModified"), fileInfo.lastModified().toMSecsSinceEpoch() }
+		};
+
+		const auto pluginObject = pluginObjects.value( i );
+		const auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
+
+		if( pluginInterface )
 		{
-			delete pluginLoader;
+			plugin[QStringLiteral("uid")] = pluginInterface->uid().toString();
+			plugin[QStringLiteral("name")] = pluginInterface->name();
+			plugin[QStringLiteral("version")] = pluginInterface->version().toString();
+
+			QStringList interfaces;
+			for( const auto interfaceId : interfaceIds )
+			{
+				if( pluginObject->qt_metacast( interfaceId ) )
+				{
+					interfaces.append( QLatin1String( interfaceId ) );
+				}
+			}
+			plugin[QStringLiteral("interfaces")] = QJsonArray::fromStringList( interfaces );
+
+			const auto featureProviderInterface = qobject_cast<FeatureProviderInterface *>( pluginObject );
+			if( featureProviderInterface )
+			{
+				QJsonArray features;
+				for( const auto& feature : featureProviderInterface->featureList() )
+				{
+					features.append( feature.uid().toString() );
+				}
+				plugin[QStringLiteral("features")] = features;
+			}
+
+			const auto commandLinePluginInterface = qobject_cast<CommandLinePluginInterface *>( pluginObject );
+			if( commandLinePluginInterface )
+			{
+				plugin[QStringLiteral("commandLineModule")] = commandLinePluginInterface->commandLineModuleName();
+				plugin[QStringLiteral("commands")] = QJsonArray::fromStringList( commandLinePluginInterface->commands() );
+			}
 		}
+
+		plugins.append( plugin );
+	}
+
+	const auto filePath = manifestFilePath();
+
+	if( filePath.isEmpty() || QDir().mkpath( QFileInfo( filePath ).absolutePath() ) == false )
+	{
+		return;
 	}
+
+	QSaveFile manifestFile( filePath );
+	if( manifestFile.open( QFile::WriteOnly ) == false )
+	{
+		vDebug() << "could not write plugin manifest" << manifestFile.fileName();
+		return;
+	}
+
+	manifestFile.write( QJsonDocument( QJsonObject{ { QStringLiteral("plugins"), plugins } } ).toJson( QJsonDocument::Compact ) );
+	manifestFile.commit();
 }
@@ -24,8 +24,10 @@
 
 #pragma once
 
+#include <QFileInfo>
 #include <QObject>
 
+#include "Feature.h"
 #include "Plugin.h"
 #include "PluginInterface.h"
 
@@ -42,16 +44,22 @@ public:
 	void loadPlugins();
 	void upgradePlugins();
 
-	const PluginInterfaceList& pluginInterfaces() const
+	const PluginInterfaceList& pluginInterfaces()
 	{
+		loadPendingPlugins();
 		return m_pluginInterfaces;
 	}
 
-	const QObjectList& pluginObjects() const
+	const QObjectList& pluginObjects()
 	{
+		loadPendingPlugins();
 		return m_pluginObjects;
 	}
 
+	QObjectList pluginObjects( const char* interfaceId );
+	QObjectList featurePluginObjects( Feature::Uid featureUid );
+	QObject* commandLinePluginObject( const QString& moduleName );
+
 	void registerExtraPluginInterface( QObject* pluginObject );
 
 	PluginUidList pluginUids() const;
@@ -59,7 +67,7 @@ public:
 	template<class InterfaceType, class FilterArgType = InterfaceType>
 	InterfaceType* find( const std::function<bool (const FilterArgType *)>& filter = []() { return true; } )
 	{
-		for( auto object : qAsConst(m_pluginObjects) )
+		for( auto object : qAsConst(pluginObjects()) )
 		{
 			auto pluginInterface = qobject_cast<InterfaceType *>( object );
 			if( pluginInterface && filter( qobject_cast<FilterArgType *>( object ) ) )
@@ -74,12 +82,36 @@ public:
 	QString pluginName( Plugin::Uid pluginUid ) const;
 
 private:
+	// everything needed to decide which plugin to load without loading it
+	struct ManifestEntry
+	{
+		QString filePath;
+		Plugin::Uid uid;
+		QString name;
+		QString version;
+		QStringList interfaces;
+		FeatureUidList features;
+		QString commandLineModule;
+		QStringList commands;
+		bool loaded{false};
+	};
+
+	using ManifestFilter = std::function<bool(const ManifestEntry &)>;
+
 	void initPluginSearchPath();
 	void loadPlugins( const QString& nameFilter );
+	QObject* loadPlugin( const QString& filePath );
+	void loadPendingPlugins( const ManifestFilter& filter = {} );
+
+	static QFileInfoList pluginFiles( const QString& nameFilter );
+	static QString manifestFilePath();
+	bool readManifest( const QFileInfoList& pluginFiles );
+	void writeManifest( const QFileInfoList& pluginFiles, const QObjectList& pluginObjects );
 
 	PluginInterfaceList m_pluginInterfaces{};
 	QObjectList m_pluginObjects{};
 	QList<QPluginLoader *> m_pluginLoaders{};
+	QVector<ManifestEntry> m_manifest{};
 	bool m_noDebugMessages{false};
 
 };
@@ -32,7 +32,8 @@ UserGroupsBackendManager::UserGroupsBackendManager( QObject* parent ) :
 	m_defaultBackend( nullptr ),
 	m_accessControlBackend( nullptr )
 {
-	for( auto pluginObject : qAsConst( VeyonCore::pluginManager().pluginObjects() ) )
+	const auto pluginObjects = VeyonCore::pluginManager().pluginObjects( UserGroupsBackendInterface_iid );
+	for( auto pluginObject : pluginObjects )
 	{
 		auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
 		auto userGroupsBackendInterface = qobject_cast<UserGroupsBackendInterface *>( pluginObject );
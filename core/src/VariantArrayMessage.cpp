@@ -39,6 +39,18 @@ VariantArrayMessage::VariantArrayMessage( QIODevice* ioDevice ) :
 
 
 
+VariantArrayMessage::VariantArrayMessage( QIODevice* ioDevice, const QByteArray& data ) :
+	m_stream( &m_buffer ),
+	m_ioDevice( ioDevice )
+{
+	Q_ASSERT( m_ioDevice != nullptr );
+
+	m_buffer.setData( data );
+	m_buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
+}
+
+
+
 bool VariantArrayMessage::send()
 {
 	const auto messageSize = qToBigEndian<MessageSize>( static_cast<MessageSize>( m_buffer.size() ) );
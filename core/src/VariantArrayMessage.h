@@ -36,7 +36,12 @@ class VEYON_CORE_EXPORT VariantArrayMessage
 public:
 	using MessageSize = quint32;
 
+	enum {
+		MaxMessageSize = 1024*1024*32
+	};
+
 	explicit VariantArrayMessage( QIODevice* ioDevice );
+	VariantArrayMessage( QIODevice* ioDevice, const QByteArray& data );
 
 	bool send();
 
@@ -46,6 +51,11 @@ public:
 
 	QVariant read(); // Flawfinder: ignore
 
+	bool atEnd() const
+	{
+		return m_buffer.atEnd();
+	}
+
 	VariantArrayMessage& write( const QVariant& v );
 
 	QIODevice* ioDevice() const
@@ -53,11 +63,12 @@ public:
 		return m_ioDevice;
 	}
 
-private:
-	enum {
-		MaxMessageSize = 1024*1024*32
-	};
+	const QByteArray& data() const
+	{
+		return m_buffer.data();
+	}
 
+private:
 	QBuffer m_buffer{};
 	VariantStream m_stream;
 	QIODevice* m_ioDevice;
@@ -63,6 +63,7 @@
 	OP( VeyonConfiguration, VeyonCore::config(), bool, remoteConnectionNotificationsEnabled, setRemoteConnectionNotificationsEnabled, "RemoteConnectionNotifications", "Service", false, Configuration::Property::Flag::Standard )			\
 	OP( VeyonConfiguration, VeyonCore::config(), bool, multiSessionModeEnabled, setMultiSessionModeEnabled, "MultiSession", "Service", false, Configuration::Property::Flag::Standard )			\
 	OP( VeyonConfiguration, VeyonCore::config(), int, maximumSessionCount, setMaximumSessionCount, "MaximumSessionCount", "Service", 100, Configuration::Property::Flag::Standard ) \
+	OP( VeyonConfiguration, VeyonCore::config(), int, featureWorkerPoolSize, setFeatureWorkerPoolSize, "FeatureWorkerPoolSize", "Service", 0, Configuration::Property::Flag::Advanced ) \
 	OP( VeyonConfiguration, VeyonCore::config(), bool, autostartService, setServiceAutostart, "Autostart", "Service", true, Configuration::Property::Flag::Advanced )			\
 
 #define FOREACH_VEYON_NETWORK_OBJECT_DIRECTORY_CONFIG_PROPERTY(OP)				\
@@ -88,11 +89,15 @@
 #define FOREACH_VEYON_NETWORK_CONFIG_PROPERTY(OP) \
 	OP( VeyonConfiguration, VeyonCore::config(), int, veyonServerPort, setVeyonServerPort, "VeyonServerPort", "Network", 11100, Configuration::Property::Flag::Advanced )			\
 	OP( VeyonConfiguration, VeyonCore::config(), int, vncServerPort, setVncServerPort, "VncServerPort", "Network", 11200, Configuration::Property::Flag::Advanced )			\
-	OP( VeyonConfiguration, VeyonCore::config(), int, featureWorkerManagerPort, setFeatureWorkerManagerPort, "FeatureWorkerManagerPort", "Network", 11300, Configuration::Property::Flag::Advanced )			\
 	OP( VeyonConfiguration, VeyonCore::config(), int, demoServerPort, setDemoServerPort, "DemoServerPort", "Network", 11400, Configuration::Property::Flag::Advanced )			\
 	OP( VeyonConfiguration, VeyonCore::config(), bool, isFirewallExceptionEnabled, setFirewallExceptionEnabled, "FirewallExceptionEnabled", "Network", true, Configuration::Property::Flag::Advanced )	\
 	OP( VeyonConfiguration, VeyonCore::config(), bool, localConnectOnly, setLocalConnectOnly, "LocalConnectOnly", "Network", false, Configuration::Property::Flag::Advanced )					\
 
+#define FOREACH_VEYON_BANDWIDTH_CONFIG_PROPERTY(OP) \
+	OP( VeyonConfiguration, VeyonCore::config(), int, bandwidthLimit, setBandwidthLimit, "BandwidthLimit", "Network", 0, Configuration::Property::Flag::Advanced )			\
+	OP( VeyonConfiguration, VeyonCore::config(), int, interactiveBandwidthReserve, setInteractiveBandwidthReserve, "InteractiveBandwidthReserve", "Network", 50, Configuration::Property::Flag::Advanced )			\
+	OP( VeyonConfiguration, VeyonCore::config(), int, featureMessagesBandwidthReserve, setFeatureMessagesBandwidthReserve, "FeatureMessagesBandwidthReserve", "Network", 20, Configuration::Property::Flag::Advanced )			\
+
 #define FOREACH_VEYON_DIRECTORIES_CONFIG_PROPERTY(OP) \
 	OP( VeyonConfiguration, VeyonCore::config(), QString, userConfigurationDirectory, setUserConfigurationDirectory, "UserConfiguration", "Directories", QDir::toNativeSeparators( QStringLiteral( "%APPDATA%/Config" ) ), Configuration::Property::Flag::Standard )	\
 	OP( VeyonConfiguration, VeyonCore::config(), QString, screenshotDirectory, setScreenshotDirectory, "Screenshots", "Directories", QDir::toNativeSeparators( QStringLiteral( "%APPDATA%/Screenshots" ) ), Configuration::Property::Flag::Standard )	\
@@ -155,6 +160,7 @@
 	FOREACH_VEYON_FEATURES_CONFIG_PROPERTY(OP)\
 	FOREACH_VEYON_VNC_SERVER_CONFIG_PROPERTY(OP)		\
 	FOREACH_VEYON_NETWORK_CONFIG_PROPERTY(OP)			\
+	FOREACH_VEYON_BANDWIDTH_CONFIG_PROPERTY(OP)			\
 	FOREACH_VEYON_DIRECTORIES_CONFIG_PROPERTY(OP)	\
 	FOREACH_VEYON_MASTER_CONFIG_PROPERTY(OP)	\
 	FOREACH_VEYON_AUTHENTICATION_CONFIG_PROPERTY(OP)	\
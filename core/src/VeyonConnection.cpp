@@ -93,13 +93,26 @@ void VeyonConnection::sendFeatureMessage( const FeatureMessage& featureMessage,
 
 
 
+void VeyonConnection::sendFeatureMessage( const EncodedFeatureMessagePointer& featureMessage, bool wake )
+{
+	if( m_vncConnection.isNull() )
+	{
+		vCritical() << "cannot enqueue event as VNC connection is invalid";
+		return;
+	}
+
+	m_vncConnection->enqueueEvent( new VncFeatureMessageEvent( featureMessage ), wake );
+}
+
+
+
 bool VeyonConnection::handleServerMessage( rfbClient* client, uint8_t msg )
 {
 	if( msg == FeatureMessage::RfbMessageType )
 	{
 		SocketDevice socketDev( VncConnection::libvncClientDispatcher, client );
 		FeatureMessage featureMessage;
-		if( featureMessage.receive( &socketDev ) == false )
+		if( featureMessage.receive( &socketDev, m_featureMessageCodec ) == false )
 		{
 			vDebug() << "could not receive feature message";
 
@@ -199,11 +212,16 @@ int8_t VeyonConnection::handleSecTypeVeyon( rfbClient* client, uint32_t authSche
 
 	// send username which is used when displaying an access confirm dialog
 	authReplyMessage.write( VeyonCore::platform().userFunctions().currentUser() );
+
+	// announce latest supported feature message codec (ignored by older servers)
+	authReplyMessage.write( static_cast<int>( FeatureMessage::LatestCodec ) );
 	authReplyMessage.send();
 
 	VariantArrayMessage authAckMessage( &socketDevice );
 	authAckMessage.receive();
 
+	connection->m_featureMessageCodec = FeatureMessage::negotiateCodec( authAckMessage.atEnd() ? QVariant() : authAckMessage.read() );
+
 	return plugins[chosenAuthPlugin]->authenticate( &socketDevice );
 }
 
@@ -26,11 +26,10 @@
 
 #include <QPointer>
 
+#include "EncodedFeatureMessage.h"
 #include "VncConnection.h"
 
 
-class FeatureMessage;
-
 class VEYON_CORE_EXPORT VeyonConnection : public QObject
 {
 	Q_OBJECT
@@ -63,7 +62,13 @@ public:
 		return m_userHomeDir;
 	}
 
+	FeatureMessage::Codec featureMessageCodec() const
+	{
+		return m_featureMessageCodec;
+	}
+
 	void sendFeatureMessage( const FeatureMessage& featureMessage, bool wake );
+	void sendFeatureMessage( const EncodedFeatureMessagePointer& featureMessage, bool wake );
 
 	bool handleServerMessage( rfbClient* client, uint8_t msg );
 
@@ -86,4 +91,7 @@ private:
 	QString m_user;
 	QString m_userHomeDir;
 
+	// negotiated during authentication and only accessed from within the connection's thread
+	FeatureMessage::Codec m_featureMessageCodec{FeatureMessage::Codec::DataStream};
+
 } ;
@@ -33,12 +33,14 @@
 #include <QProcessEnvironment>
 #include <QSysInfo>
 
+#include "AccessControlCache.h"
 #include "AuthenticationCredentials.h"
 #include "AuthenticationManager.h"
 #include "BuiltinFeatures.h"
 #include "ComputerControlInterface.h"
 #include "Filesystem.h"
 #include "HostAddress.h"
+#include "HostAddressResolver.h"
 #include "Logger.h"
 #include "NetworkObjectDirectoryManager.h"
 #include "PlatformPluginManager.h"
@@ -58,6 +60,7 @@ VeyonCore* VeyonCore::s_instance = nullptr;
 VeyonCore::VeyonCore( QCoreApplication* application, Component component, const QString& appComponentName ) :
 	QObject( application ),
 	m_filesystem( new Filesystem ),
+	m_hostAddressResolver( new HostAddressResolver ),
 	m_config( nullptr ),
 	m_logger( nullptr ),
 	m_authenticationCredentials( nullptr ),
@@ -69,6 +72,7 @@ VeyonCore::VeyonCore( QCoreApplication* application, Component component, const
 	m_builtinFeatures( nullptr ),
 	m_userGroupsBackendManager( nullptr ),
 	m_networkObjectDirectoryManager( nullptr ),
+	m_accessControlCache( nullptr ),
 	m_component( component ),
 	m_applicationName( QStringLiteral( "Veyon" ) ),
 	m_debugging( false )
@@ -135,6 +139,9 @@ VeyonCore::~VeyonCore()
 	delete m_filesystem;
 	m_filesystem = nullptr;
 
+	delete m_hostAddressResolver;
+	m_hostAddressResolver = nullptr;
+
 	delete m_cryptoCore;
 	m_cryptoCore = nullptr;
 
@@ -627,6 +634,7 @@ void VeyonCore::initManagers()
 	m_authenticationManager = new AuthenticationManager( this );
 	m_userGroupsBackendManager = new UserGroupsBackendManager( this );
 	m_networkObjectDirectoryManager = new NetworkObjectDirectoryManager( this );
+	m_accessControlCache = new AccessControlCache( this );
 }
 
 
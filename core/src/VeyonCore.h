@@ -45,11 +45,13 @@
 class QCoreApplication;
 class QWidget;
 
+class AccessControlCache;
 class AuthenticationCredentials;
 class AuthenticationManager;
 class BuiltinFeatures;
 class CryptoCore;
 class Filesystem;
+class HostAddressResolver;
 class Logger;
 class NetworkObjectDirectoryManager;
 class PlatformPluginInterface;
@@ -163,6 +165,16 @@ public:
 		return *( instance()->m_filesystem );
 	}
 
+	static HostAddressResolver& hostAddressResolver()
+	{
+		return *( instance()->m_hostAddressResolver );
+	}
+
+	static AccessControlCache& accessControlCache()
+	{
+		return *( instance()->m_accessControlCache );
+	}
+
 	static void setupApplicationParameters();
 
 	static int sessionId()
@@ -200,6 +212,7 @@ private:
 	static VeyonCore* s_instance;
 
 	Filesystem* m_filesystem;
+	HostAddressResolver* m_hostAddressResolver;
 	VeyonConfiguration* m_config;
 	Logger* m_logger;
 	AuthenticationCredentials* m_authenticationCredentials;
@@ -212,6 +225,7 @@ private:
 	BuiltinFeatures* m_builtinFeatures;
 	UserGroupsBackendManager* m_userGroupsBackendManager;
 	NetworkObjectDirectoryManager* m_networkObjectDirectoryManager;
+	AccessControlCache* m_accessControlCache;
 
 	Component m_component;
 	QString m_applicationName;
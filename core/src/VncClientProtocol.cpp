@@ -156,16 +156,18 @@ bool VncClientProtocol::setEncodings( const QVector<uint32_t>& encodings )
 
 
 
-void VncClientProtocol::requestFramebufferUpdate( bool incremental )
+void VncClientProtocol::requestFramebufferUpdate( bool incremental, const QRect& rect )
 {
+	const auto updateRect = rect.isEmpty() ? QRect( 0, 0, m_framebufferWidth, m_framebufferHeight ) : rect;
+
 	rfbFramebufferUpdateRequestMsg updateRequest;
 
 	updateRequest.type = rfbFramebufferUpdateRequest;
 	updateRequest.incremental = incremental ? 1 : 0;
-	updateRequest.x = 0;
-	updateRequest.y = 0;
-	updateRequest.w = qFromBigEndian<uint16_t>( m_framebufferWidth );
-	updateRequest.h = qFromBigEndian<uint16_t>( m_framebufferHeight );
+	updateRequest.x = qFromBigEndian<uint16_t>( static_cast<uint16_t>( updateRect.x() ) );
+	updateRequest.y = qFromBigEndian<uint16_t>( static_cast<uint16_t>( updateRect.y() ) );
+	updateRequest.w = qFromBigEndian<uint16_t>( static_cast<uint16_t>( updateRect.width() ) );
+	updateRequest.h = qFromBigEndian<uint16_t>( static_cast<uint16_t>( updateRect.height() ) );
 
 	if( m_socket->write( reinterpret_cast<const char *>( &updateRequest ), sz_rfbFramebufferUpdateRequestMsg ) != sz_rfbFramebufferUpdateRequestMsg )
 	{
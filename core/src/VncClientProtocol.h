@@ -78,7 +78,8 @@ public:
 	bool setPixelFormat( rfbPixelFormat pixelFormat );
 	bool setEncodings( const QVector<uint32_t>& encodings );
 
-	void requestFramebufferUpdate( bool incremental );
+	// requests the whole framebuffer if no rect is given
+	void requestFramebufferUpdate( bool incremental, const QRect& rect = {} );
 
 	bool receiveMessage();
 
@@ -23,11 +23,19 @@
  */
 
 #include "SocketDevice.h"
+#include "VeyonConnection.h"
 #include "VncConnection.h"
 #include "VncFeatureMessageEvent.h"
 
 
 VncFeatureMessageEvent::VncFeatureMessageEvent( const FeatureMessage& featureMessage ) :
+	m_featureMessage( new EncodedFeatureMessage( featureMessage ) )
+{
+}
+
+
+
+VncFeatureMessageEvent::VncFeatureMessageEvent( const EncodedFeatureMessagePointer& featureMessage ) :
 	m_featureMessage( featureMessage )
 {
 }
@@ -36,13 +44,17 @@ VncFeatureMessageEvent::VncFeatureMessageEvent( const FeatureMessage& featureMes
 
 void VncFeatureMessageEvent::fire( rfbClient* client )
 {
-	vDebug() << "sending message" << m_featureMessage.featureUid()
-			 << "command" << m_featureMessage.command()
-			 << "arguments" << m_featureMessage.arguments();
+	const auto& featureMessage = m_featureMessage->message();
+
+	vDebug() << "sending message" << featureMessage.featureUid()
+			 << "command" << featureMessage.command()
+			 << "arguments" << featureMessage.arguments();
+
+	const auto connection = static_cast<VeyonConnection *>( VncConnection::clientData( client, VeyonConnection::VeyonConnectionTag ) );
+	const auto data = m_featureMessage->data( connection ? connection->featureMessageCodec() : FeatureMessage::Codec::DataStream );
 
 	SocketDevice socketDevice( VncConnection::libvncClientDispatcher, client );
 	const char messageType = FeatureMessage::RfbMessageType;
 	socketDevice.write( &messageType, sizeof(messageType) );
-
-	m_featureMessage.send( &socketDevice );
+	socketDevice.write( data.constData(), data.size() );
 }
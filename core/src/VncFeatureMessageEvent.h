@@ -24,7 +24,7 @@
 
 #pragma once
 
-#include "FeatureMessage.h"
+#include "EncodedFeatureMessage.h"
 #include "VncEvents.h"
 
 // clazy:excludeall=copyable-polymorphic
@@ -33,10 +33,11 @@ class VncFeatureMessageEvent : public VncEvent
 {
 public:
 	explicit VncFeatureMessageEvent( const FeatureMessage& featureMessage );
+	explicit VncFeatureMessageEvent( const EncodedFeatureMessagePointer& featureMessage );
 
 	void fire( rfbClient* client ) override;
 
 private:
-	FeatureMessage m_featureMessage;
+	EncodedFeatureMessagePointer m_featureMessage;
 
 } ;
@@ -24,9 +24,8 @@
 
 #pragma once
 
-#include <QElapsedTimer>
-
 #include "CryptoCore.h"
+#include "FeatureMessage.h"
 #include "VncServerProtocol.h"
 
 class VEYON_CORE_EXPORT VncServerClient : public QObject
@@ -36,6 +35,7 @@ public:
 	enum class AuthState {
 		Init,
 		Stage1,
+		Pending,
 		Successful,
 		Failed,
 	} ;
@@ -69,7 +69,11 @@ public:
 
 	void setProtocolState( VncServerProtocol::State protocolState )
 	{
-		m_protocolState = protocolState;
+		if( protocolState != m_protocolState )
+		{
+			m_protocolState = protocolState;
+			Q_EMIT stateChanged();
+		}
 	}
 
 	AuthState authState() const
@@ -79,7 +83,11 @@ public:
 
 	void setAuthState( AuthState authState )
 	{
-		m_authState = authState;
+		if( authState != m_authState )
+		{
+			m_authState = authState;
+			Q_EMIT stateChanged();
+		}
 	}
 
 	Plugin::Uid authMethodUid() const
@@ -99,12 +107,11 @@ public:
 
 	void setAccessControlState( AccessControlState accessControlState )
 	{
-		m_accessControlState = accessControlState;
-	}
-
-	QElapsedTimer& accessControlTimer()
-	{
-		return m_accessControlTimer;
+		if( accessControlState != m_accessControlState )
+		{
+			m_accessControlState = accessControlState;
+			Q_EMIT stateChanged();
+		}
 	}
 
 	const QString& username() const
@@ -137,6 +144,16 @@ public:
 		m_challenge = challenge;
 	}
 
+	FeatureMessage::Codec featureMessageCodec() const
+	{
+		return m_featureMessageCodec;
+	}
+
+	void setFeatureMessageCodec( FeatureMessage::Codec codec )
+	{
+		m_featureMessageCodec = codec;
+	}
+
 	const CryptoCore::PrivateKey& privateKey() const
 	{
 		return m_privateKey;
@@ -155,17 +172,18 @@ public Q_SLOTS:
 
 Q_SIGNALS:
 	void accessControlFinished( VncServerClient* );
+	void stateChanged();
 
 private:
 	VncServerProtocol::State m_protocolState;
 	AuthState m_authState;
 	Plugin::Uid m_authMethodUid;
 	AccessControlState m_accessControlState;
-	QElapsedTimer m_accessControlTimer;
 	QString m_username;
 	QString m_hostAddress;
 	QByteArray m_challenge;
 	CryptoCore::PrivateKey m_privateKey;
+	FeatureMessage::Codec m_featureMessageCodec{FeatureMessage::Codec::DataStream};
 
 } ;
 
@@ -218,10 +218,13 @@ bool VncServerProtocol::receiveAuthenticationMethodResponse()
 		m_client->setAuthMethodUid( chosenAuthMethodUid );
 		m_client->setUsername( username );
 
+		// clients supporting multiple feature message codecs append the latest one they support
+		m_client->setFeatureMessageCodec( FeatureMessage::negotiateCodec( message.atEnd() ? QVariant() : message.read() ) );
+
 		setState( State::Authenticating );
 
-		// send auth ack message
-		VariantArrayMessage( m_socket ).send();
+		// send auth ack message including the codec to use
+		VariantArrayMessage( m_socket ).write( static_cast<int>( m_client->featureMessageCodec() ) ).send();
 
 		// init authentication
 		VariantArrayMessage dummyMessage( m_socket );
@@ -235,6 +238,19 @@ bool VncServerProtocol::receiveAuthenticationMethodResponse()
 
 bool VncServerProtocol::receiveAuthenticationMessage()
 {
+	switch( m_client->authState() )
+	{
+	case VncServerClient::AuthState::Pending:
+		// wait for current authentication stage to complete
+		return false;
+	case VncServerClient::AuthState::Successful:
+	case VncServerClient::AuthState::Failed:
+		// authentication stage completed asynchronously
+		return finishAuthentication();
+	default:
+		break;
+	}
+
 	VariantArrayMessage message( m_socket );
 
 	if( message.isReadyForReceive() && message.receive() )
@@ -251,6 +267,13 @@ bool VncServerProtocol::processAuthentication( VariantArrayMessage& message )
 {
 	processAuthenticationMessage( message );
 
+	return finishAuthentication();
+}
+
+
+
+bool VncServerProtocol::finishAuthentication()
+{
 	switch( m_client->authState() )
 	{
 	case VncServerClient::AuthState::Successful:
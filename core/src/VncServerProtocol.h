@@ -67,6 +67,11 @@ public:
 		m_serverInitMessage = serverInitMessage;
 	}
 
+	VncServerClient* client()
+	{
+		return m_client;
+	}
+
 protected:
 	virtual AuthMethodUids supportedAuthMethodUids() const = 0;
 	virtual void processAuthenticationMessage( VariantArrayMessage& message ) = 0;
@@ -77,11 +82,6 @@ protected:
 		return m_socket;
 	}
 
-	VncServerClient* client()
-	{
-		return m_client;
-	}
-
 private:
 	void setState( State state );
 
@@ -93,6 +93,7 @@ private:
 	bool receiveAuthenticationMessage();
 
 	bool processAuthentication( VariantArrayMessage& message );
+	bool finishAuthentication();
 	bool processAccessControl();
 
 	bool processFramebufferInit();
@@ -1,6 +1,7 @@
 import QtQuick 2.0
 import QtQuick.Controls 2.0
 import QtQuick.Layouts 1.0
+import Veyon.Master 5.0
 
 Rectangle {
 	id: item
@@ -9,6 +10,8 @@ Rectangle {
 
 	property var textColor
 	property var view
+	property var screenAtlas
+	property size screenSize
 	property bool isComputerItem: true
 	property bool selected: false
 	property var objectUid: uid
@@ -33,8 +36,11 @@ Rectangle {
 		//clip: true
 		id: computerItemLayout
 		spacing: 0
-		Image {
-			source: imageId;
+		ComputerScreen {
+			atlas: item.screenAtlas
+			uid: item.objectUid
+			Layout.preferredWidth: item.screenSize.width
+			Layout.preferredHeight: item.screenSize.height
 			Layout.alignment: Qt.AlignCenter
 			Layout.margins: 5
 			MouseArea {
@@ -63,6 +63,8 @@ Page {
 			delegate: ComputerDelegate {
 				view: computerMonitoringView
 				textColor: computerMonitoring.textColor
+				screenAtlas: computerMonitoring.screenAtlas
+				screenSize: computerMonitoring.iconSize
 			}
 
 			Label {
@@ -23,6 +23,7 @@
  */
 
 #include <QPainter>
+#include <QSet>
 
 #include "ComputerControlListModel.h"
 #include "ComputerManager.h"
@@ -53,6 +54,10 @@ ComputerControlListModel::ComputerControlListModel( VeyonMaster* masterCore, QOb
 	connect( &m_master->computerManager(), &ComputerManager::computerSelectionChanged,
 			 this, &ComputerControlListModel::update );
 
+	m_pendingChangesTimer.setSingleShot( true );
+	m_pendingChangesTimer.setInterval( ChangeNotificationInterval );
+	connect( &m_pendingChangesTimer, &QTimer::timeout, this, &ComputerControlListModel::notifyPendingChanges );
+
 	updateComputerScreenSize();
 
 	reload();
@@ -201,9 +206,9 @@ void ComputerControlListModel::updateComputerScreenSize()
 	{
 		m_computerScreenSize = newSize;
 
-		for( int i = 0; i < rowCount(); ++i )
+		if( rowCount() > 0 )
 		{
-			updateScreen( index( i ) );
+			Q_EMIT dataChanged( index( 0 ), index( rowCount() - 1 ), changedRoles( ScreenChanged ) );
 		}
 
 		Q_EMIT computerScreenSizeChanged();
@@ -227,6 +232,14 @@ ComputerControlInterface::Pointer ComputerControlListModel::computerControlInter
 
 ComputerControlInterface::Pointer ComputerControlListModel::computerControlInterface( NetworkObject::Uid uid ) const
 {
+	const auto row = m_uidRows.value( uid, -1 );
+	if( row >= 0 && row < m_computerControlInterfaces.count() &&
+		m_computerControlInterfaces[row]->computer().networkObjectUid() == uid )
+	{
+		return m_computerControlInterfaces[row];
+	}
+
+	// rows are being inserted or removed right now
 	for( auto& controlInterface : m_computerControlInterfaces )
 	{
 		if( controlInterface->computer().networkObjectUid() == uid )
@@ -247,6 +260,7 @@ void ComputerControlListModel::reload()
 
 	m_computerControlInterfaces.clear();
 	m_computerControlInterfaces.reserve( computerList.size() );
+	m_pendingChanges.clear();
 
 	int row = 0;
 
@@ -258,6 +272,8 @@ void ComputerControlListModel::reload()
 		++row;
 	}
 
+	updateRowIndexes();
+
 	endResetModel();
 }
 
@@ -267,71 +283,224 @@ void ComputerControlListModel::update()
 {
 	const auto newComputerList = m_master->computerManager().selectedComputers( QModelIndex() );
 
-	int row = 0;
+	QSet<NetworkObject::Uid> newComputerUids;
+	newComputerUids.reserve( newComputerList.size() );
+	for( const auto& computer : newComputerList )
+	{
+		newComputerUids.insert( computer.networkObjectUid() );
+	}
 
-	for( auto it = m_computerControlInterfaces.begin(); it != m_computerControlInterfaces.end(); ) // clazy:exclude=detaching-member
+	const auto isDeselected = [&]( int row ) {
+		return newComputerUids.contains( m_computerControlInterfaces.at( row )->computer().networkObjectUid() ) == false;
+	};
+
+	// remove deselected computers in ranges, starting at the end so that preceding rows stay valid
+	for( int lastRow = m_computerControlInterfaces.count() - 1; lastRow >= 0; )
 	{
-		if( newComputerList.contains( (*it)->computer() ) == false )
+		if( isDeselected( lastRow ) == false )
 		{
-			stopComputerControlInterface( *it );
+			--lastRow;
+			continue;
+		}
 
-			beginRemoveRows( QModelIndex(), row, row );
-			it = m_computerControlInterfaces.erase( it );
-			endRemoveRows();
+		auto firstRow = lastRow;
+		while( firstRow > 0 && isDeselected( firstRow - 1 ) )
+		{
+			--firstRow;
 		}
-		else
+
+		for( int row = firstRow; row <= lastRow; ++row )
 		{
-			++it;
-			++row;
+			stopComputerControlInterface( m_computerControlInterfaces.at( row ) );
 		}
+
+		beginRemoveRows( QModelIndex(), firstRow, lastRow );
+		m_computerControlInterfaces.erase( m_computerControlInterfaces.begin() + firstRow, // clazy:exclude=detaching-member
+										   m_computerControlInterfaces.begin() + lastRow + 1 );
+		endRemoveRows();
+
+		lastRow = firstRow - 1;
 	}
 
-	row = 0;
+	// merge the new selection into the remaining computers, inserting newly selected computers
+	// and moving reordered ones in ranges so that existing connections are kept
+	int row = 0;
 
-	for( const auto& computer : newComputerList )
+	for( int i = 0; i < newComputerList.count(); )
 	{
-		if( row < m_computerControlInterfaces.count() && m_computerControlInterfaces[row]->computer() != computer )
+		if( row < m_computerControlInterfaces.count() && m_computerControlInterfaces.at( row )->computer() == newComputerList[i] )
 		{
-			beginInsertRows( QModelIndex(), row, row );
-			const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
-			m_computerControlInterfaces.insert( row, controlInterface );
-			startComputerControlInterface( controlInterface.data() );
-			endInsertRows();
+			++row;
+			++i;
+			continue;
 		}
-		else if( row >= m_computerControlInterfaces.count() )
+
+		int count = 0;
+		while( i + count < newComputerList.count() &&
+			   m_uidRows.contains( newComputerList[i + count].networkObjectUid() ) == false )
 		{
-			beginInsertRows( QModelIndex(), row, row );
-			const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
-			m_computerControlInterfaces.append( controlInterface );
+			++count;
+		}
+
+		if( count == 0 )
+		{
+			// order of computers changed - the computer is already part of the model but further below
+			const auto sourceRow = findComputerRow( newComputerList[i], row + 1 );
+			if( sourceRow < 0 )
+			{
+				vCritical() << "computer" << newComputerList[i].name() << "not found";
+				++i;
+				continue;
+			}
+
+			while( i + count < newComputerList.count() &&
+				   sourceRow + count < m_computerControlInterfaces.count() &&
+				   m_computerControlInterfaces.at( sourceRow + count )->computer() == newComputerList[i + count] )
+			{
+				++count;
+			}
+
+			beginMoveRows( QModelIndex(), sourceRow, sourceRow + count - 1, QModelIndex(), row );
+			for( int j = 0; j < count; ++j )
+			{
+				m_computerControlInterfaces.move( sourceRow + j, row + j );
+			}
+			endMoveRows();
+
+			row += count;
+			i += count;
+			continue;
+		}
+
+		beginInsertRows( QModelIndex(), row, row + count - 1 );
+		for( int j = 0; j < count; ++j )
+		{
+			const auto controlInterface = ComputerControlInterface::Pointer::create( newComputerList[i + j] );
+			m_computerControlInterfaces.insert( row + j, controlInterface );
 			startComputerControlInterface( controlInterface.data() );
-			endInsertRows();
 		}
+		endInsertRows();
 
-		++row;
+		row += count;
+		i += count;
 	}
 
+	updateRowIndexes();
+
 	updateComputerScreenSize();
 }
 
 
 
+int ComputerControlListModel::findComputerRow( const Computer& computer, int fromRow ) const
+{
+	for( int row = fromRow; row < m_computerControlInterfaces.count(); ++row )
+	{
+		if( m_computerControlInterfaces.at( row )->computer() == computer )
+		{
+			return row;
+		}
+	}
+
+	return -1;
+}
+
+
+
+void ComputerControlListModel::updateRowIndexes()
+{
+	m_interfaceRows.clear();
+	m_interfaceRows.reserve( m_computerControlInterfaces.size() );
+
+	m_uidRows.clear();
+	m_uidRows.reserve( m_computerControlInterfaces.size() );
+
+	for( int row = 0; row < m_computerControlInterfaces.size(); ++row )
+	{
+		const auto& controlInterface = m_computerControlInterfaces.at( row );
+		m_interfaceRows[controlInterface.data()] = row;
+		m_uidRows[controlInterface->computer().networkObjectUid()] = row;
+	}
+}
+
+
+
 QModelIndex ComputerControlListModel::interfaceIndex( ComputerControlInterface* controlInterface ) const
 {
+	const auto row = m_interfaceRows.value( controlInterface, -1 );
+	if( row >= 0 && row < m_computerControlInterfaces.size() &&
+		m_computerControlInterfaces[row].data() == controlInterface )
+	{
+		return ComputerListModel::index( row, 0 );
+	}
+
+	// rows are being inserted or removed right now
 	return ComputerListModel::index( m_computerControlInterfaces.indexOf( controlInterface->weakPointer() ), 0 );
 }
 
 
 
-void ComputerControlListModel::updateState( const QModelIndex& index )
+void ComputerControlListModel::addPendingChange( ComputerControlInterface* controlInterface, PendingChange change )
 {
-	Q_EMIT dataChanged( index, index, { Qt::DisplayRole, Qt::DecorationRole, Qt::ToolTipRole, ImageIdRole, ScreenRole } );
+	m_pendingChanges[controlInterface] |= change;
+
+	if( m_pendingChangesTimer.isActive() == false )
+	{
+		m_pendingChangesTimer.start();
+	}
 }
 
 
 
-void ComputerControlListModel::updateScreen( const QModelIndex& index )
+void ComputerControlListModel::notifyPendingChanges()
 {
-	Q_EMIT dataChanged( index, index, { Qt::DecorationRole, ImageIdRole, ScreenRole } );
+	QMap<int, int> changedRows;
+
+	for( auto it = m_pendingChanges.constBegin(), end = m_pendingChanges.constEnd(); it != end; ++it )
+	{
+		const auto row = m_interfaceRows.value( it.key(), -1 );
+		if( row >= 0 )
+		{
+			changedRows[row] |= it.value();
+		}
+	}
+
+	m_pendingChanges.clear();
+
+	// merge adjacent rows with the same changes into ranges
+	auto it = changedRows.constBegin();
+	while( it != changedRows.constEnd() )
+	{
+		const auto firstRow = it.key();
+		const auto changes = it.value();
+		auto lastRow = firstRow;
+
+		while( ++it != changedRows.constEnd() && it.key() == lastRow + 1 && it.value() == changes )
+		{
+			lastRow = it.key();
+		}
+
+		Q_EMIT dataChanged( index( firstRow ), index( lastRow ), changedRoles( changes ) );
+	}
+}
+
+
+
+QVector<int> ComputerControlListModel::changedRoles( int changes )
+{
+	QVector<int> roles;
+
+	if( changes & ( ScreenChanged | StateChanged ) )
+	{
+		roles.append( { Qt::DecorationRole, ImageIdRole, ScreenRole } );
+	}
+
+	if( changes & ( StateChanged | UserChanged ) )
+	{
+		roles.append( { Qt::DisplayRole, Qt::ToolTipRole } );
+	}
+
+	return roles;
 }
 
 
@@ -344,15 +513,11 @@ void ComputerControlListModel::updateActiveFeatures( const QModelIndex& index )
 
 
 
-void ComputerControlListModel::updateUser( const QModelIndex& index )
+void ComputerControlListModel::updateUser( ComputerControlInterface* controlInterface )
 {
-	Q_EMIT dataChanged( index, index, { Qt::DisplayRole, Qt::ToolTipRole } );
+	addPendingChange( controlInterface, UserChanged );
 
-	auto controlInterface = computerControlInterface( index );
-	if( controlInterface.isNull() == false )
-	{
-		m_master->computerManager().updateUser( controlInterface );
-	}
+	m_master->computerManager().updateUser( controlInterface->weakPointer() );
 }
 
 
@@ -370,22 +535,24 @@ void ComputerControlListModel::startComputerControlInterface( ComputerControlInt
 			 this, &ComputerControlListModel::updateComputerScreenSize );
 
 	connect( controlInterface, &ComputerControlInterface::scaledScreenUpdated,
-			 this, [=] () { updateScreen( interfaceIndex( controlInterface ) ); } );
+			 this, [=] () { addPendingChange( controlInterface, ScreenChanged ); } );
 
 	connect( controlInterface, &ComputerControlInterface::activeFeaturesChanged,
 			 this, [=] () { updateActiveFeatures( interfaceIndex( controlInterface ) ); } );
 
 	connect( controlInterface, &ComputerControlInterface::stateChanged,
-			 this, [=] () { updateState( interfaceIndex( controlInterface ) ); } );
+			 this, [=] () { addPendingChange( controlInterface, StateChanged ); } );
 
 	connect( controlInterface, &ComputerControlInterface::userChanged,
-			 this, [=]() { updateUser( interfaceIndex( controlInterface ) ); } );
+			 this, [=]() { updateUser( controlInterface ); } );
 }
 
 
 
 void ComputerControlListModel::stopComputerControlInterface( const ComputerControlInterface::Pointer& controlInterface )
 {
+	m_pendingChanges.remove( controlInterface.data() );
+
 	m_master->stopAllModeFeatures( { controlInterface } );
 
 	controlInterface->disconnect( &m_master->computerManager() );
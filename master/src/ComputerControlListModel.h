@@ -27,6 +27,7 @@
 #include <QAbstractListModel>
 #include <QQuickImageProvider>
 #include <QImage>
+#include <QTimer>
 
 #include "ComputerListModel.h"
 #include "ComputerControlInterface.h"
@@ -74,14 +75,28 @@ Q_SIGNALS:
 	void computerScreenSizeChanged();
 
 private:
+	// changes of computers which are collected and notified together once per frame
+	enum PendingChange
+	{
+		ScreenChanged = 0x01,
+		StateChanged = 0x02,
+		UserChanged = 0x04
+	};
+
+	static constexpr int ChangeNotificationInterval = 16;
+
 	void update();
 
+	int findComputerRow( const Computer& computer, int fromRow ) const;
+	void updateRowIndexes();
 	QModelIndex interfaceIndex( ComputerControlInterface* controlInterface ) const;
 
-	void updateState( const QModelIndex& index );
-	void updateScreen( const QModelIndex& index );
+	void addPendingChange( ComputerControlInterface* controlInterface, PendingChange change );
+	void notifyPendingChanges();
+	static QVector<int> changedRoles( int changes );
+
 	void updateActiveFeatures( const QModelIndex& index );
-	void updateUser( const QModelIndex& index );
+	void updateUser( ComputerControlInterface* controlInterface );
 
 	void startComputerControlInterface( ComputerControlInterface* controlInterface );
 	void stopComputerControlInterface( const ComputerControlInterface::Pointer& controlInterface );
@@ -107,5 +122,10 @@ private:
 	QSize m_computerScreenSize{};
 
 	ComputerControlInterfaceList m_computerControlInterfaces{};
+	QHash<ComputerControlInterface*, int> m_interfaceRows{};
+	QHash<NetworkObject::Uid, int> m_uidRows{};
+
+	QHash<ComputerControlInterface*, int> m_pendingChanges{};
+	QTimer m_pendingChangesTimer{};
 
 };
@@ -25,13 +25,15 @@
 #include "ComputerControlListModel.h"
 #include "ComputerMonitoringItem.h"
 #include "ComputerMonitoringModel.h"
+#include "ComputerScreenAtlas.h"
 #include "VeyonMaster.h"
 #include "FeatureManager.h"
 #include "VeyonConfiguration.h"
 
 
 ComputerMonitoringItem::ComputerMonitoringItem( QQuickItem* parent ) :
-	QQuickItem( parent )
+	QQuickItem( parent ),
+	m_screenAtlas( new ComputerScreenAtlas( dataModel(), this ) )
 {
 }
 
@@ -94,6 +96,13 @@ QObject* ComputerMonitoringItem::model() const
 
 
 
+QObject* ComputerMonitoringItem::screenAtlas() const
+{
+	return m_screenAtlas;
+}
+
+
+
 QColor ComputerMonitoringItem::backgroundColor() const
 {
 	return m_backgroundColor;
@@ -151,6 +160,7 @@ void ComputerMonitoringItem::setIconSize( const QSize& size )
 	if( size != m_iconSize )
 	{
 		m_iconSize = size;
+		m_screenAtlas->setTileSize( size );
 
 		Q_EMIT iconSizeChanged();
 	}
@@ -29,12 +29,14 @@
 
 #include <QQuickItem>
 
+class ComputerScreenAtlas;
 class FlexibleListView;
 
 class ComputerMonitoringItem : public QQuickItem, public ComputerMonitoringView
 {
 	Q_OBJECT
 	Q_PROPERTY(QObject* model READ model CONSTANT)
+	Q_PROPERTY(QObject* screenAtlas READ screenAtlas CONSTANT)
 	Q_PROPERTY(QColor backgroundColor READ backgroundColor NOTIFY backgroundColorChanged)
 	Q_PROPERTY(QColor textColor READ textColor NOTIFY textColorChanged)
 	Q_PROPERTY(QSize iconSize READ iconSize NOTIFY iconSizeChanged)
@@ -64,6 +66,7 @@ public:
 
 private:
 	QObject* model() const;
+	QObject* screenAtlas() const;
 	QColor backgroundColor() const;
 	QColor textColor() const;
 	const QSize& iconSize() const;
@@ -77,6 +80,8 @@ private:
 	QVariantList selectedObjects() const;
 	void setSelectedObjects( const QVariantList& objects );
 
+	ComputerScreenAtlas* m_screenAtlas;
+
 	QColor m_backgroundColor;
 	QColor m_textColor;
 	QSize m_iconSize;
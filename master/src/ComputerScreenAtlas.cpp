@@ -0,0 +1,473 @@
+/*
+ * ComputerScreenAtlas.cpp - implementation of ComputerScreenAtlas
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QAbstractItemModel>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QRunnable>
+#include <QSGRendererInterface>
+#include <QSGTexture>
+
+#include <cmath>
+
+#include "ComputerListModel.h"
+#include "ComputerScreenAtlas.h"
+
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+
+
+// OpenGL texture which allows updating parts of the atlas without re-uploading it completely
+class ComputerScreenAtlasTexture : public QSGTexture, protected QOpenGLFunctions
+{
+public:
+	explicit ComputerScreenAtlasTexture( const QImage& image ) :
+		m_size( image.size() )
+	{
+		initializeOpenGLFunctions();
+
+		glGenTextures( 1, &m_textureId );
+		glBindTexture( GL_TEXTURE_2D, m_textureId );
+		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, m_size.width(), m_size.height(), 0,
+					  GL_RGBA, GL_UNSIGNED_BYTE, image.constBits() );
+	}
+
+	~ComputerScreenAtlasTexture() override
+	{
+		glDeleteTextures( 1, &m_textureId );
+	}
+
+	int textureId() const override
+	{
+		return int(m_textureId);
+	}
+
+	QSize textureSize() const override
+	{
+		return m_size;
+	}
+
+	bool hasAlphaChannel() const override
+	{
+		return true;
+	}
+
+	bool hasMipmaps() const override
+	{
+		return false;
+	}
+
+	void bind() override
+	{
+		glBindTexture( GL_TEXTURE_2D, m_textureId );
+		updateBindOptions();
+	}
+
+	void upload( const QImage& image, const QVector<QRect>& rects )
+	{
+		const auto context = QOpenGLContext::currentContext();
+		const auto rowLengthSupported = context->isOpenGLES() == false || context->format().majorVersion() >= 3;
+
+		glBindTexture( GL_TEXTURE_2D, m_textureId );
+
+		if( rowLengthSupported )
+		{
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, image.width() );
+		}
+
+		for( const auto& rect : rects )
+		{
+			if( rowLengthSupported )
+			{
+				glTexSubImage2D( GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+								 GL_RGBA, GL_UNSIGNED_BYTE, image.constScanLine( rect.y() ) + rect.x() * 4 );
+			}
+			else
+			{
+				// OpenGL ES 2 can only upload complete rows of the image
+				glTexSubImage2D( GL_TEXTURE_2D, 0, 0, rect.y(), image.width(), rect.height(),
+								 GL_RGBA, GL_UNSIGNED_BYTE, image.constScanLine( rect.y() ) );
+			}
+		}
+
+		if( rowLengthSupported )
+		{
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+		}
+	}
+
+private:
+	QSize m_size;
+	GLuint m_textureId{0};
+
+};
+
+
+
+class ComputerScreenAtlasTextureReleaseJob : public QRunnable
+{
+public:
+	explicit ComputerScreenAtlasTextureReleaseJob( QSGTexture* texture ) :
+		m_texture( texture )
+	{
+	}
+
+	void run() override
+	{
+		delete m_texture;
+	}
+
+private:
+	QSGTexture* m_texture;
+
+};
+
+
+
+ComputerScreenAtlas::ComputerScreenAtlas( QAbstractItemModel* model, QObject* parent ) :
+	QObject( parent ),
+	m_model( model )
+{
+	connect( m_model, &QAbstractItemModel::rowsInserted, this,
+			 [this]( const QModelIndex&, int first, int last ) { updateRows( first, last ); } );
+	connect( m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+			 [this]( const QModelIndex&, int first, int last ) { removeRows( first, last ); } );
+	connect( m_model, &QAbstractItemModel::dataChanged, this,
+			 [this]( const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles ) {
+				 if( roles.isEmpty() || roles.contains( Qt::DecorationRole ) )
+				 {
+					 updateRows( topLeft.row(), bottomRight.row() );
+				 }
+			 } );
+	connect( m_model, &QAbstractItemModel::modelReset, this, &ComputerScreenAtlas::relayout );
+}
+
+
+
+ComputerScreenAtlas::~ComputerScreenAtlas()
+{
+	if( m_window && m_texture )
+	{
+		// the texture has to be deleted in the render thread once no node uses it anymore
+		m_window->disconnect( this );
+		m_window->scheduleRenderJob( new ComputerScreenAtlasTextureReleaseJob( m_texture ),
+									 QQuickWindow::AfterSynchronizingStage );
+	}
+}
+
+
+
+void ComputerScreenAtlas::setTileSize( QSize size )
+{
+	if( size != m_tileSize )
+	{
+		m_tileSize = size;
+
+		relayout();
+	}
+}
+
+
+
+QSGTexture* ComputerScreenAtlas::texture( QQuickWindow* window )
+{
+	if( window != m_window )
+	{
+		if( m_window )
+		{
+			m_window->disconnect( this );
+		}
+
+		releaseTexture();
+
+		m_window = window;
+
+		if( m_window )
+		{
+			connect( m_window, &QQuickWindow::sceneGraphInvalidated,
+					 this, &ComputerScreenAtlas::releaseTexture, Qt::DirectConnection );
+		}
+	}
+
+	if( m_window == nullptr || m_image.isNull() )
+	{
+		return nullptr;
+	}
+
+	const auto useOpenGL = m_window->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL;
+
+	if( m_texture && ( m_relayouted || ( useOpenGL == false && m_dirtySlots.isEmpty() == false ) ) )
+	{
+		// nodes using the old texture are updated within the same synchronization
+		releaseTexture();
+	}
+
+	if( m_texture == nullptr )
+	{
+		if( useOpenGL )
+		{
+			m_texture = new ComputerScreenAtlasTexture( m_image );
+		}
+		else
+		{
+			m_texture = m_window->createTextureFromImage( m_image );
+		}
+	}
+	else if( m_dirtySlots.isEmpty() == false )
+	{
+		// each slot is uploaded once no matter how often its screen changed since the last frame
+		QVector<QRect> dirtyRects;
+		dirtyRects.reserve( m_dirtySlots.size() );
+		for( const auto slot : qAsConst(m_dirtySlots) )
+		{
+			dirtyRects.append( slotRect( slot ) );
+		}
+
+		static_cast<ComputerScreenAtlasTexture *>( m_texture )->upload( m_image, dirtyRects );
+	}
+
+	m_dirtySlots.clear();
+	m_relayouted = false;
+
+	return m_texture;
+}
+
+
+
+QRect ComputerScreenAtlas::tileRect( NetworkObject::Uid uid ) const
+{
+	const auto it = m_tiles.constFind( uid );
+	if( it == m_tiles.constEnd() || it->slot < 0 )
+	{
+		return {};
+	}
+
+	return slotRect( it->slot );
+}
+
+
+
+QImage ComputerScreenAtlas::overflowImage( NetworkObject::Uid uid ) const
+{
+	return m_tiles.value( uid ).overflowImage;
+}
+
+
+
+int ComputerScreenAtlas::version( NetworkObject::Uid uid ) const
+{
+	return m_tiles.value( uid ).version;
+}
+
+
+
+void ComputerScreenAtlas::relayout()
+{
+	m_tiles.clear();
+	m_freeSlots.clear();
+	m_nextSlot = 0;
+	m_dirtySlots.clear();
+	m_relayouted = true;
+
+	const auto rowCount = m_model->rowCount();
+
+	if( m_tileSize.isEmpty() || rowCount <= 0 )
+	{
+		m_image = {};
+		m_columns = 0;
+		m_slotCount = 0;
+
+		Q_EMIT updated();
+		return;
+	}
+
+	// leave some tiles spare so that adding computers does not require a relayout each time
+	const auto tileCount = rowCount + ( rowCount * SpareTilesPercentage + 99 ) / 100;
+	const auto maximumColumns = qMax( 1, MaximumSize / m_tileSize.width() );
+	const auto maximumRows = qMax( 1, MaximumSize / m_tileSize.height() );
+
+	m_columns = qBound( 1, int( std::ceil( std::sqrt( tileCount ) ) ), maximumColumns );
+	auto rows = ( tileCount + m_columns - 1 ) / m_columns;
+	if( rows > maximumRows )
+	{
+		m_columns = maximumColumns;
+		rows = qMin( maximumRows, ( tileCount + m_columns - 1 ) / m_columns );
+	}
+
+	m_slotCount = m_columns * rows;
+
+	const QSize imageSize( m_columns * m_tileSize.width(), rows * m_tileSize.height() );
+	if( m_image.size() != imageSize )
+	{
+		m_image = QImage( imageSize, QImage::Format_RGBA8888_Premultiplied );
+	}
+	m_image.fill( Qt::transparent );
+
+	updateRows( 0, rowCount - 1 );
+}
+
+
+
+void ComputerScreenAtlas::updateRows( int first, int last )
+{
+	if( m_image.isNull() )
+	{
+		if( m_tileSize.isEmpty() == false )
+		{
+			relayout();
+		}
+		return;
+	}
+
+	QPainter painter( &m_image );
+	painter.setCompositionMode( QPainter::CompositionMode_Source );
+
+	for( int row = first; row <= last; ++row )
+	{
+		const auto index = m_model->index( row, 0 );
+		const auto uid = m_model->data( index, ComputerListModel::UidRole ).toUuid();
+
+		auto it = m_tiles.find( uid );
+		if( it == m_tiles.end() )
+		{
+			const auto slot = allocateSlot();
+			if( slot < 0 && m_slotCount < maximumSlotCount() )
+			{
+				painter.end();
+				relayout();
+				return;
+			}
+
+			it = m_tiles.insert( uid, {} );
+			it->slot = slot;
+		}
+
+		const auto image = m_model->data( index, Qt::DecorationRole ).value<QImage>();
+
+		if( it->slot < 0 )
+		{
+			it->overflowImage = image;
+		}
+		else
+		{
+			drawTile( painter, slotRect( it->slot ), image );
+			m_dirtySlots.insert( it->slot );
+		}
+
+		++it->version;
+	}
+
+	painter.end();
+
+	Q_EMIT updated();
+}
+
+
+
+void ComputerScreenAtlas::removeRows( int first, int last )
+{
+	for( int row = first; row <= last; ++row )
+	{
+		const auto uid = m_model->data( m_model->index( row, 0 ), ComputerListModel::UidRole ).toUuid();
+		const auto it = m_tiles.find( uid );
+		if( it != m_tiles.end() )
+		{
+			if( it->slot >= 0 )
+			{
+				m_freeSlots.append( it->slot );
+			}
+			m_tiles.erase( it );
+		}
+	}
+}
+
+
+
+int ComputerScreenAtlas::maximumSlotCount() const
+{
+	return qMax( 1, MaximumSize / m_tileSize.width() ) * qMax( 1, MaximumSize / m_tileSize.height() );
+}
+
+
+
+int ComputerScreenAtlas::allocateSlot()
+{
+	if( m_freeSlots.isEmpty() == false )
+	{
+		return m_freeSlots.takeLast();
+	}
+
+	if( m_nextSlot < m_slotCount )
+	{
+		return m_nextSlot++;
+	}
+
+	return -1;
+}
+
+
+
+QRect ComputerScreenAtlas::slotRect( int slot ) const
+{
+	return { ( slot % m_columns ) * m_tileSize.width(), ( slot / m_columns ) * m_tileSize.height(),
+			 m_tileSize.width(), m_tileSize.height() };
+}
+
+
+
+void ComputerScreenAtlas::drawTile( QPainter& painter, const QRect& rect, const QImage& image )
+{
+	painter.fillRect( rect, Qt::transparent );
+
+	if( image.isNull() )
+	{
+		return;
+	}
+
+	// images usually already have the tile size, so scaling only happens while the size is changing
+	const auto size = image.size().scaled( rect.size(), Qt::KeepAspectRatio );
+	const QRect target( rect.x() + ( rect.width() - size.width() ) / 2,
+						rect.y() + ( rect.height() - size.height() ) / 2,
+						size.width(), size.height() );
+
+	if( target.size() == image.size() )
+	{
+		painter.drawImage( target.topLeft(), image );
+	}
+	else
+	{
+		painter.drawImage( target, image );
+	}
+}
+
+
+
+void ComputerScreenAtlas::releaseTexture()
+{
+	delete m_texture;
+	m_texture = nullptr;
+}
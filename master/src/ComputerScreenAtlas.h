@@ -0,0 +1,102 @@
+/*
+ * ComputerScreenAtlas.h - header file for ComputerScreenAtlas
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QSet>
+#include <QVector>
+
+#include "NetworkObject.h"
+
+class QAbstractItemModel;
+class QPainter;
+class QQuickWindow;
+class QSGTexture;
+
+// draws the screens of all computers of a model into tiles of a single image
+// which is shared by all ComputerScreenItems as one texture - only the tiles
+// of changed computers are uploaded again
+class ComputerScreenAtlas : public QObject
+{
+	Q_OBJECT
+public:
+	static constexpr int MaximumSize = 8192;
+	static constexpr int SpareTilesPercentage = 25;
+
+	ComputerScreenAtlas( QAbstractItemModel* model, QObject* parent = nullptr );
+	~ComputerScreenAtlas() override;
+
+	void setTileSize( QSize size );
+
+	// the following functions must only be called while the GUI thread is blocked, i.e. in updatePaintNode()
+	QSGTexture* texture( QQuickWindow* window );
+	QRect tileRect( NetworkObject::Uid uid ) const;
+
+	// screens which did not fit into the atlas
+	QImage overflowImage( NetworkObject::Uid uid ) const;
+	int version( NetworkObject::Uid uid ) const;
+
+Q_SIGNALS:
+	void updated();
+
+private:
+	struct Tile
+	{
+		int slot{-1};
+		int version{0};
+		QImage overflowImage;
+	};
+
+	void relayout();
+	void updateRows( int first, int last );
+	void removeRows( int first, int last );
+
+	int maximumSlotCount() const;
+	int allocateSlot();
+	QRect slotRect( int slot ) const;
+	void drawTile( QPainter& painter, const QRect& rect, const QImage& image );
+
+	void releaseTexture();
+
+	QAbstractItemModel* m_model;
+
+	QSize m_tileSize;
+	int m_columns{0};
+	int m_slotCount{0};
+	int m_nextSlot{0};
+	QVector<int> m_freeSlots;
+
+	QImage m_image;
+	QHash<NetworkObject::Uid, Tile> m_tiles;
+	QSet<int> m_dirtySlots;
+	bool m_relayouted{false};
+
+	QQuickWindow* m_window{nullptr};
+	QSGTexture* m_texture{nullptr};
+
+};
@@ -0,0 +1,159 @@
+/*
+ * ComputerScreenItem.cpp - implementation of ComputerScreenItem
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QQuickWindow>
+#include <QSGSimpleTextureNode>
+
+#include "ComputerScreenAtlas.h"
+#include "ComputerScreenItem.h"
+
+
+ComputerScreenItem::ComputerScreenItem( QQuickItem* parent ) :
+	QQuickItem( parent )
+{
+	setFlag( ItemHasContents, true );
+}
+
+
+
+QObject* ComputerScreenItem::atlas() const
+{
+	return m_atlas;
+}
+
+
+
+void ComputerScreenItem::setAtlas( QObject* atlas )
+{
+	if( m_atlas )
+	{
+		m_atlas->disconnect( this );
+	}
+
+	m_atlas = qobject_cast<ComputerScreenAtlas *>( atlas );
+	m_overflowImageVersion = -1;
+
+	if( m_atlas )
+	{
+		connect( m_atlas, &ComputerScreenAtlas::updated, this, &QQuickItem::update );
+	}
+
+	update();
+
+	Q_EMIT atlasChanged();
+}
+
+
+
+QVariant ComputerScreenItem::uid() const
+{
+	return m_uid;
+}
+
+
+
+void ComputerScreenItem::setUid( const QVariant& uid )
+{
+	m_uid = uid.toUuid();
+	m_overflowImageVersion = -1;
+
+	update();
+
+	Q_EMIT uidChanged();
+}
+
+
+
+QSGNode* ComputerScreenItem::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* updatePaintNodeData )
+{
+	Q_UNUSED(updatePaintNodeData)
+
+	auto node = static_cast<QSGSimpleTextureNode *>( oldNode );
+
+	const auto texture = m_atlas ? m_atlas->texture( window() ) : nullptr;
+	if( texture == nullptr )
+	{
+		delete node;
+		return nullptr;
+	}
+
+	if( node == nullptr )
+	{
+		node = new QSGSimpleTextureNode;
+		node->setFiltering( QSGTexture::Linear );
+	}
+
+	const auto tileRect = m_atlas->tileRect( m_uid );
+	if( tileRect.isEmpty() == false )
+	{
+		if( node->ownsTexture() )
+		{
+			delete node->texture();
+			node->setOwnsTexture( false );
+			m_overflowImageVersion = -1;
+		}
+
+		node->setTexture( texture );
+		// inset by half a texel so that linear filtering does not sample the neighbouring tiles
+		node->setSourceRect( QRectF( tileRect ).adjusted( 0.5, 0.5, -0.5, -0.5 ) );
+	}
+	else
+	{
+		// atlas is full, so fall back to a separate texture which is only updated when the screen changes
+		const auto version = m_atlas->version( m_uid );
+		if( node->ownsTexture() == false || version != m_overflowImageVersion )
+		{
+			const auto image = m_atlas->overflowImage( m_uid );
+			if( image.isNull() )
+			{
+				delete node;
+				return nullptr;
+			}
+
+			if( node->ownsTexture() )
+			{
+				delete node->texture();
+			}
+
+			node->setTexture( window()->createTextureFromImage( image ) );
+			node->setOwnsTexture( true );
+			node->setSourceRect( 0, 0, image.width(), image.height() );
+
+			m_overflowImageVersion = version;
+		}
+	}
+
+	if( node->ownsTexture() )
+	{
+		const auto textureSize = QSizeF( node->texture()->textureSize() ).scaled( size(), Qt::KeepAspectRatio );
+		node->setRect( ( width() - textureSize.width() ) / 2, ( height() - textureSize.height() ) / 2,
+					   textureSize.width(), textureSize.height() );
+	}
+	else
+	{
+		node->setRect( boundingRect() );
+	}
+
+	return node;
+}
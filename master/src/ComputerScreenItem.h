@@ -0,0 +1,64 @@
+/*
+ * ComputerScreenItem.h - header file for ComputerScreenItem
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QPointer>
+#include <QQuickItem>
+
+#include "NetworkObject.h"
+
+class ComputerScreenAtlas;
+
+// renders the screen of a single computer from the tile of a ComputerScreenAtlas
+class ComputerScreenItem : public QQuickItem
+{
+	Q_OBJECT
+	Q_PROPERTY(QObject* atlas READ atlas WRITE setAtlas NOTIFY atlasChanged)
+	Q_PROPERTY(QVariant uid READ uid WRITE setUid NOTIFY uidChanged)
+public:
+	explicit ComputerScreenItem( QQuickItem* parent = nullptr );
+	~ComputerScreenItem() override = default;
+
+	QObject* atlas() const;
+	void setAtlas( QObject* atlas );
+
+	QVariant uid() const;
+	void setUid( const QVariant& uid );
+
+protected:
+	QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* updatePaintNodeData ) override;
+
+private:
+	QPointer<ComputerScreenAtlas> m_atlas;
+	NetworkObject::Uid m_uid;
+
+	// screen is not part of the atlas and rendered from its own texture
+	int m_overflowImageVersion{-1};
+
+Q_SIGNALS:
+	void atlasChanged();
+	void uidChanged();
+
+};
@@ -0,0 +1,148 @@
+/*
+ * ComputerThumbnailCache.cpp - implementation of ComputerThumbnailCache
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include "ComputerListModel.h"
+#include "ComputerThumbnailCache.h"
+
+
+ComputerThumbnailCache::ComputerThumbnailCache( QObject* parent ) :
+	QObject( parent )
+{
+}
+
+
+
+void ComputerThumbnailCache::setSize( QSize size )
+{
+	m_size = size;
+}
+
+
+
+QImage ComputerThumbnailCache::thumbnail( const QModelIndex& index )
+{
+	const auto model = index.model();
+	if( model == nullptr )
+	{
+		return {};
+	}
+
+	const auto controlInterface = model->data( index, ComputerListModel::ControlInterfaceRole )
+									  .value<ComputerControlInterface::Pointer>();
+	if( controlInterface.isNull() )
+	{
+		return {};
+	}
+
+	auto& thumbnail = m_thumbnails[controlInterface];
+
+	const auto timestamp = controlInterface->timestamp();
+	if( thumbnail.timestamp == timestamp && thumbnail.size == m_size )
+	{
+		return thumbnail.image;
+	}
+
+	const auto screen = model->data( index, ComputerListModel::ScreenRole ).value<QImage>();
+	if( screen.isNull() || thumbnail.image.isNull() )
+	{
+		// small placeholder icons or nothing to show yet, so scale right away
+		auto image = screen;
+		if( image.isNull() )
+		{
+			image = model->data( index, Qt::DecorationRole ).value<QImage>();
+		}
+
+		thumbnail.image = scaled( image );
+		thumbnail.size = m_size;
+		thumbnail.timestamp = timestamp;
+	}
+	else if( thumbnail.scaling == false )
+	{
+		// keep showing the previous thumbnail until the new one is available
+		thumbnail.scaling = true;
+		scaleInBackground( controlInterface, screen, timestamp );
+	}
+
+	return thumbnail.image;
+}
+
+
+
+void ComputerThumbnailCache::remove( const ComputerControlInterface::Pointer& controlInterface )
+{
+	m_thumbnails.remove( controlInterface );
+}
+
+
+
+void ComputerThumbnailCache::clear()
+{
+	m_thumbnails.clear();
+}
+
+
+
+QImage ComputerThumbnailCache::scaled( const QImage& image ) const
+{
+	return image.scaled( m_size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+}
+
+
+
+void ComputerThumbnailCache::scaleInBackground( const ComputerControlInterface::Pointer& controlInterface,
+												const QImage& screen, int timestamp )
+{
+	const auto size = m_size;
+
+	auto watcher = new QFutureWatcher<QImage>( this );
+
+	connect( watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+		watcher->deleteLater();
+
+		const auto it = m_thumbnails.find( controlInterface );
+		if( it == m_thumbnails.end() )
+		{
+			// removed in the meantime
+			return;
+		}
+
+		it->scaling = false;
+
+		if( size == m_size )
+		{
+			it->image = watcher->result();
+			it->size = size;
+			it->timestamp = timestamp;
+		}
+
+		Q_EMIT thumbnailUpdated( controlInterface );
+	} );
+
+	watcher->setFuture( QtConcurrent::run( [=]() {
+		return screen.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+	} ) );
+}
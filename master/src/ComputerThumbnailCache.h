@@ -0,0 +1,69 @@
+/*
+ * ComputerThumbnailCache.h - header file for ComputerThumbnailCache
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QModelIndex>
+
+#include "ComputerControlInterface.h"
+
+// keeps screens of computers scaled to a common size and rescales them in
+// the background only when a computer's screen has changed
+class ComputerThumbnailCache : public QObject
+{
+	Q_OBJECT
+public:
+	explicit ComputerThumbnailCache( QObject* parent = nullptr );
+
+	void setSize( QSize size );
+
+	// returns the latest available thumbnail for given index of a ComputerControlListModel
+	QImage thumbnail( const QModelIndex& index );
+
+	void remove( const ComputerControlInterface::Pointer& controlInterface );
+	void clear();
+
+Q_SIGNALS:
+	void thumbnailUpdated( const ComputerControlInterface::Pointer& controlInterface );
+
+private:
+	struct Thumbnail
+	{
+		QImage image;
+		QSize size;
+		int timestamp{-1};
+		bool scaling{false};
+	};
+
+	QImage scaled( const QImage& image ) const;
+	void scaleInBackground( const ComputerControlInterface::Pointer& controlInterface, const QImage& screen,
+							int timestamp );
+
+	QSize m_size;
+
+	QHash<ComputerControlInterface::Pointer, Thumbnail> m_thumbnails;
+
+};
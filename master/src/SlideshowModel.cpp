@@ -53,13 +53,20 @@ SlideshowModel::SlideshowModel( QAbstractItemModel* sourceModel, QObject* parent
 			 } );
 
 	connect( &m_timer, &QTimer::timeout, this, &SlideshowModel::showNext );
+
+	connect( &m_thumbnailCache, &ComputerThumbnailCache::thumbnailUpdated, this, [this]() {
+		if( rowCount() > 0 )
+		{
+			Q_EMIT dataChanged( index( 0, 0 ), index( 0, 0 ), { Qt::DecorationRole } );
+		}
+	} );
 }
 
 
 
 void SlideshowModel::setIconSize( QSize size )
 {
-	m_iconSize = size;
+	m_thumbnailCache.setSize( size );
 
 	Q_EMIT dataChanged( index( 0, 0 ), index( rowCount() - 1, 0 ), { Qt::DisplayRole, Qt::DecorationRole } );
 }
@@ -81,13 +88,7 @@ QVariant SlideshowModel::data( const QModelIndex& index, int role ) const
 
 	if( role == Qt::DecorationRole )
 	{
-		auto screen = sourceModel()->data( sourceIndex, ComputerListModel::ScreenRole ).value<QImage>();
-		if( screen.isNull() )
-		{
-			screen = sourceModel()->data( sourceIndex, Qt::DecorationRole ).value<QImage>();
-		}
-
-		return screen.scaled( m_iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+		return m_thumbnailCache.thumbnail( sourceIndex );
 	}
 
 	return QSortFilterProxyModel::data( index, role );
@@ -184,6 +185,8 @@ bool SlideshowModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceP
 
 void SlideshowModel::setCurrentRow( int row )
 {
+	const auto previousControlInterface = m_currentControlInterface;
+
 	if( sourceModel()->rowCount() > 0 )
 	{
 		m_currentRow = qMax( 0, row ) % qMax( 1, sourceModel()->rowCount() );
@@ -198,5 +201,11 @@ void SlideshowModel::setCurrentRow( int row )
 		m_currentControlInterface.clear();
 	}
 
+	if( m_currentControlInterface != previousControlInterface )
+	{
+		// only the current computer is shown so don't keep thumbnails of others
+		m_thumbnailCache.clear();
+	}
+
 	invalidateFilter();
 }
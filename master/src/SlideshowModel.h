@@ -28,6 +28,7 @@
 #include <QTimer>
 
 #include "ComputerControlInterface.h"
+#include "ComputerThumbnailCache.h"
 
 class SlideshowModel : public QSortFilterProxyModel
 {
@@ -50,10 +51,10 @@ protected:
 private:
 	void setCurrentRow( int row );
 
-	QSize m_iconSize;
-
 	QTimer m_timer;
 
+	mutable ComputerThumbnailCache m_thumbnailCache{};
+
 	int m_currentRow{0};
 	ComputerControlInterface::Pointer m_currentControlInterface;
 
@@ -29,13 +29,15 @@ SpotlightModel::SpotlightModel( QAbstractItemModel* sourceModel, QObject* parent
 	QSortFilterProxyModel( parent )
 {
 	setSourceModel( sourceModel );
+
+	connect( &m_thumbnailCache, &ComputerThumbnailCache::thumbnailUpdated, this, &SpotlightModel::updateThumbnail );
 }
 
 
 
 void SpotlightModel::setIconSize( QSize size )
 {
-	m_iconSize = size;
+	m_thumbnailCache.setSize( size );
 
 	Q_EMIT dataChanged( index( 0, 0 ), index( rowCount() - 1, 0 ), { Qt::DisplayRole, Qt::DecorationRole } );
 }
@@ -72,6 +74,7 @@ void SpotlightModel::add( const ComputerControlInterface::Pointer& controlInterf
 void SpotlightModel::remove( const ComputerControlInterface::Pointer& controlInterface )
 {
 	m_controlInterfaces.removeAll( controlInterface );
+	m_thumbnailCache.remove( controlInterface );
 
 	controlInterface->setUpdateMode( ComputerControlInterface::UpdateMode::Monitoring );
 
@@ -80,6 +83,21 @@ void SpotlightModel::remove( const ComputerControlInterface::Pointer& controlInt
 
 
 
+void SpotlightModel::updateThumbnail( const ComputerControlInterface::Pointer& controlInterface )
+{
+	for( int row = 0; row < rowCount(); ++row )
+	{
+		const auto rowIndex = index( row, 0 );
+		if( data( rowIndex, ControlInterfaceRole ).value<ComputerControlInterface::Pointer>() == controlInterface )
+		{
+			Q_EMIT dataChanged( rowIndex, rowIndex, { Qt::DecorationRole } );
+			break;
+		}
+	}
+}
+
+
+
 QVariant SpotlightModel::data( const QModelIndex& index, int role ) const
 {
 	const auto sourceIndex = mapToSource( index );
@@ -90,13 +108,7 @@ QVariant SpotlightModel::data( const QModelIndex& index, int role ) const
 
 	if( role == Qt::DecorationRole )
 	{
-		auto screen = sourceModel()->data( sourceIndex, ComputerListModel::ScreenRole ).value<QImage>();
-		if( screen.isNull() )
-		{
-			screen = sourceModel()->data( sourceIndex, Qt::DecorationRole ).value<QImage>();
-		}
-
-		return screen.scaled( m_iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+		return m_thumbnailCache.thumbnail( sourceIndex );
 	}
 
 	return QSortFilterProxyModel::data( index, role );
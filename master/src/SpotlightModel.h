@@ -27,6 +27,7 @@
 #include <QSortFilterProxyModel>
 
 #include "ComputerControlListModel.h"
+#include "ComputerThumbnailCache.h"
 
 class SpotlightModel : public QSortFilterProxyModel
 {
@@ -48,9 +49,12 @@ protected:
 	bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const override;
 
 private:
-	QSize m_iconSize;
+	void updateThumbnail( const ComputerControlInterface::Pointer& controlInterface );
+
 	bool m_updateInRealtime;
 
 	ComputerControlInterfaceList m_controlInterfaces;
 
+	mutable ComputerThumbnailCache m_thumbnailCache{};
+
 };
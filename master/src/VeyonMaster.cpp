@@ -32,6 +32,7 @@
 #include "ComputerManager.h"
 #include "ComputerMonitoringItem.h"
 #include "ComputerMonitoringModel.h"
+#include "ComputerScreenItem.h"
 #include "FeatureManager.h"
 #include "MainWindow.h"
 #include "MonitoringMode.h"
@@ -301,6 +302,7 @@ void VeyonMaster::initUserInterface()
 		const auto minorVersion = veyonVersion.minorVersion();
 
 		qmlRegisterType<ComputerMonitoringItem>( "Veyon.Master", majorVersion, minorVersion, "ComputerMonitoringItem" );
+		qmlRegisterType<ComputerScreenItem>( "Veyon.Master", majorVersion, minorVersion, "ComputerScreen" );
 
 		m_qmlAppEngine = new QQmlApplicationEngine( this );
 		m_qmlAppEngine->addImageProvider( m_computerControlListModel->imageProviderId(), m_computerControlListModel );
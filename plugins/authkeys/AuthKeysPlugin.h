@@ -93,6 +93,12 @@ public:
 	// server side authentication
 	VncServerClient::AuthState performAuthentication( VncServerClient* client, VariantArrayMessage& message ) const override;
 
+	bool isReentrant() const override
+	{
+		// only verifies signatures with public keys loaded per call
+		return true;
+	}
+
 	// client side authentication
 	bool authenticate( QIODevice* socket ) const override;
 
@@ -0,0 +1,737 @@
+/*
+ * DemoBenchmarks.cpp - implementation of DemoBenchmarks class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QReadWriteLock>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <ctime>
+
+#include "CommandLineIO.h"
+#include "CryptoCore.h"
+#include "DemoAuthentication.h"
+#include "DemoBenchmarks.h"
+#include "DemoClientProtocol.h"
+#include "DemoConfiguration.h"
+#include "DemoMulticastStream.h"
+#include "DemoServer.h"
+#include "DemoUpdateSegment.h"
+
+
+// minimal RFB server which accepts the demo server without authentication and
+// sends prepared framebuffer updates as fast as possible when told to do so
+class DemoBenchmarkVncServer
+{
+public:
+	DemoBenchmarkVncServer( QSize framebufferSize, const QVector<QByteArray>& updates ) :
+		m_framebufferSize( framebufferSize ),
+		m_updates( updates )
+	{
+		QObject::connect( &m_server, &QTcpServer::newConnection, &m_server, [this]() { acceptConnection(); } );
+	}
+
+	~DemoBenchmarkVncServer()
+	{
+		delete m_socket;
+	}
+
+	bool listen()
+	{
+		return m_server.listen( QHostAddress::LocalHost );
+	}
+
+	quint16 port() const
+	{
+		return m_server.serverPort();
+	}
+
+	void sendUpdates()
+	{
+		if( m_socket && m_state == State::Running )
+		{
+			for( const auto& update : qAsConst(m_updates) )
+			{
+				m_socket->write( update );
+			}
+		}
+	}
+
+	static QByteArray framebufferUpdateMessage( const QRect& rect )
+	{
+		rfbFramebufferUpdateMsg message{};
+		message.type = rfbFramebufferUpdate;
+		message.nRects = qToBigEndian<uint16_t>( 1 );
+
+		rfbFramebufferUpdateRectHeader rectHeader{};
+		rectHeader.r.x = qToBigEndian<uint16_t>( uint16_t( rect.x() ) );
+		rectHeader.r.y = qToBigEndian<uint16_t>( uint16_t( rect.y() ) );
+		rectHeader.r.w = qToBigEndian<uint16_t>( uint16_t( rect.width() ) );
+		rectHeader.r.h = qToBigEndian<uint16_t>( uint16_t( rect.height() ) );
+		rectHeader.encoding = qToBigEndian<uint32_t>( rfbEncodingRaw );
+
+		return QByteArray( reinterpret_cast<const char *>( &message ), sz_rfbFramebufferUpdateMsg ) +
+			   QByteArray( reinterpret_cast<const char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader ) +
+			   QByteArray( rect.width() * rect.height() * 4, char( rect.height() ) );
+	}
+
+private:
+	enum class State {
+		Protocol,
+		SecurityType,
+		ClientInit,
+		Running
+	};
+
+	void acceptConnection()
+	{
+		// the demo server only reconnects after its previous connection has been closed
+		delete m_socket;
+
+		m_socket = m_server.nextPendingConnection();
+		QObject::connect( m_socket, &QTcpSocket::readyRead, &m_server, [this]() {
+			while( readFromClient() )
+			{
+			}
+		} );
+
+		m_state = State::Protocol;
+		m_socket->write( "RFB 003.008\n", sz_rfbProtocolVersionMsg );
+	}
+
+	bool readFromClient()
+	{
+		switch( m_state )
+		{
+		case State::Protocol:
+			if( m_socket->bytesAvailable() >= sz_rfbProtocolVersionMsg )
+			{
+				m_socket->read( sz_rfbProtocolVersionMsg );
+
+				const char securityTypes[] = { 1, rfbSecTypeNone };
+				m_socket->write( securityTypes, sizeof(securityTypes) );
+				m_state = State::SecurityType;
+				return true;
+			}
+			break;
+
+		case State::SecurityType:
+			if( m_socket->bytesAvailable() >= 1 )
+			{
+				m_socket->read( 1 );
+
+				const auto securityResult = qToBigEndian<uint32_t>( rfbVncAuthOK );
+				m_socket->write( reinterpret_cast<const char *>( &securityResult ), sizeof(securityResult) );
+				m_state = State::ClientInit;
+				return true;
+			}
+			break;
+
+		case State::ClientInit:
+			if( m_socket->bytesAvailable() >= sz_rfbClientInitMsg )
+			{
+				m_socket->read( sz_rfbClientInitMsg );
+
+				rfbServerInitMsg serverInitMessage{};
+				serverInitMessage.framebufferWidth = qToBigEndian<uint16_t>( uint16_t( m_framebufferSize.width() ) );
+				serverInitMessage.framebufferHeight = qToBigEndian<uint16_t>( uint16_t( m_framebufferSize.height() ) );
+				serverInitMessage.format.bitsPerPixel = 32;
+				serverInitMessage.format.depth = 24;
+				serverInitMessage.format.trueColour = 1;
+				serverInitMessage.format.redMax = qToBigEndian<uint16_t>( 0xff );
+				serverInitMessage.format.greenMax = qToBigEndian<uint16_t>( 0xff );
+				serverInitMessage.format.blueMax = qToBigEndian<uint16_t>( 0xff );
+				serverInitMessage.format.redShift = 16;
+				serverInitMessage.format.greenShift = 8;
+				serverInitMessage.format.blueShift = 0;
+				m_socket->write( reinterpret_cast<const char *>( &serverInitMessage ), sz_rfbServerInitMsg );
+				m_state = State::Running;
+				return true;
+			}
+			break;
+
+		case State::Running:
+			return skipClientMessage();
+		}
+
+		return false;
+	}
+
+	bool skipClientMessage()
+	{
+		uint8_t messageType = 0;
+		if( m_socket->peek( reinterpret_cast<char *>( &messageType ), sizeof(messageType) ) != sizeof(messageType) )
+		{
+			return false;
+		}
+
+		qint64 size = 0;
+
+		switch( messageType )
+		{
+		case rfbSetPixelFormat:
+			size = sz_rfbSetPixelFormatMsg;
+			break;
+
+		case rfbSetEncodings:
+		{
+			rfbSetEncodingsMsg message{};
+			if( m_socket->peek( reinterpret_cast<char *>( &message ), sz_rfbSetEncodingsMsg ) != sz_rfbSetEncodingsMsg )
+			{
+				return false;
+			}
+			size = sz_rfbSetEncodingsMsg + qFromBigEndian( message.nEncodings ) * qint64( sizeof(uint32_t) );
+			break;
+		}
+
+		case rfbFramebufferUpdateRequest:
+			// updates are sent all at once through sendUpdates()
+			size = sz_rfbFramebufferUpdateRequestMsg;
+			break;
+
+		default:
+			size = m_socket->bytesAvailable();
+			break;
+		}
+
+		if( m_socket->bytesAvailable() < size )
+		{
+			return false;
+		}
+
+		return m_socket->read( size ).size() == size;
+	}
+
+	const QSize m_framebufferSize;
+	const QVector<QByteArray> m_updates;
+
+	QTcpServer m_server{};
+	QTcpSocket* m_socket{nullptr};
+	State m_state{State::Protocol};
+
+} ;
+
+
+
+CommandLinePluginInterface::RunResult DemoBenchmarks::benchmarkUpdates( const QStringList& arguments )
+{
+	static constexpr int DefaultClients = 100;
+	static constexpr int DefaultMessages = 2000;
+
+	const auto clients = qMax( 1, arguments.value( 0, QString::number( DefaultClients ) ).toInt() );
+	const auto messageCount = qBound( 1, arguments.value( 1, QString::number( DefaultMessages ) ).toInt(),
+									  int(DemoUpdateSegment::Capacity) );
+
+	QVector<QByteArray> messages;
+	messages.reserve( messageCount );
+	qint64 expectedBytes = 0;
+	for( int i = 0; i < messageCount; ++i )
+	{
+		// mix of small incremental and large updates
+		messages.append( QByteArray( 256 + ( i * 7919 ) % ( 64 * 1024 ), 'x' ) );
+		expectedBytes += messages.last().size();
+	}
+	expectedBytes *= clients;
+
+	// previous behaviour: queue guarded by a reader-writer lock and summed up on each enqueue
+	QReadWriteLock dataLock;
+	QVector<QByteArray> queue;
+	const auto queueSize = [&queue]() {
+		qint64 size = 0;
+		for( const auto& message : qAsConst(queue) )
+		{
+			size += message.size();
+		}
+		return size;
+	};
+
+	qint64 lockedQueueBytes = 0;
+	const auto lockedQueueTime = benchmarkClients( clients, [&]() {
+		for( const auto& message : qAsConst(messages) )
+		{
+			dataLock.lockForWrite();
+			queueSize();
+			queue.append( message );
+			dataLock.unlock();
+			queueSize();
+		}
+	}, [&]() {
+		qint64 bytes = 0;
+		int index = 0;
+		while( index < messageCount )
+		{
+			dataLock.lockForRead();
+			const auto count = queue.count();
+			for( ; index < count; ++index )
+			{
+				bytes += queue.at( index ).size();
+			}
+			dataLock.unlock();
+			QThread::yieldCurrentThread();
+		}
+		return bytes;
+	}, lockedQueueBytes );
+
+	DemoUpdateSegment segment( 0, 0, true );
+
+	qint64 segmentBytes = 0;
+	const auto segmentTime = benchmarkClients( clients, [&]() {
+		for( const auto& message : qAsConst(messages) )
+		{
+			segment.append( message );
+		}
+	}, [&]() {
+		qint64 bytes = 0;
+		int index = 0;
+		while( index < messageCount )
+		{
+			const auto count = segment.count();
+			for( ; index < count; ++index )
+			{
+				bytes += segment.message( index ).size();
+			}
+			QThread::yieldCurrentThread();
+		}
+		return bytes;
+	}, segmentBytes );
+
+	printf( "[TEST]: BenchmarkDemo: %d messages to %d clients: locked queue %.3f ms, segment log %.3f ms\n",
+			messageCount, clients, double(lockedQueueTime) / 1000000, double(segmentTime) / 1000000 );
+
+	if( lockedQueueBytes != expectedBytes || segmentBytes != expectedBytes )
+	{
+		printf( "[TEST]: BenchmarkDemo: RECEIVED DATA DIFFERS\n" );
+		return CommandLinePluginInterface::Failed;
+	}
+
+	return CommandLinePluginInterface::Successful;
+}
+
+
+
+qint64 DemoBenchmarks::benchmarkClients( int clients, const std::function<void()>& server,
+										 const std::function<qint64()>& client, qint64& bytes )
+{
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount( clients );
+
+	QVector<QFuture<qint64>> futures;
+	futures.reserve( clients );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for( int i = 0; i < clients; ++i )
+	{
+		futures.append( QtConcurrent::run( &threadPool, client ) );
+	}
+
+	server();
+
+	bytes = 0;
+	for( const auto& future : qAsConst(futures) )
+	{
+		bytes += future.result();
+	}
+
+	return timer.nsecsElapsed();
+}
+
+
+
+CommandLinePluginInterface::RunResult DemoBenchmarks::benchmarkFanout( const QStringList& arguments )
+{
+	static constexpr int DefaultMaximumClients = 120;
+	static constexpr int DefaultMessages = 500;
+	static constexpr int ClientStep = 20;
+	static constexpr int UpdateWidth = 128;
+
+	const auto maximumClients = qMax( 1, arguments.value( 0, QString::number( DefaultMaximumClients ) ).toInt() );
+	const auto messageCount = qBound( 1, arguments.value( 1, QString::number( DefaultMessages ) ).toInt(),
+									  int(DemoUpdateSegment::Capacity) );
+	const auto ioThreads = qMax( 1, arguments.value( 2, QString::number( DemoServer::ioThreadCount() ) ).toInt() );
+
+	// start with a full update followed by incremental updates of different sizes
+	QVector<QByteArray> messages;
+	messages.reserve( messageCount );
+	messages.append( DemoBenchmarkVncServer::framebufferUpdateMessage( QRect( 0, 0, FanoutFramebufferWidth, FanoutFramebufferHeight ) ) );
+	for( int i = 1; i < messageCount; ++i )
+	{
+		const QSize size( UpdateWidth, 1 + ( i * 7919 ) % UpdateWidth );
+		const QPoint position( ( i * 37 ) % ( FanoutFramebufferWidth - size.width() ),
+							   ( i * 53 ) % ( FanoutFramebufferHeight - size.height() ) );
+		messages.append( DemoBenchmarkVncServer::framebufferUpdateMessage( QRect( position, size ) ) );
+	}
+
+	QVector<int> clientCounts{1};
+	for( int clients = ClientStep; clients <= maximumClients; clients += ClientStep )
+	{
+		clientCounts.append( clients );
+	}
+	if( clientCounts.last() != maximumClients )
+	{
+		clientCounts.append( maximumClients );
+	}
+
+	// CPU load covers the whole process including the clients reading from their sockets
+	printf( "[TEST]: BenchmarkDemoFanout: clients, thread per client MB/s, thread per client CPU %%, "
+			"%d I/O threads MB/s, %d I/O threads CPU %%\n", ioThreads, ioThreads );
+
+	for( auto clients : qAsConst(clientCounts) )
+	{
+		double threadPerClientThroughput = 0;
+		double threadPerClientLoad = 0;
+		double fanOutThroughput = 0;
+		double fanOutLoad = 0;
+
+		if( measureFanout( clients, clients, messages, threadPerClientThroughput, threadPerClientLoad ) == false ||
+			measureFanout( clients, qMin( clients, ioThreads ), messages, fanOutThroughput, fanOutLoad ) == false )
+		{
+			printf( "[TEST]: BenchmarkDemoFanout: %d: NOT ALL CLIENTS RECEIVED ALL UPDATES\n", clients );
+			return CommandLinePluginInterface::Failed;
+		}
+
+		printf( "[TEST]: BenchmarkDemoFanout: %d, %.1f, %.1f, %.1f, %.1f\n", clients,
+				threadPerClientThroughput, threadPerClientLoad, fanOutThroughput, fanOutLoad );
+	}
+
+	return CommandLinePluginInterface::Successful;
+}
+
+
+
+bool DemoBenchmarks::measureFanout( int clients, int threads, const QVector<QByteArray>& messages,
+									double& throughput, double& cpuLoad )
+{
+	static constexpr int Timeout = 60000;
+	static constexpr int UpdateInterval = 5;
+	static constexpr int SettleTime = 100;
+
+	Configuration::Object configurationObject;
+	DemoConfiguration configuration( &configurationObject );
+
+	// all updates arrive at once, i.e. clients only catch up at the very end
+	configuration.setMaximumClientLag( Timeout );
+	configuration.setFramebufferUpdateInterval( UpdateInterval );
+
+	DemoAuthentication authentication( Plugin::Uid::createUuid() );
+	authentication.setAccessToken( CryptoCore::generateChallenge() );
+
+	DemoBenchmarkVncServer vncServer( { FanoutFramebufferWidth, FanoutFramebufferHeight }, messages );
+	if( vncServer.listen() == false )
+	{
+		CommandLineIO::error( QStringLiteral("could not listen on loopback interface") );
+		return false;
+	}
+
+	DemoServer demoServer( vncServer.port(), {}, authentication, configuration, 0, {}, nullptr );
+	demoServer.setIOThreadCount( threads );
+
+	// updates are forwarded to the clients as received from the VNC server
+	qint64 expectedBytes = 0;
+	for( const auto& message : messages )
+	{
+		expectedBytes += message.size();
+	}
+
+	rfbFramebufferUpdateRequestMsg updateRequest{};
+	updateRequest.type = rfbFramebufferUpdateRequest;
+	updateRequest.incremental = 1;
+	updateRequest.w = qToBigEndian<uint16_t>( uint16_t( FanoutFramebufferWidth ) );
+	updateRequest.h = qToBigEndian<uint16_t>( uint16_t( FanoutFramebufferHeight ) );
+	const QByteArray updateRequestMessage( reinterpret_cast<const char *>( &updateRequest ), sz_rfbFramebufferUpdateRequestMsg );
+
+	QEventLoop eventLoop;
+	QVector<QTcpSocket *> sockets;
+	QVector<DemoClientProtocol *> protocols;
+	QVector<qint64> receivedBytes( clients, 0 );
+	int runningClients = 0;
+	int finishedClients = 0;
+
+	for( int i = 0; i < clients; ++i )
+	{
+		auto socket = new QTcpSocket;
+		auto protocol = new DemoClientProtocol( authentication, socket );
+
+		// behave like a VNC client, i.e. request the next update after receiving data
+		QObject::connect( socket, &QTcpSocket::readyRead, &eventLoop, [&, i, socket, protocol]() {
+			if( protocol->state() != DemoClientProtocol::State::Running )
+			{
+				while( protocol->read() )
+				{
+				}
+				if( protocol->state() != DemoClientProtocol::State::Running )
+				{
+					return;
+				}
+				++runningClients;
+			}
+
+			if( receivedBytes[i] >= expectedBytes )
+			{
+				socket->readAll();
+				return;
+			}
+
+			receivedBytes[i] += socket->readAll().size();
+
+			if( receivedBytes[i] < expectedBytes )
+			{
+				socket->write( updateRequestMessage );
+			}
+			else if( ++finishedClients >= clients )
+			{
+				eventLoop.quit();
+			}
+		} );
+
+		protocol->start();
+		socket->connectToHost( QHostAddress::LocalHost, demoServer.serverPort() );
+
+		sockets.append( socket );
+		protocols.append( protocol );
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// the demo server only accepts connections once it is connected to the VNC server
+	while( runningClients < clients && timer.elapsed() < Timeout )
+	{
+		QCoreApplication::processEvents( QEventLoop::AllEvents, 10 );
+	}
+
+	// let all connections process the first update request of their client so
+	// that nobody joins in the middle of the stream and receives a snapshot instead
+	timer.restart();
+	while( timer.elapsed() < SettleTime )
+	{
+		QCoreApplication::processEvents( QEventLoop::AllEvents, 10 );
+	}
+
+	const auto cpuStart = std::clock();
+	timer.restart();
+
+	if( runningClients >= clients )
+	{
+		vncServer.sendUpdates();
+
+		QTimer::singleShot( Timeout, &eventLoop, &QEventLoop::quit );
+		eventLoop.exec();
+	}
+
+	const auto elapsed = qMax<qint64>( 1, timer.nsecsElapsed() );
+	const auto cpuTime = double( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+
+	qDeleteAll( protocols );
+	qDeleteAll( sockets );
+
+	qint64 bytes = 0;
+	for( const auto clientBytes : qAsConst(receivedBytes) )
+	{
+		bytes += clientBytes;
+	}
+
+	throughput = double(bytes) / 1024 / 1024 / ( double(elapsed) / 1000000000 );
+	cpuLoad = cpuTime / ( double(elapsed) / 1000000000 ) * 100;
+
+	return finishedClients >= clients;
+}
+
+
+
+CommandLinePluginInterface::RunResult DemoBenchmarks::testMulticast( const QStringList& arguments )
+{
+	static constexpr int DefaultReceivers = 8;
+	static constexpr int DefaultMessages = 2000;
+	static constexpr int DefaultLossPercent = 5;
+	static constexpr int KeyFrameInterval = 500;
+	static constexpr int ReceiveTimeout = 20;
+	static constexpr int MaximumRepairSequences = 64;
+
+	const auto receiverCount = qMax( 1, arguments.value( 0, QString::number( DefaultReceivers ) ).toInt() );
+	const auto messageCount = qMax( 1, arguments.value( 1, QString::number( DefaultMessages ) ).toInt() );
+	const auto lossPercent = qBound( 0, arguments.value( 2, QString::number( DefaultLossPercent ) ).toInt(), 99 );
+	const QHostAddress group( arguments.value( 3, QStringLiteral("239.255.86.86") ) );
+
+	if( group.isMulticast() == false )
+	{
+		CommandLineIO::error( QStringLiteral("invalid multicast group address") );
+		return CommandLinePluginInterface::Failed;
+	}
+
+	QVector<QByteArray> messages;
+	messages.reserve( messageCount );
+	for( int i = 0; i < messageCount; ++i )
+	{
+		QByteArray message( 64 + ( i * 7919 ) % ( 16 * 1024 ), char( i ) );
+		memcpy( message.data(), &i, sizeof(i) ); // Flawfinder: ignore
+		messages.append( message );
+	}
+
+	const auto key = DemoMulticastStream::deriveKey( CryptoCore::generateChallenge() );
+	const auto forgeryKey = DemoMulticastStream::deriveKey( CryptoCore::generateChallenge() );
+
+	QVector<QUdpSocket *> receivers;
+	QVector<DemoMulticastStream> streams( receiverCount );
+	quint16 port = 0;
+
+	for( int i = 0; i < receiverCount; ++i )
+	{
+		auto receiver = new QUdpSocket;
+		if( receiver->bind( QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint ) == false ||
+			receiver->joinMulticastGroup( group ) == false )
+		{
+			CommandLineIO::error( QStringLiteral("could not join multicast group: %1").arg( receiver->errorString() ) );
+			delete receiver;
+			qDeleteAll( receivers );
+			return CommandLinePluginInterface::Failed;
+		}
+		receiver->setSocketOption( QAbstractSocket::ReceiveBufferSizeSocketOption, 4*1024*1024 );
+		port = receiver->localPort();
+		receivers.append( receiver );
+		streams[i].setKey( key );
+		streams[i].reset( 0 );
+	}
+
+	QUdpSocket sender;
+	sender.bind( QHostAddress::AnyIPv4, 0 );
+	sender.setSocketOption( QAbstractSocket::MulticastTtlOption, 1 );
+	sender.setSocketOption( QAbstractSocket::MulticastLoopbackOption, 1 );
+
+	// deterministic pseudo random numbers for reproducible loss patterns
+	quint32 random = 1;
+
+	qint64 multicastBytes = 0;
+	qint64 repairBytes = 0;
+	int repairedMessages = 0;
+	int deliveredMessages = 0;
+	int corruptedMessages = 0;
+	int skippedMessages = 0;
+
+	const auto receiveAll = [&]( bool repair ) {
+		for( int r = 0; r < receiverCount; ++r )
+		{
+			auto receiver = receivers[r];
+			auto& stream = streams[r];
+
+			while( receiver->hasPendingDatagrams() || receiver->waitForReadyRead( ReceiveTimeout ) )
+			{
+				QByteArray datagram( static_cast<int>( receiver->pendingDatagramSize() ), 0 );
+				receiver->readDatagram( datagram.data(), datagram.size() );
+
+				random = random * 1103515245 + 12345;
+				if( int( ( random >> 16 ) % 100 ) >= lossPercent )
+				{
+					stream.addDatagram( datagram );
+				}
+			}
+
+			if( repair )
+			{
+				// repaired messages would be sent by the demo server via TCP
+				for( const auto sequence : stream.missingSequences( MaximumRepairSequences ) )
+				{
+					stream.addMessage( sequence, messages[int(sequence)] );
+					repairBytes += DemoMulticastStream::RepairedMessageHeaderSize + messages[int(sequence)].size();
+					++repairedMessages;
+				}
+			}
+
+			auto expectedSequence = stream.nextSequence();
+			QByteArray message;
+			while( stream.takeMessage( message ) )
+			{
+				const auto sequence = stream.nextSequence() - 1;
+				skippedMessages += int( sequence - expectedSequence );
+				expectedSequence = sequence + 1;
+				if( message != messages[int(sequence)] )
+				{
+					++corruptedMessages;
+				}
+				++deliveredMessages;
+			}
+		}
+	};
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for( int i = 0; i < messageCount; ++i )
+	{
+		// datagrams of other senders in the network must never corrupt the stream
+		if( i % KeyFrameInterval == 1 )
+		{
+			for( const auto& datagram : DemoMulticastStream::packetize( forgeryKey, DemoMulticastStream::Sequence(i), true,
+																		 QByteArray( 64, 'f' ) ) )
+			{
+				sender.writeDatagram( datagram, group, port );
+			}
+		}
+
+		const auto datagrams = DemoMulticastStream::packetize( key, DemoMulticastStream::Sequence(i), i % KeyFrameInterval == 0, messages[i] );
+		for( const auto& datagram : datagrams )
+		{
+			sender.writeDatagram( datagram, group, port );
+			multicastBytes += datagram.size();
+		}
+
+		receiveAll( true );
+	}
+
+	// announce end of stream so trailing losses can be detected and repaired
+	sender.writeDatagram( DemoMulticastStream::heartbeat( key, DemoMulticastStream::Sequence(messageCount) ), group, port );
+	receiveAll( true );
+	receiveAll( false );
+
+	const auto elapsed = timer.elapsed();
+
+	qDeleteAll( receivers );
+
+	qint64 unicastBytes = 0;
+	for( const auto& message : qAsConst(messages) )
+	{
+		unicastBytes += message.size();
+	}
+	unicastBytes *= receiverCount;
+
+	printf( "[TEST]: DemoMulticast: %d receivers, %d messages, %d%% loss, %d ms\n",
+			receiverCount, messageCount, lossPercent, int(elapsed) );
+	printf( "[TEST]: DemoMulticast: delivered %d of %d messages, %d corrupted, %d skipped\n",
+			deliveredMessages, messageCount * receiverCount, corruptedMessages, skippedMessages );
+	printf( "[TEST]: DemoMulticast: uplink %.1f MB multicast + %.1f MB repairs (%d messages) vs. %.1f MB unicast\n",
+			double(multicastBytes) / 1e6, double(repairBytes) / 1e6, repairedMessages, double(unicastBytes) / 1e6 );
+
+	return deliveredMessages == messageCount * receiverCount && corruptedMessages == 0 ?
+				CommandLinePluginInterface::Successful : CommandLinePluginInterface::Failed;
+}
@@ -0,0 +1,47 @@
+/*
+ * DemoBenchmarks.h - benchmarks for demo stream distribution
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "CommandLinePluginInterface.h"
+
+class DemoBenchmarks
+{
+public:
+	static CommandLinePluginInterface::RunResult benchmarkUpdates( const QStringList& arguments );
+	static CommandLinePluginInterface::RunResult benchmarkFanout( const QStringList& arguments );
+	static CommandLinePluginInterface::RunResult testMulticast( const QStringList& arguments );
+
+private:
+	static constexpr int FanoutFramebufferWidth = 1024;
+	static constexpr int FanoutFramebufferHeight = 768;
+
+	static qint64 benchmarkClients( int clients, const std::function<void()>& server,
+									const std::function<qint64()>& client, qint64& bytes );
+	static bool measureFanout( int clients, int threads, const QVector<QByteArray>& messages,
+							   double& throughput, double& cpuLoad );
+
+} ;
@@ -23,19 +23,28 @@
  */
 
 #include <QApplication>
+#include <QHostAddress>
 #include <QDesktopWidget>
 #include <QIcon>
 #include <QLayout>
 
 #include "DemoClient.h"
+#include "DemoConfiguration.h"
+#include "DemoMulticastClient.h"
 #include "VeyonConfiguration.h"
 #include "LockWidget.h"
 #include "PlatformCoreFunctions.h"
+#include "VncConnection.h"
 #include "VncViewWidget.h"
 
 
-DemoClient::DemoClient( const QString& host, int port, bool fullscreen, const QRect& viewport, QObject* parent ) :
+DemoClient::DemoClient( const DemoServerAddressList& servers, bool fullscreen,
+						const DemoAuthentication& authentication, const DemoConfiguration& configuration,
+						QObject* parent ) :
 	QObject( parent ),
+	m_authentication( authentication ),
+	m_multicastEnabled( configuration.multicastEnabled() ),
+	m_servers( servers ),
 	m_toplevel( nullptr )
 {
 	if( fullscreen )
@@ -57,17 +66,21 @@ DemoClient::DemoClient( const QString& host, int port, bool fullscreen, const QR
 		m_toplevel->resize( QApplication::desktop()->availableGeometry( m_toplevel ).size() - QSize( 10, 30 ) );
 	}
 
-	m_vncView = new VncViewWidget( host, port, m_toplevel, VncView::DemoMode, viewport );
-
 	auto toplevelLayout = new QVBoxLayout;
 	toplevelLayout->setContentsMargins( 0, 0, 0, 0 );
 	toplevelLayout->setSpacing( 0 );
-	toplevelLayout->addWidget( m_vncView );
 
 	m_toplevel->setLayout( toplevelLayout );
 
 	connect( m_toplevel, &QObject::destroyed, this, &DemoClient::viewDestroyed );
-	connect( m_vncView, &VncViewWidget::sizeHintChanged, this, &DemoClient::resizeToplevelWidget );
+
+	// continue with the next demo server (usually the upstream server of a relay)
+	// if the current one can't be reached for a while
+	m_failoverTimer.setSingleShot( true );
+	m_failoverTimer.setInterval( FailoverTimeout );
+	connect( &m_failoverTimer, &QTimer::timeout, this, &DemoClient::connectToNextServer );
+
+	connectToServer();
 
 	m_toplevel->move( 0, 0 );
 	if( fullscreen )
@@ -95,6 +108,92 @@ DemoClient::~DemoClient()
 
 
 
+void DemoClient::connectToServer()
+{
+	const auto server = m_servers.value( m_currentServer );
+
+	if( m_multicastClient )
+	{
+		m_multicastClient->disconnect( this );
+		m_multicastClient->deleteLater();
+		m_multicastClient = nullptr;
+	}
+
+	if( m_multicastEnabled )
+	{
+		// receive updates via multicast and serve them to a local view, connect
+		// to the demo server directly if the multicast client can't be set up
+		m_multicastClient = new DemoMulticastClient( server.host, server.port, m_authentication, this );
+		connect( m_multicastClient, &DemoMulticastClient::ready, this, [this]( int localPort ) {
+			createView( QHostAddress( QHostAddress::LocalHost ).toString(), localPort );
+		} );
+		connect( m_multicastClient, &DemoMulticastClient::failed, this, [this, server]() {
+			m_multicastClient->deleteLater();
+			m_multicastClient = nullptr;
+			createView( server.host, server.port );
+		} );
+	}
+	else
+	{
+		createView( server.host, server.port );
+	}
+}
+
+
+
+void DemoClient::connectToNextServer()
+{
+	m_currentServer = ( m_currentServer + 1 ) % m_servers.size();
+
+	vDebug() << "switching to demo server" << m_servers[m_currentServer].host << m_servers[m_currentServer].port;
+
+	connectToServer();
+}
+
+
+
+void DemoClient::createView( const QString& host, int port )
+{
+	if( m_toplevel == nullptr )
+	{
+		return;
+	}
+
+	delete m_vncView;
+
+	m_vncView = new VncViewWidget( host, port, m_toplevel, VncView::DemoMode );
+	m_toplevel->layout()->addWidget( m_vncView );
+
+	connect( m_vncView, &VncViewWidget::sizeHintChanged, this, &DemoClient::resizeToplevelWidget );
+
+	if( m_servers.size() > 1 )
+	{
+		connect( m_vncView->connection(), &VncConnection::stateChanged, this, &DemoClient::updateConnectionState );
+		m_failoverTimer.start();
+	}
+}
+
+
+
+void DemoClient::updateConnectionState()
+{
+	if( m_vncView == nullptr )
+	{
+		return;
+	}
+
+	if( m_vncView->connection()->state() == VncConnection::State::Connected )
+	{
+		m_failoverTimer.stop();
+	}
+	else if( m_failoverTimer.isActive() == false )
+	{
+		m_failoverTimer.start();
+	}
+}
+
+
+
 void DemoClient::viewDestroyed( QObject* obj )
 {
 	// prevent double deletion of toplevel widget
@@ -110,6 +209,11 @@ void DemoClient::viewDestroyed( QObject* obj )
 
 void DemoClient::resizeToplevelWidget()
 {
+	if( m_vncView == nullptr )
+	{
+		return;
+	}
+
 	if( m_toplevel->windowState() & Qt::WindowFullScreen )
 	{
 		m_vncView->resize( m_toplevel->size() );
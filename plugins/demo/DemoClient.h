@@ -24,22 +24,45 @@
 
 #pragma once
 
-#include <QObject>
+#include <QTimer>
 
+#include "DemoServerAddress.h"
+
+class DemoAuthentication;
+class DemoConfiguration;
+class DemoMulticastClient;
 class VncViewWidget;
 
 class DemoClient : public QObject
 {
 	Q_OBJECT
 public:
-	DemoClient( const QString& host, int port, bool fullscreen, const QRect& viewport, QObject* parent = nullptr );
+	// servers following the first one are only used if the connection fails
+	DemoClient( const DemoServerAddressList& servers, bool fullscreen,
+				const DemoAuthentication& authentication, const DemoConfiguration& configuration,
+				QObject* parent = nullptr );
 	~DemoClient() override;
 
 private:
+	void connectToServer();
+	void connectToNextServer();
+	void createView( const QString& host, int port );
+	void updateConnectionState();
 	void viewDestroyed( QObject* obj );
 	void resizeToplevelWidget();
 
+	static constexpr int FailoverTimeout = 5000;
+
+	const DemoAuthentication& m_authentication;
+	const bool m_multicastEnabled;
+
+	const DemoServerAddressList m_servers;
+	int m_currentServer{0};
+
 	QWidget* m_toplevel;
-	VncViewWidget* m_vncView;
+	VncViewWidget* m_vncView{nullptr};
+	DemoMulticastClient* m_multicastClient{nullptr};
+
+	QTimer m_failoverTimer{this};
 
 } ;
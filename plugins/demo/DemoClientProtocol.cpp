@@ -0,0 +1,234 @@
+/*
+ * DemoClientProtocol.cpp - implementation of DemoClientProtocol class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include "DemoAuthentication.h"
+#include "DemoClientProtocol.h"
+#include "FeatureMessage.h"
+#include "PlatformUserFunctions.h"
+#include "VariantArrayMessage.h"
+
+
+DemoClientProtocol::DemoClientProtocol( const DemoAuthentication& authentication, QTcpSocket* socket ) :
+	m_authentication( authentication ),
+	m_socket( socket )
+{
+}
+
+
+
+void DemoClientProtocol::start()
+{
+	m_state = State::Protocol;
+	m_serverInitMessage.clear();
+}
+
+
+
+bool DemoClientProtocol::read() // Flawfinder: ignore
+{
+	switch( m_state )
+	{
+	case State::Protocol:
+		return receiveProtocol();
+
+	case State::SecurityTypes:
+		return receiveSecurityTypes();
+
+	case State::AuthenticationMethods:
+		return receiveAuthenticationMethods();
+
+	case State::AuthenticationAck:
+		return receiveAuthenticationAck();
+
+	case State::SecurityResult:
+		return receiveSecurityResult();
+
+	case State::ServerInit:
+		return receiveServerInitMessage();
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+
+
+bool DemoClientProtocol::receiveProtocol()
+{
+	if( m_socket->bytesAvailable() < sz_rfbProtocolVersionMsg )
+	{
+		return false;
+	}
+
+	m_socket->read( sz_rfbProtocolVersionMsg );
+	m_socket->write( QByteArrayLiteral("RFB 003.008\n") );
+
+	m_state = State::SecurityTypes;
+
+	return true;
+}
+
+
+
+bool DemoClientProtocol::receiveSecurityTypes()
+{
+	char securityTypeCount = 0;
+	if( m_socket->peek( &securityTypeCount, sizeof(securityTypeCount) ) != sizeof(securityTypeCount) ||
+		m_socket->bytesAvailable() < 1 + securityTypeCount )
+	{
+		return false;
+	}
+
+	const auto securityTypes = m_socket->read( 1 + securityTypeCount ).mid( 1 );
+	if( securityTypes.contains( VeyonCore::RfbSecurityTypeVeyon ) == false )
+	{
+		return fail( "demo server does not support Veyon security type" );
+	}
+
+	const char securityType = VeyonCore::RfbSecurityTypeVeyon;
+	m_socket->write( &securityType, sizeof(securityType) );
+
+	m_state = State::AuthenticationMethods;
+
+	return true;
+}
+
+
+
+bool DemoClientProtocol::receiveAuthenticationMethods()
+{
+	VariantArrayMessage message( m_socket );
+	if( message.isReadyForReceive() == false || message.receive() == false )
+	{
+		return false;
+	}
+
+	const auto authMethodCount = message.read().toInt();
+
+	PluginUidList authMethodUids;
+	for( int i = 0; i < authMethodCount; ++i )
+	{
+		authMethodUids.append( message.read().toUuid() );
+	}
+
+	if( authMethodUids.contains( m_authentication.pluginUid() ) == false )
+	{
+		return fail( "demo server does not support demo authentication" );
+	}
+
+	VariantArrayMessage( m_socket )
+			.write( m_authentication.pluginUid() )
+			.write( VeyonCore::platform().userFunctions().currentUser() )
+			.write( static_cast<int>( FeatureMessage::LatestCodec ) )
+			.send();
+
+	m_state = State::AuthenticationAck;
+
+	return true;
+}
+
+
+
+bool DemoClientProtocol::receiveAuthenticationAck()
+{
+	VariantArrayMessage message( m_socket );
+	if( message.isReadyForReceive() == false || message.receive() == false )
+	{
+		return false;
+	}
+
+	m_authentication.authenticate( m_socket );
+
+	m_state = State::SecurityResult;
+
+	return true;
+}
+
+
+
+bool DemoClientProtocol::receiveSecurityResult()
+{
+	if( m_socket->bytesAvailable() < qint64( sizeof(uint32_t) ) )
+	{
+		return false;
+	}
+
+	uint32_t authResult = 0;
+	m_socket->read( reinterpret_cast<char *>( &authResult ), sizeof(authResult) );
+
+	if( qFromBigEndian( authResult ) != rfbVncAuthOK )
+	{
+		return fail( "authentication at demo server failed" );
+	}
+
+	const rfbClientInitMsg clientInitMessage{ 1 };
+	m_socket->write( reinterpret_cast<const char *>( &clientInitMessage ), sz_rfbClientInitMsg );
+
+	m_state = State::ServerInit;
+
+	return true;
+}
+
+
+
+bool DemoClientProtocol::receiveServerInitMessage()
+{
+	if( m_socket->bytesAvailable() < sz_rfbServerInitMsg )
+	{
+		return false;
+	}
+
+	rfbServerInitMsg serverInitMessage;
+	m_socket->peek( reinterpret_cast<char *>( &serverInitMessage ), sz_rfbServerInitMsg );
+
+	const auto totalSize = sz_rfbServerInitMsg + qint64( qFromBigEndian( serverInitMessage.nameLength ) );
+	if( m_socket->bytesAvailable() < totalSize )
+	{
+		return false;
+	}
+
+	m_serverInitMessage = m_socket->read( totalSize );
+
+	m_state = State::Running;
+
+	return true;
+}
+
+
+
+bool DemoClientProtocol::fail( const char* reason )
+{
+	vWarning() << reason;
+
+	m_state = State::Failed;
+
+	return false;
+}
@@ -0,0 +1,82 @@
+/*
+ * DemoClientProtocol.h - declaration of DemoClientProtocol class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+
+class DemoAuthentication;
+class QTcpSocket;
+
+// client side of the handshake with a demo server, i.e. protocol negotiation,
+// demo token authentication and framebuffer initialization
+class DemoClientProtocol
+{
+public:
+	enum class State
+	{
+		Disconnected,
+		Protocol,
+		SecurityTypes,
+		AuthenticationMethods,
+		AuthenticationAck,
+		SecurityResult,
+		ServerInit,
+		Running,
+		Failed
+	};
+
+	DemoClientProtocol( const DemoAuthentication& authentication, QTcpSocket* socket );
+
+	State state() const
+	{
+		return m_state;
+	}
+
+	void start();
+	bool read();  // Flawfinder: ignore
+
+	const QByteArray& serverInitMessage() const
+	{
+		return m_serverInitMessage;
+	}
+
+private:
+	bool receiveProtocol();
+	bool receiveSecurityTypes();
+	bool receiveAuthenticationMethods();
+	bool receiveAuthenticationAck();
+	bool receiveSecurityResult();
+	bool receiveServerInitMessage();
+
+	bool fail( const char* reason );
+
+	const DemoAuthentication& m_authentication;
+	QTcpSocket* m_socket;
+
+	State m_state{State::Disconnected};
+
+	QByteArray m_serverInitMessage{};
+
+} ;
@@ -32,6 +32,16 @@
 	OP( DemoConfiguration, m_configuration, int, framebufferUpdateInterval, setFramebufferUpdateInterval, "FramebufferUpdateInterval", "Demo", 100, Configuration::Property::Flag::Advanced )	\
 	OP( DemoConfiguration, m_configuration, int, keyFrameInterval, setKeyFrameInterval, "KeyFrameInterval", "Demo", 10, Configuration::Property::Flag::Advanced )	\
 	OP( DemoConfiguration, m_configuration, int, memoryLimit, setMemoryLimit, "MemoryLimit", "Demo", 128, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, maximumClientLag, setMaximumClientLag, "MaximumClientLag", "Demo", 3000, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, bool, lossyEncoding, setLossyEncoding, "LossyEncoding", "Demo", false, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, jpegQuality, setJpegQuality, "JpegQuality", "Demo", 70, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, encodingCpuBudget, setEncodingCpuBudget, "EncodingCpuBudget", "Demo", 50, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, bandwidthLimit, setBandwidthLimit, "BandwidthLimit", "Demo", 0, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, bool, multicastEnabled, setMulticastEnabled, "MulticastEnabled", "Demo", false, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, QString, multicastGroupAddress, setMulticastGroupAddress, "MulticastGroupAddress", "Demo", QStringLiteral("239.255.86.86"), Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, multicastTimeToLive, setMulticastTimeToLive, "MulticastTimeToLive", "Demo", 1, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, bool, relayEnabled, setRelayEnabled, "RelayEnabled", "Demo", false, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, relayFanOut, setRelayFanOut, "RelayFanOut", "Demo", 8, Configuration::Property::Flag::Advanced )	\
 
 // clazy:excludeall=missing-qobject-macro
 
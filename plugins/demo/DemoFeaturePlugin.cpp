@@ -22,11 +22,16 @@
  *
  */
 
+#include <algorithm>
+
+#include <QLabel>
 #include <QMessageBox>
 #include <QScreen>
+#include <QStatusBar>
 
 #include "AuthenticationCredentials.h"
 #include "Computer.h"
+#include "DemoBenchmarks.h"
 #include "DemoClient.h"
 #include "DemoConfigurationPage.h"
 #include "DemoFeaturePlugin.h"
@@ -37,6 +42,7 @@
 #include "VeyonConfiguration.h"
 #include "VeyonMasterInterface.h"
 #include "VeyonServerInterface.h"
+#include "VeyonWorkerInterface.h"
 
 
 DemoFeaturePlugin::DemoFeaturePlugin( QObject* parent ) :
@@ -104,7 +110,12 @@ DemoFeaturePlugin::DemoFeaturePlugin( QObject* parent ) :
 		m_shareOwnScreenFullScreenFeature, m_shareOwnScreenWindowFeature,
 		m_shareUserScreenFullScreenFeature, m_shareUserScreenWindowFeature
 	} ),
-	m_configuration( &VeyonCore::config() )
+	m_configuration( &VeyonCore::config() ),
+	m_commands( {
+{ QStringLiteral("benchmarkupdates"), QStringLiteral( "measure distribution of demo framebuffer updates to many clients with arguments [CLIENTS] [MESSAGES]" ) },
+{ QStringLiteral("benchmarkfanout"), QStringLiteral( "measure throughput and CPU load of demo server connections to loopback clients served from one thread each vs. few I/O threads with arguments [MAXCLIENTS] [MESSAGES] [IOTHREADS]" ) },
+{ QStringLiteral("testmulticast"), QStringLiteral( "send demo framebuffer updates to receivers via loopback multicast with simulated loss and repair with arguments [RECEIVERS] [MESSAGES] [LOSS PERCENT] [GROUP ADDRESS]" ) },
+				} )
 {
 	connect( qGuiApp, &QGuiApplication::screenAdded, this, &DemoFeaturePlugin::addScreen );
 	connect( qGuiApp, &QGuiApplication::screenRemoved, this, &DemoFeaturePlugin::removeScreen );
@@ -137,6 +148,8 @@ bool DemoFeaturePlugin::controlFeature( Feature::Uid featureUid,
 bool DemoFeaturePlugin::startFeature( VeyonMasterInterface& master, const Feature& feature,
 									 const ComputerControlInterfaceList& computerControlInterfaces )
 {
+	m_master = &master;
+
 	if( feature == m_shareOwnScreenWindowFeature || feature == m_shareOwnScreenFullScreenFeature )
 	{
 		// start demo server
@@ -242,6 +255,8 @@ bool DemoFeaturePlugin::stopFeature( VeyonMasterInterface& master, const Feature
 
 			controlFeature( m_demoServerFeature.uid(), Operation::Stop, {}, computerControlInterfaces );
 
+			updateLaggingClientsIndicator( {} );
+
 			// reset demo access token
 			initializeCredentials();
 		}
@@ -254,14 +269,41 @@ bool DemoFeaturePlugin::stopFeature( VeyonMasterInterface& master, const Feature
 
 
 
+bool DemoFeaturePlugin::handleFeatureMessage( ComputerControlInterface::Pointer computerControlInterface,
+											 const FeatureMessage& message )
+{
+	Q_UNUSED(computerControlInterface)
+
+	if( message.featureUid() == m_demoServerFeature.uid() &&
+		message.command() == ReportLaggingClients )
+	{
+		updateLaggingClientsIndicator( message.argument( Argument::LaggingClients ).toStringList() );
+		return true;
+	}
+
+	return false;
+}
+
+
+
 bool DemoFeaturePlugin::handleFeatureMessage( VeyonServerInterface& server,
 											 const MessageContext& messageContext,
 											 const FeatureMessage& message )
 {
 	if( message.featureUid() == m_demoServerFeature.uid() )
 	{
-		if( message.command() == StartDemoServer )
+		if( message.command() == ReportLaggingClients )
 		{
+			// forward report of demo server worker to master unless it disconnected in the meantime
+			if( m_demoServerRequester.ioDevice() )
+			{
+				server.sendFeatureMessageReply( m_demoServerRequester, message );
+			}
+		}
+		else if( message.command() == StartDemoServer )
+		{
+			m_demoServerRequester = messageContext;
+
 			// add VNC server password to message
 			server.featureWorkerManager().
 				sendMessageToManagedSystemWorker(
@@ -269,8 +311,16 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonServerInterface& server,
 						.addArgument( Argument::VncServerPassword, VeyonCore::authenticationCredentials().internalVncServerPassword().toByteArray() )
 						.addArgument( Argument::VncServerPort, server.vncServerBasePort() + message.argument(Argument::VncServerPortOffset).toInt() ) );
 		}
-		else if( message.command() != StopDemoServer ||
-				 server.featureWorkerManager().isWorkerRunning( m_demoServerFeature.uid() ) )
+		else if( message.command() == StopDemoServer )
+		{
+			m_demoServerRequester = MessageContext( nullptr );
+
+			if( server.featureWorkerManager().isWorkerRunning( m_demoServerFeature.uid() ) )
+			{
+				server.featureWorkerManager().sendMessageToManagedSystemWorker( message );
+			}
+		}
+		else
 		{
 			// forward message to worker
 			server.featureWorkerManager().sendMessageToManagedSystemWorker( message );
@@ -305,13 +355,24 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonServerInterface& server,
 			return false;
 		}
 
-		if( message.command() == StartDemoClient &&
-			message.argument( Argument::DemoServerHost ).toString().isEmpty() )
+		if( message.command() == StartDemoClient )
 		{
-			// set the peer address as demo server host
+			// set the peer address as host of all demo servers without host
+			const auto peerAddress = socket->peerAddress().toString();
+
+			auto demoServerHost = message.argument( Argument::DemoServerHost ).toString();
+			if( demoServerHost.isEmpty() )
+			{
+				demoServerHost = peerAddress;
+			}
+
+			auto fallbackServerHosts = message.argument( Argument::FallbackServerHosts ).toStringList();
+			std::replace( fallbackServerHosts.begin(), fallbackServerHosts.end(), QString{}, peerAddress );
+
 			server.featureWorkerManager().sendMessageToManagedSystemWorker(
 				FeatureMessage{ message }
-					.addArgument( Argument::DemoServerHost, socket->peerAddress().toString() ) );
+					.addArgument( Argument::DemoServerHost, demoServerHost )
+					.addArgument( Argument::FallbackServerHosts, fallbackServerHosts ) );
 		}
 		else
 		{
@@ -329,8 +390,6 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonServerInterface& server,
 
 bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message )
 {
-	Q_UNUSED(worker)
-
 	if( message.featureUid() == m_demoServerFeature.uid() )
 	{
 		switch( message.command() )
@@ -345,7 +404,13 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 											   *this,
 											   m_configuration,
 											   message.argument( Argument::DemoServerPort ).toInt(),
+											   message.argument( Argument::Viewport ).toRect(),
 											   this );
+
+				connect( m_demoServer, &DemoServer::laggingClientsChanged, this, [this, &worker]( const QStringList& clients ) {
+					worker.sendFeatureMessageReply( FeatureMessage{ m_demoServerFeature.uid(), ReportLaggingClients }
+														.addArgument( Argument::LaggingClients, clients ) );
+				} );
 			}
 			return true;
 
@@ -374,10 +439,28 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 				const auto demoServerHost = message.argument( Argument::DemoServerHost ).toString();
 				const auto demoServerPort = message.argument( Argument::DemoServerPort ).toInt();
 				const auto isFullscreenDemo = message.featureUid() == m_demoClientFullScreenFeature.uid();
-				const auto viewport = message.argument( Argument::Viewport ).toRect();
+
+				DemoServerAddressList servers{ { demoServerHost, demoServerPort } };
+
+				const auto fallbackServerHosts = message.argument( Argument::FallbackServerHosts ).toStringList();
+				const auto fallbackServerPorts = message.argument( Argument::FallbackServerPorts ).toList();
+				for( int i = 0; i < fallbackServerHosts.size() && i < fallbackServerPorts.size(); ++i )
+				{
+					servers.append( { fallbackServerHosts[i], fallbackServerPorts[i].toInt() } );
+				}
+
+				const auto relayServerPort = message.argument( Argument::RelayServerPort ).toInt();
+				if( relayServerPort > 0 )
+				{
+					vDebug() << "relaying stream on port" << relayServerPort;
+
+					// serve neighbouring computers and view the demo through the relay as well
+					m_demoRelay = new DemoServer( servers, *this, m_configuration, relayServerPort, this );
+					servers.prepend( { QHostAddress( QHostAddress::LocalHost ).toString(), relayServerPort } );
+				}
 
 				vDebug() << "connecting with master" << demoServerHost;
-				m_demoClient = new DemoClient( demoServerHost, demoServerPort, isFullscreenDemo, viewport );
+				m_demoClient = new DemoClient( servers, isFullscreenDemo, *this, m_configuration );
 			}
 			return true;
 
@@ -385,6 +468,9 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 			delete m_demoClient;
 			m_demoClient = nullptr;
 
+			delete m_demoRelay;
+			m_demoRelay = nullptr;
+
 			QCoreApplication::quit();
 
 			return true;
@@ -406,6 +492,67 @@ ConfigurationPage* DemoFeaturePlugin::createConfigurationPage()
 
 
 
+QStringList DemoFeaturePlugin::commands() const
+{
+	return m_commands.keys();
+}
+
+
+
+QString DemoFeaturePlugin::commandHelp( const QString& command ) const
+{
+	return m_commands.value( command );
+}
+
+
+
+CommandLinePluginInterface::RunResult DemoFeaturePlugin::handle_benchmarkupdates( const QStringList& arguments )
+{
+	return DemoBenchmarks::benchmarkUpdates( arguments );
+}
+
+
+
+CommandLinePluginInterface::RunResult DemoFeaturePlugin::handle_benchmarkfanout( const QStringList& arguments )
+{
+	return DemoBenchmarks::benchmarkFanout( arguments );
+}
+
+
+
+CommandLinePluginInterface::RunResult DemoFeaturePlugin::handle_testmulticast( const QStringList& arguments )
+{
+	return DemoBenchmarks::testMulticast( arguments );
+}
+
+
+
+void DemoFeaturePlugin::updateLaggingClientsIndicator( const QStringList& clients )
+{
+	if( m_laggingClientsIndicator.isNull() )
+	{
+		if( clients.isEmpty() || m_master == nullptr || m_master->mainWindow() == nullptr )
+		{
+			return;
+		}
+
+		auto statusBar = m_master->mainWindow()->findChild<QStatusBar *>();
+		if( statusBar == nullptr )
+		{
+			return;
+		}
+
+		m_laggingClientsIndicator = new QLabel( statusBar );
+		statusBar->addPermanentWidget( m_laggingClientsIndicator );
+	}
+
+	m_laggingClientsIndicator->setText( tr( "Demo clients lagging behind: %1" ).arg( clients.count() ) );
+	m_laggingClientsIndicator->setToolTip( clients.join( QLatin1Char('\n') ) );
+	m_laggingClientsIndicator->setVisible( clients.isEmpty() == false );
+}
+
+
+
 void DemoFeaturePlugin::addScreen( QScreen* screen )
 {
 	m_screens = QGuiApplication::screens();
@@ -523,6 +670,25 @@ QRect DemoFeaturePlugin::viewportFromScreenSelection() const
 
 
 
+QRect DemoFeaturePlugin::viewportFromArguments( const QVariantMap& arguments ) const
+{
+	const QRect viewport{
+		arguments.value( argToString(Argument::ViewportX) ).toInt(),
+		arguments.value( argToString(Argument::ViewportY) ).toInt(),
+		arguments.value( argToString(Argument::ViewportWidth) ).toInt(),
+		arguments.value( argToString(Argument::ViewportHeight) ).toInt()
+	};
+
+	if( viewport.isNull() || viewport.isEmpty() )
+	{
+		return viewportFromScreenSelection();
+	}
+
+	return viewport;
+}
+
+
+
 bool DemoFeaturePlugin::controlDemoServer( Operation operation, const QVariantMap& arguments,
 										  const ComputerControlInterfaceList& computerControlInterfaces )
 {
@@ -538,7 +704,8 @@ bool DemoFeaturePlugin::controlDemoServer( Operation operation, const QVariantMa
 		sendFeatureMessage( FeatureMessage{ m_demoServerFeature.uid(), StartDemoServer }
 								.addArgument( Argument::DemoAccessToken, demoAccessToken )
 								.addArgument( Argument::VncServerPortOffset, vncServerPortOffset )
-								.addArgument( Argument::DemoServerPort, demoServerPort ),
+								.addArgument( Argument::DemoServerPort, demoServerPort )
+								.addArgument( Argument::Viewport, viewportFromArguments( arguments ) ),
 							computerControlInterfaces );
 
 		return true;
@@ -568,18 +735,6 @@ bool DemoFeaturePlugin::controlDemoClient( Feature::Uid featureUid, Operation op
 		const auto demoServerPort = arguments.value( argToString(Argument::DemoServerPort),
 													 VeyonCore::config().demoServerPort() + VeyonCore::sessionId() ).toInt();
 
-		QRect viewport{
-			arguments.value( argToString(Argument::ViewportX) ).toInt(),
-			arguments.value( argToString(Argument::ViewportY) ).toInt(),
-			arguments.value( argToString(Argument::ViewportWidth) ).toInt(),
-			arguments.value( argToString(Argument::ViewportHeight) ).toInt()
-		};
-
-		if( viewport.isNull() || viewport.isEmpty() )
-		{
-			viewport = viewportFromScreenSelection();
-		}
-
 		const auto disableUpdates = m_configuration.slowDownThumbnailUpdates();
 
 		for( const auto& computerControlInterface : computerControlInterfaces )
@@ -591,12 +746,19 @@ bool DemoFeaturePlugin::controlDemoClient( Feature::Uid featureUid, Operation op
 			}
 		}
 
-		sendFeatureMessage( FeatureMessage{ featureUid, StartDemoClient }
-								.addArgument( Argument::DemoAccessToken, demoAccessToken )
-								.addArgument( Argument::DemoServerHost, demoServerHost )
-								.addArgument( Argument::DemoServerPort, demoServerPort )
-								.addArgument( Argument::Viewport, viewport ),
-							computerControlInterfaces );
+		FeatureMessage message{ featureUid, StartDemoClient };
+		message.addArgument( Argument::DemoAccessToken, demoAccessToken )
+			   .addArgument( Argument::DemoServerHost, demoServerHost )
+			   .addArgument( Argument::DemoServerPort, demoServerPort );
+
+		if( m_configuration.relayEnabled() )
+		{
+			startDemoClientsViaRelays( message, { demoServerHost, demoServerPort }, computerControlInterfaces );
+		}
+		else
+		{
+			sendFeatureMessage( message, computerControlInterfaces );
+		}
 
 		return true;
 	}
@@ -623,4 +785,74 @@ bool DemoFeaturePlugin::controlDemoClient( Feature::Uid featureUid, Operation op
 }
 
 
+
+void DemoFeaturePlugin::startDemoClientsViaRelays( const FeatureMessage& message, const DemoServerAddress& demoServer,
+												   const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	const auto fanOut = qMax( 2, m_configuration.relayFanOut() );
+
+	// build a separate tree for each location as relays should be close to their clients
+	QMap<QString, ComputerControlInterfaceList> locations;
+	for( const auto& computerControlInterface : computerControlInterfaces )
+	{
+		locations[computerControlInterface->computer().location()].append( computerControlInterface );
+	}
+
+	for( const auto& clients : qAsConst(locations) )
+	{
+		// node n receives the stream from node (n-1)/fanOut with node 0 being the demo server
+		DemoServerAddressList nodes{ demoServer };
+		nodes.reserve( clients.size() + 1 );
+		for( const auto& client : clients )
+		{
+			const auto hostAddress = client->computer().hostAddress();
+			nodes.append( { HostAddress::parseHost( hostAddress ), relayServerPort( hostAddress ) } );
+		}
+
+		for( int n = 1; n < nodes.size(); ++n )
+		{
+			const auto upstream = ( n - 1 ) / fanOut;
+
+			// clients continue with the next ancestor if their relay drops out
+			QStringList fallbackServerHosts;
+			QVariantList fallbackServerPorts;
+			for( auto ancestor = upstream; ancestor > 0; )
+			{
+				ancestor = ( ancestor - 1 ) / fanOut;
+				fallbackServerHosts.append( nodes[ancestor].host );
+				fallbackServerPorts.append( nodes[ancestor].port );
+			}
+
+			FeatureMessage clientMessage{ message };
+			clientMessage.addArgument( Argument::DemoServerHost, nodes[upstream].host )
+						 .addArgument( Argument::DemoServerPort, nodes[upstream].port )
+						 .addArgument( Argument::FallbackServerHosts, fallbackServerHosts )
+						 .addArgument( Argument::FallbackServerPorts, fallbackServerPorts );
+
+			// nodes with children relay the stream
+			if( n * fanOut + 1 < nodes.size() )
+			{
+				clientMessage.addArgument( Argument::RelayServerPort, nodes[n].port );
+			}
+
+			sendFeatureMessage( clientMessage, { clients[n-1] } );
+		}
+	}
+}
+
+
+
+int DemoFeaturePlugin::relayServerPort( const QString& hostAddress )
+{
+	// relays listen on the demo server port of the session they're running in
+	const auto primaryServerPort = HostAddress::parsePortNumber( hostAddress );
+	if( primaryServerPort > 0 )
+	{
+		return VeyonCore::config().demoServerPort() + primaryServerPort - VeyonCore::config().veyonServerPort();
+	}
+
+	return VeyonCore::config().demoServerPort();
+}
+
+
 IMPLEMENT_CONFIG_PROXY(DemoConfiguration)
@@ -25,25 +25,31 @@
 #pragma once
 
 #include <QGuiApplication>
+#include <QPointer>
 
 #include "AuthenticationPluginInterface.h"
+#include "CommandLinePluginInterface.h"
 #include "ConfigurationPagePluginInterface.h"
 #include "DemoAuthentication.h"
 #include "DemoConfiguration.h"
+#include "DemoServerAddress.h"
 #include "FeatureProviderInterface.h"
 
+class QLabel;
 class QScreen;
 
 class DemoServer;
 class DemoClient;
 
-class DemoFeaturePlugin : public QObject, FeatureProviderInterface, PluginInterface, ConfigurationPagePluginInterface, DemoAuthentication
+class DemoFeaturePlugin : public QObject, FeatureProviderInterface, PluginInterface, ConfigurationPagePluginInterface,
+		CommandLinePluginInterface, DemoAuthentication
 {
 	Q_OBJECT
 	Q_PLUGIN_METADATA(IID "io.veyon.Veyon.Plugins.Demo")
 	Q_INTERFACES(PluginInterface
 				 FeatureProviderInterface
 				 ConfigurationPagePluginInterface
+				 CommandLinePluginInterface
 				 AuthenticationPluginInterface)
 public:
 	enum class Argument {
@@ -57,7 +63,11 @@ public:
 		ViewportY,
 		ViewportWidth,
 		ViewportHeight,
-		VncServerPortOffset
+		VncServerPortOffset,
+		LaggingClients,
+		FallbackServerHosts,
+		FallbackServerPorts,
+		RelayServerPort
 	};
 	Q_ENUM(Argument)
 
@@ -108,6 +118,9 @@ public:
 	bool stopFeature( VeyonMasterInterface& master, const Feature& feature,
 					  const ComputerControlInterfaceList& computerControlInterfaces ) override;
 
+	bool handleFeatureMessage( ComputerControlInterface::Pointer computerControlInterface,
+							   const FeatureMessage& message ) override;
+
 	bool handleFeatureMessage( VeyonServerInterface& server,
 							   const MessageContext& messageContext,
 							   const FeatureMessage& message ) override;
@@ -116,6 +129,24 @@ public:
 
 	ConfigurationPage* createConfigurationPage() override;
 
+	QString commandLineModuleName() const override
+	{
+		return QStringLiteral( "demo" );
+	}
+
+	QString commandLineModuleHelp() const override
+	{
+		return tr( "Commands for measuring the distribution of demo streams" );
+	}
+
+	QStringList commands() const override;
+	QString commandHelp( const QString& command ) const override;
+
+public Q_SLOTS:
+	CommandLinePluginInterface::RunResult handle_benchmarkupdates( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkfanout( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_testmulticast( const QStringList& arguments );
+
 private:
 	static constexpr auto ScreenSelectionNone = 0;
 
@@ -123,19 +154,25 @@ private:
 	void removeScreen( QScreen* screen );
 
 	void updateFeatures();
+	void updateLaggingClientsIndicator( const QStringList& clients );
 
 	QRect viewportFromScreenSelection() const;
+	QRect viewportFromArguments( const QVariantMap& arguments ) const;
 
 	bool controlDemoServer( Operation operation, const QVariantMap& arguments,
 						   const ComputerControlInterfaceList& computerControlInterfaces );
 	bool controlDemoClient( Feature::Uid featureUid, Operation operation, const QVariantMap& arguments,
 						   const ComputerControlInterfaceList& computerControlInterfaces );
+	void startDemoClientsViaRelays( const FeatureMessage& message, const DemoServerAddress& demoServer,
+									const ComputerControlInterfaceList& computerControlInterfaces );
+	static int relayServerPort( const QString& hostAddress );
 
 	enum Commands {
 		StartDemoServer,
 		StopDemoServer,
 		StartDemoClient,
-		StopDemoClient
+		StopDemoClient,
+		ReportLaggingClients
 	};
 
 	const Feature m_demoFeature;
@@ -158,6 +195,15 @@ private:
 	QStringList m_demoClientHosts{};
 
 	DemoServer* m_demoServer{nullptr};
+	DemoServer* m_demoRelay{nullptr};
 	DemoClient* m_demoClient{nullptr};
 
+	// connection of the master which started the demo server
+	MessageContext m_demoServerRequester{nullptr};
+
+	VeyonMasterInterface* m_master{nullptr};
+	QPointer<QLabel> m_laggingClientsIndicator{};
+
+	const QMap<QString, QString> m_commands;
+
 };
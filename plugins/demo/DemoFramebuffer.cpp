@@ -0,0 +1,708 @@
+/*
+ * DemoFramebuffer.cpp - implementation of DemoFramebuffer class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <lzo/lzo1x.h>
+
+#include <QBuffer>
+#include <QtEndian>
+
+#include <limits>
+
+#include "DemoFramebuffer.h"
+#include "VeyonCore.h"
+
+
+DemoFramebuffer::DemoFramebuffer()
+{
+	if( lzo_init() != LZO_E_OK )
+	{
+		vCritical() << "failed to initialize LZO library";
+	}
+}
+
+
+
+void DemoFramebuffer::reset( int width, int height )
+{
+	if( m_image.width() != width || m_image.height() != height )
+	{
+		m_image = QImage( width, height, QImage::Format_RGB32 );
+	}
+
+	m_valid = m_image.isNull() == false;
+}
+
+
+
+bool DemoFramebuffer::applyUpdate( const QByteArray& message )
+{
+	m_lastUpdatedRegion = {};
+
+	if( m_valid == false )
+	{
+		return false;
+	}
+
+	QBuffer buffer;
+	buffer.setData( message );
+	buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
+
+	rfbFramebufferUpdateMsg updateMessage;
+	if( buffer.read( reinterpret_cast<char *>( &updateMessage ), sz_rfbFramebufferUpdateMsg ) != sz_rfbFramebufferUpdateMsg )
+	{
+		m_valid = false;
+		return false;
+	}
+
+	const auto nRects = qFromBigEndian( updateMessage.nRects );
+
+	for( int i = 0; i < nRects; ++i )
+	{
+		rfbFramebufferUpdateRectHeader rectHeader;
+		if( buffer.read( reinterpret_cast<char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader ) != sz_rfbFramebufferUpdateRectHeader )
+		{
+			m_valid = false;
+			return false;
+		}
+
+		rectHeader.encoding = qFromBigEndian( rectHeader.encoding );
+		rectHeader.r.w = qFromBigEndian( rectHeader.r.w );
+		rectHeader.r.h = qFromBigEndian( rectHeader.r.h );
+		rectHeader.r.x = qFromBigEndian( rectHeader.r.x );
+		rectHeader.r.y = qFromBigEndian( rectHeader.r.y );
+
+		if( rectHeader.encoding == rfbEncodingLastRect )
+		{
+			break;
+		}
+
+		if( decodeRect( buffer, rectHeader ) == false )
+		{
+			vDebug() << "could not decode rect with encoding" << rectHeader.encoding
+					 << "- snapshots unavailable until next full update";
+			m_valid = false;
+			m_lastUpdatedRegion = {};
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+QByteArray DemoFramebuffer::encodeSnapshot( int jpegQuality ) const
+{
+	if( m_valid == false )
+	{
+		return {};
+	}
+
+	return encodeRegion( visibleRect(), jpegQuality );
+}
+
+
+
+QByteArray DemoFramebuffer::encodeRegion( const QRegion& region, int jpegQuality ) const
+{
+	if( m_valid == false || region.isEmpty() )
+	{
+		return {};
+	}
+
+	const auto viewport = visibleRect();
+
+	QByteArray rects;
+	int rectCount = 0;
+
+	// Ultra encoding (plain LZO) is stateless just like Tight JPEG rects, i.e.
+	// the message can be decoded by a client regardless of the updates around it
+	QByteArray workMemory;
+	if( jpegQuality <= 0 )
+	{
+		workMemory = QByteArray( LZO1X_1_MEM_COMPRESS, Qt::Uninitialized );
+	}
+
+	for( const auto& regionRect : region.intersected( viewport ) )
+	{
+		// keep stripes small enough for being decoded progressively
+		for( int y = regionRect.y(); y <= regionRect.bottom(); y += SnapshotStripeHeight )
+		{
+			const QRect rect( regionRect.x(), y, regionRect.width(), qMin( int(SnapshotStripeHeight), regionRect.bottom() + 1 - y ) );
+
+			rfbFramebufferUpdateRectHeader rectHeader{};
+			rectHeader.r.x = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.x() - viewport.x() ) );
+			rectHeader.r.y = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.y() - viewport.y() ) );
+			rectHeader.r.w = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.width() ) );
+			rectHeader.r.h = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.height() ) );
+			rectHeader.encoding = qToBigEndian<uint32_t>( jpegQuality > 0 ? rfbEncodingTight : rfbEncodingUltra );
+
+			rects.append( reinterpret_cast<const char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader );
+
+			if( ( jpegQuality > 0 && encodeJpegRect( rects, rect, jpegQuality ) == false ) ||
+				( jpegQuality <= 0 && encodeUltraRect( rects, rect, workMemory ) == false ) )
+			{
+				return {};
+			}
+
+			++rectCount;
+		}
+	}
+
+	if( rectCount == 0 || rectCount > std::numeric_limits<uint16_t>::max() )
+	{
+		return {};
+	}
+
+	rfbFramebufferUpdateMsg updateMessage{};
+	updateMessage.type = rfbFramebufferUpdate;
+	updateMessage.nRects = qToBigEndian<uint16_t>( static_cast<uint16_t>( rectCount ) );
+
+	return QByteArray( reinterpret_cast<const char *>( &updateMessage ), sz_rfbFramebufferUpdateMsg ) + rects;
+}
+
+
+
+bool DemoFramebuffer::decodeRect( QBuffer& buffer, const rfbFramebufferUpdateRectHeader& rectHeader )
+{
+	const QRect rect( rectHeader.r.x, rectHeader.r.y, rectHeader.r.w, rectHeader.r.h );
+
+	switch( rectHeader.encoding )
+	{
+	case rfbEncodingNewFBSize:
+		// framebuffer contents are undefined until the next full update
+		m_image = QImage( rect.size(), QImage::Format_RGB32 );
+		return false;
+
+	case rfbEncodingUltraZip:
+		// rect header does not describe an actual rect for this encoding
+		return decodeUltraZip( buffer, rectHeader );
+
+	default:
+		break;
+	}
+
+	if( m_image.rect().contains( rect ) == false )
+	{
+		return false;
+	}
+
+	m_lastUpdatedRegion += rect;
+
+	switch( rectHeader.encoding )
+	{
+	case rfbEncodingRaw:
+	{
+		const auto dataSize = rect.width() * rect.height() * BytesPerPixel;
+		const auto data = buffer.read( dataSize );
+		if( data.size() != dataSize )
+		{
+			return false;
+		}
+		copyRect( rect, data.constData() );
+		return true;
+	}
+
+	case rfbEncodingCopyRect:
+	{
+		rfbCopyRect copyRectData;
+		if( buffer.read( reinterpret_cast<char *>( &copyRectData ), sz_rfbCopyRect ) != sz_rfbCopyRect )
+		{
+			return false;
+		}
+
+		const QRect sourceRect( qFromBigEndian( copyRectData.srcX ), qFromBigEndian( copyRectData.srcY ),
+								rect.width(), rect.height() );
+		if( m_image.rect().contains( sourceRect ) == false )
+		{
+			return false;
+		}
+
+		// copy source first as source and destination may overlap
+		const auto source = m_image.copy( sourceRect );
+		copyRect( rect, reinterpret_cast<const char *>( source.constBits() ) );
+		return true;
+	}
+
+	case rfbEncodingRRE:
+		return decodeRRE( buffer, rect, false );
+
+	case rfbEncodingCoRRE:
+		return decodeRRE( buffer, rect, true );
+
+	case rfbEncodingHextile:
+		return decodeHextile( buffer, rect );
+
+	case rfbEncodingUltra:
+		return decodeUltra( buffer, rect );
+
+	case rfbEncodingTight:
+		return decodeTightJpeg( buffer, rect );
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+
+
+bool DemoFramebuffer::decodeRRE( QBuffer& buffer, const QRect& rect, bool compact )
+{
+	rfbRREHeader header;
+	quint32 backgroundPixel = 0;
+
+	if( buffer.read( reinterpret_cast<char *>( &header ), sz_rfbRREHeader ) != sz_rfbRREHeader ||
+		readPixel( buffer, backgroundPixel ) == false )
+	{
+		return false;
+	}
+
+	fillRect( rect, backgroundPixel );
+
+	const auto nSubrects = qFromBigEndian( header.nSubrects );
+
+	for( uint32_t i = 0; i < nSubrects; ++i )
+	{
+		quint32 pixel = 0;
+		if( readPixel( buffer, pixel ) == false )
+		{
+			return false;
+		}
+
+		QRect subRect;
+
+		if( compact )
+		{
+			rfbCoRRERectangle coRRERect;
+			if( buffer.read( reinterpret_cast<char *>( &coRRERect ), sz_rfbCoRRERectangle ) != sz_rfbCoRRERectangle )
+			{
+				return false;
+			}
+			subRect.setRect( coRRERect.x, coRRERect.y, coRRERect.w, coRRERect.h );
+		}
+		else
+		{
+			rfbRectangle rreRect;
+			if( buffer.read( reinterpret_cast<char *>( &rreRect ), sz_rfbRectangle ) != sz_rfbRectangle )
+			{
+				return false;
+			}
+			subRect.setRect( qFromBigEndian( rreRect.x ), qFromBigEndian( rreRect.y ),
+							 qFromBigEndian( rreRect.w ), qFromBigEndian( rreRect.h ) );
+		}
+
+		subRect.translate( rect.topLeft() );
+		if( rect.contains( subRect ) == false )
+		{
+			return false;
+		}
+
+		fillRect( subRect, pixel );
+	}
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::decodeHextile( QBuffer& buffer, const QRect& rect )
+{
+	quint32 backgroundPixel = 0;
+	quint32 foregroundPixel = 0;
+
+	for( int y = rect.y(); y < rect.y() + rect.height(); y += HextileTileSize )
+	{
+		for( int x = rect.x(); x < rect.x() + rect.width(); x += HextileTileSize )
+		{
+			const QRect tile( x, y,
+							  qMin( int(HextileTileSize), rect.x() + rect.width() - x ),
+							  qMin( int(HextileTileSize), rect.y() + rect.height() - y ) );
+
+			uint8_t subEncoding = 0;
+			if( buffer.read( reinterpret_cast<char *>( &subEncoding ), 1 ) != 1 )
+			{
+				return false;
+			}
+
+			if( subEncoding & rfbHextileRaw )
+			{
+				const auto dataSize = tile.width() * tile.height() * BytesPerPixel;
+				const auto data = buffer.read( dataSize );
+				if( data.size() != dataSize )
+				{
+					return false;
+				}
+				copyRect( tile, data.constData() );
+				continue;
+			}
+
+			if( ( subEncoding & rfbHextileBackgroundSpecified ) &&
+				readPixel( buffer, backgroundPixel ) == false )
+			{
+				return false;
+			}
+
+			fillRect( tile, backgroundPixel );
+
+			if( ( subEncoding & rfbHextileForegroundSpecified ) &&
+				readPixel( buffer, foregroundPixel ) == false )
+			{
+				return false;
+			}
+
+			if( ( subEncoding & rfbHextileAnySubrects ) == 0 )
+			{
+				continue;
+			}
+
+			uint8_t nSubrects = 0;
+			if( buffer.read( reinterpret_cast<char *>( &nSubrects ), 1 ) != 1 )
+			{
+				return false;
+			}
+
+			for( int i = 0; i < nSubrects; ++i )
+			{
+				auto pixel = foregroundPixel;
+				if( ( subEncoding & rfbHextileSubrectsColoured ) &&
+					readPixel( buffer, pixel ) == false )
+				{
+					return false;
+				}
+
+				uint8_t subRectData[2];
+				if( buffer.read( reinterpret_cast<char *>( subRectData ), sizeof(subRectData) ) != sizeof(subRectData) )
+				{
+					return false;
+				}
+
+				const QRect subRect( x + rfbHextileExtractX( subRectData[0] ),
+									 y + rfbHextileExtractY( subRectData[0] ),
+									 rfbHextileExtractW( subRectData[1] ),
+									 rfbHextileExtractH( subRectData[1] ) );
+				if( tile.contains( subRect ) == false )
+				{
+					return false;
+				}
+
+				fillRect( subRect, pixel );
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::decodeUltra( QBuffer& buffer, const QRect& rect )
+{
+	QByteArray compressedData;
+	if( readCompressedData( buffer, compressedData ) == false )
+	{
+		return false;
+	}
+
+	if( compressedData.isEmpty() )
+	{
+		return true;
+	}
+
+	const auto rawDataSize = rect.width() * rect.height() * BytesPerPixel;
+	QByteArray rawData( rawDataSize, Qt::Uninitialized );
+
+	auto uncompressedSize = static_cast<lzo_uint>( rawDataSize );
+	if( lzo1x_decompress_safe( reinterpret_cast<lzo_bytep>( compressedData.data() ),
+							   static_cast<lzo_uint>( compressedData.size() ),
+							   reinterpret_cast<lzo_bytep>( rawData.data() ), &uncompressedSize,
+							   nullptr ) != LZO_E_OK ||
+		uncompressedSize != static_cast<lzo_uint>( rawDataSize ) )
+	{
+		return false;
+	}
+
+	copyRect( rect, rawData.constData() );
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::decodeTightJpeg( QBuffer& buffer, const QRect& rect )
+{
+	uint8_t compressionControl = 0;
+	if( buffer.read( reinterpret_cast<char *>( &compressionControl ), 1 ) != 1 )
+	{
+		return false;
+	}
+
+	// demo servers only send stateless JPEG rects, i.e. streams relayed from
+	// another demo server never contain rects depending on zlib streams
+	int length = 0;
+	if( ( compressionControl >> 4 ) != rfbTightJpeg ||
+		readCompactLength( buffer, length ) == false )
+	{
+		return false;
+	}
+
+	const auto jpegData = buffer.read( length );
+	if( jpegData.size() != length )
+	{
+		return false;
+	}
+
+	const auto image = QImage::fromData( jpegData, "JPEG" ).convertToFormat( QImage::Format_RGB32 );
+	if( image.size() != rect.size() )
+	{
+		return false;
+	}
+
+	copyRect( rect, reinterpret_cast<const char *>( image.constBits() ) );
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::decodeUltraZip( QBuffer& buffer, const rfbFramebufferUpdateRectHeader& rectHeader )
+{
+	static constexpr int SubRectHeaderSize = 4 * sizeof(uint16_t) + sizeof(uint32_t);
+
+	// x holds the number of sub rects, y and w encode the maximum uncompressed data size
+	const int subRectCount = rectHeader.r.x;
+	const auto maximumDataSize = static_cast<lzo_uint>( rectHeader.r.y ) + static_cast<lzo_uint>( rectHeader.r.w ) * 65535;
+
+	// sub rects only contain raw pixel data, so never allocate more than a complete framebuffer
+	const auto dataSizeLimit = static_cast<lzo_uint>( m_image.bytesPerLine() ) * static_cast<lzo_uint>( m_image.height() ) +
+							   static_cast<lzo_uint>( subRectCount ) * SubRectHeaderSize;
+	if( maximumDataSize > dataSizeLimit )
+	{
+		vWarning() << "invalid UltraZip data size" << maximumDataSize;
+		return false;
+	}
+
+	QByteArray compressedData;
+	if( readCompressedData( buffer, compressedData ) == false )
+	{
+		return false;
+	}
+
+	QByteArray rawData( static_cast<int>( maximumDataSize ), Qt::Uninitialized );
+
+	auto uncompressedSize = maximumDataSize;
+	if( lzo1x_decompress_safe( reinterpret_cast<lzo_bytep>( compressedData.data() ),
+							   static_cast<lzo_uint>( compressedData.size() ),
+							   reinterpret_cast<lzo_bytep>( rawData.data() ), &uncompressedSize,
+							   nullptr ) != LZO_E_OK )
+	{
+		return false;
+	}
+
+	const char* data = rawData.constData();
+	const char* dataEnd = data + uncompressedSize;
+
+	for( int i = 0; i < subRectCount; ++i )
+	{
+		if( dataEnd - data < SubRectHeaderSize )
+		{
+			return false;
+		}
+
+		const QRect subRect( qFromBigEndian<uint16_t>( data ), qFromBigEndian<uint16_t>( data + 2 ),
+							 qFromBigEndian<uint16_t>( data + 4 ), qFromBigEndian<uint16_t>( data + 6 ) );
+		const auto encoding = qFromBigEndian<uint32_t>( data + 8 );
+		data += SubRectHeaderSize;
+
+		const auto subRectDataSize = subRect.width() * subRect.height() * BytesPerPixel;
+
+		if( encoding != rfbEncodingRaw ||
+			dataEnd - data < subRectDataSize ||
+			m_image.rect().contains( subRect ) == false )
+		{
+			return false;
+		}
+
+		copyRect( subRect, data );
+		m_lastUpdatedRegion += subRect;
+		data += subRectDataSize;
+	}
+
+	return true;
+}
+
+
+
+void DemoFramebuffer::appendCompactLength( QByteArray& data, int length )
+{
+	// 7 bits per byte with the high bit indicating another byte to follow
+	data.append( char( ( length & 0x7f ) | ( length > 0x7f ? 0x80 : 0 ) ) );
+	if( length > 0x7f )
+	{
+		data.append( char( ( ( length >> 7 ) & 0x7f ) | ( length > 0x3fff ? 0x80 : 0 ) ) );
+		if( length > 0x3fff )
+		{
+			data.append( char( ( length >> 14 ) & 0xff ) );
+		}
+	}
+}
+
+
+
+QRect DemoFramebuffer::visibleRect() const
+{
+	if( m_viewport.isEmpty() )
+	{
+		return m_image.rect();
+	}
+
+	return m_viewport.intersected( m_image.rect() );
+}
+
+
+
+bool DemoFramebuffer::encodeJpegRect( QByteArray& data, const QRect& rect, int jpegQuality ) const
+{
+	QByteArray jpegData;
+	QBuffer jpegBuffer( &jpegData );
+	jpegBuffer.open( QBuffer::WriteOnly );
+
+	if( m_image.copy( rect ).save( &jpegBuffer, "JPEG", jpegQuality ) == false ||
+		jpegData.size() > MaximumTightCompactLength )
+	{
+		return false;
+	}
+
+	// JPEG rects do not use any of the zlib streams, i.e. each one can be decoded on its own
+	data.append( char( rfbTightJpeg << 4 ) );
+	appendCompactLength( data, jpegData.size() );
+	data.append( jpegData );
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::encodeUltraRect( QByteArray& data, const QRect& rect, QByteArray& workMemory ) const
+{
+	// rows of rects narrower than the framebuffer are not contiguous in memory
+	const auto image = rect.width() == m_image.width() ? QImage() : m_image.copy( rect );
+	const auto pixels = image.isNull() ? m_image.constScanLine( rect.y() ) : image.constBits();
+
+	const auto rawDataSize = rect.width() * rect.height() * BytesPerPixel;
+	QByteArray compressedData( rawDataSize + rawDataSize / 16 + 64 + 3, Qt::Uninitialized );
+
+	lzo_uint compressedSize = 0;
+	if( lzo1x_1_compress( const_cast<uchar *>( pixels ), static_cast<lzo_uint>( rawDataSize ),
+						  reinterpret_cast<lzo_bytep>( compressedData.data() ), &compressedSize,
+						  workMemory.data() ) != LZO_E_OK )
+	{
+		vCritical() << "failed to compress framebuffer rect";
+		return false;
+	}
+
+	rfbZlibHeader zlibHeader{};
+	zlibHeader.nBytes = qToBigEndian<uint32_t>( static_cast<uint32_t>( compressedSize ) );
+
+	data.append( reinterpret_cast<const char *>( &zlibHeader ), sz_rfbZlibHeader );
+	data.append( compressedData.constData(), static_cast<int>( compressedSize ) );
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::readCompactLength( QBuffer& buffer, int& length )
+{
+	length = 0;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		uint8_t byte = 0;
+		if( buffer.read( reinterpret_cast<char *>( &byte ), 1 ) != 1 )
+		{
+			return false;
+		}
+
+		// the third byte holds all 8 bits
+		length |= ( i < 2 ? byte & 0x7f : byte ) << ( i * 7 );
+
+		if( ( byte & 0x80 ) == 0 )
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+
+
+bool DemoFramebuffer::readCompressedData( QBuffer& buffer, QByteArray& data )
+{
+	rfbZlibHeader header;
+
+	if( buffer.read( reinterpret_cast<char *>( &header ), sz_rfbZlibHeader ) != sz_rfbZlibHeader )
+	{
+		return false;
+	}
+
+	const auto n = static_cast<int>( qFromBigEndian( header.nBytes ) );
+
+	data = buffer.read( n );
+
+	return data.size() == n;
+}
+
+
+
+bool DemoFramebuffer::readPixel( QBuffer& buffer, quint32& pixel )
+{
+	// the demo server requests the VNC server's pixel format to match the host's byte order
+	return buffer.read( reinterpret_cast<char *>( &pixel ), BytesPerPixel ) == BytesPerPixel;
+}
+
+
+
+void DemoFramebuffer::copyRect( const QRect& rect, const char* data )
+{
+	const auto rowSize = rect.width() * BytesPerPixel;
+
+	for( int y = 0; y < rect.height(); ++y )
+	{
+		memcpy( m_image.scanLine( rect.y() + y ) + rect.x() * BytesPerPixel, data + y * rowSize, // Flawfinder: ignore
+				static_cast<size_t>( rowSize ) );
+	}
+}
+
+
+
+void DemoFramebuffer::fillRect( const QRect& rect, quint32 pixel )
+{
+	for( int y = rect.y(); y < rect.y() + rect.height(); ++y )
+	{
+		std::fill_n( reinterpret_cast<quint32 *>( m_image.scanLine( y ) ) + rect.x(), rect.width(), pixel );
+	}
+}
@@ -0,0 +1,101 @@
+/*
+ * DemoFramebuffer.h - header file for DemoFramebuffer class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QRegion>
+
+#include "rfb/rfbproto.h"
+
+class QBuffer;
+
+// decoded copy of the framebuffer the demo server receives from the VNC server,
+// used for serving a compact snapshot to joining clients instead of replaying
+// all updates since the last key frame
+class DemoFramebuffer
+{
+public:
+	DemoFramebuffer();
+
+	bool isValid() const
+	{
+		return m_valid;
+	}
+
+	// prepare for a full update which is going to cover the whole framebuffer
+	void reset( int width, int height );
+
+	bool applyUpdate( const QByteArray& message );
+
+	// region covered by the rects of the last successfully applied update
+	const QRegion& lastUpdatedRegion() const
+	{
+		return m_lastUpdatedRegion;
+	}
+
+	// restricts encoded snapshots and regions to given rect of the framebuffer,
+	// encoded rects are translated so that the viewport starts at the origin
+	void setViewport( const QRect& viewport )
+	{
+		m_viewport = viewport;
+	}
+
+	// lossless if no JPEG quality is given
+	QByteArray encodeSnapshot( int jpegQuality = 0 ) const;
+
+	// encodes given region using stateless Tight JPEG rects or Ultra rects if no JPEG quality is given
+	QByteArray encodeRegion( const QRegion& region, int jpegQuality ) const;
+
+private:
+	static constexpr int BytesPerPixel = 4;
+	static constexpr int HextileTileSize = 16;
+	static constexpr int SnapshotStripeHeight = 64;
+	static constexpr int MaximumTightCompactLength = 0x3fffff;
+
+	bool decodeRect( QBuffer& buffer, const rfbFramebufferUpdateRectHeader& rectHeader );
+	bool decodeRRE( QBuffer& buffer, const QRect& rect, bool compact );
+	bool decodeHextile( QBuffer& buffer, const QRect& rect );
+	bool decodeUltra( QBuffer& buffer, const QRect& rect );
+	bool decodeUltraZip( QBuffer& buffer, const rfbFramebufferUpdateRectHeader& rectHeader );
+	bool decodeTightJpeg( QBuffer& buffer, const QRect& rect );
+
+	static bool readCompactLength( QBuffer& buffer, int& length );
+	static bool readCompressedData( QBuffer& buffer, QByteArray& data );
+	static bool readPixel( QBuffer& buffer, quint32& pixel );
+	static void appendCompactLength( QByteArray& data, int length );
+
+	QRect visibleRect() const;
+	bool encodeJpegRect( QByteArray& data, const QRect& rect, int jpegQuality ) const;
+	bool encodeUltraRect( QByteArray& data, const QRect& rect, QByteArray& workMemory ) const;
+
+	void copyRect( const QRect& rect, const char* data );
+	void fillRect( const QRect& rect, quint32 pixel );
+
+	QImage m_image{};
+	bool m_valid{false};
+	QRegion m_lastUpdatedRegion{};
+	QRect m_viewport{};
+
+} ;
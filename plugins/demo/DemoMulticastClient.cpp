@@ -0,0 +1,464 @@
+/*
+ * DemoMulticastClient.cpp - implementation of DemoMulticastClient class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include "DemoAuthentication.h"
+#include "DemoMulticastClient.h"
+#include "DemoServerProtocol.h"
+
+
+DemoMulticastClient::DemoMulticastClient( const QString& host, int port, const DemoAuthentication& authentication,
+										  QObject* parent ) :
+	QObject( parent ),
+	m_authentication( authentication ),
+	m_serverSocket( new QTcpSocket( this ) ),
+	m_serverProtocol( authentication, m_serverSocket )
+{
+	connect( m_serverSocket, &QTcpSocket::connected, this, [this]() {
+		m_state = State::Handshake;
+		m_serverProtocol.start();
+	} );
+	connect( m_serverSocket, &QTcpSocket::readyRead, this, &DemoMulticastClient::readFromServer );
+	connect( m_serverSocket, &QTcpSocket::stateChanged, this, [this]( QAbstractSocket::SocketState state ) {
+		if( state == QAbstractSocket::UnconnectedState )
+		{
+			vDebug() << "connection to demo server closed";
+			fail();
+		}
+	} );
+
+	connect( &m_localServer, &QTcpServer::newConnection, this, &DemoMulticastClient::acceptViewerConnection );
+
+	m_handshakeTimer.setSingleShot( true );
+	connect( &m_handshakeTimer, &QTimer::timeout, this, [this]() {
+		vWarning() << "handshake with demo server timed out";
+		fail();
+	} );
+	m_handshakeTimer.start( HandshakeTimeout );
+
+	connect( &m_repairTimer, &QTimer::timeout, this, &DemoMulticastClient::requestRepairs );
+
+	m_stream.setKey( DemoMulticastStream::deriveKey( m_authentication.accessToken().toByteArray() ) );
+
+	m_serverSocket->connectToHost( host, static_cast<quint16>( port ) );
+}
+
+
+
+DemoMulticastClient::~DemoMulticastClient()
+{
+	m_serverSocket->disconnect( this );
+
+	delete m_viewerProtocol;
+}
+
+
+
+void DemoMulticastClient::fail()
+{
+	if( m_state == State::Failed )
+	{
+		return;
+	}
+
+	m_state = State::Failed;
+
+	m_handshakeTimer.stop();
+	m_repairTimer.stop();
+
+	if( m_viewerSocket )
+	{
+		m_viewerSocket->disconnect( this );
+		m_viewerSocket->close();
+	}
+
+	m_localServer.close();
+
+	Q_EMIT failed();
+}
+
+
+
+void DemoMulticastClient::readFromServer()
+{
+	switch( m_state )
+	{
+	case State::Relay:
+		m_viewerSocket->write( m_serverSocket->readAll() );
+		break;
+
+	case State::Subscribing:
+	case State::Multicast:
+	case State::Unsubscribing:
+		while( receiveServerMessage() )
+		{
+		}
+		break;
+
+	case State::Handshake:
+		while( m_serverProtocol.read() )
+		{
+		}
+
+		if( m_serverProtocol.state() == DemoClientProtocol::State::Failed )
+		{
+			fail();
+		}
+		else if( m_serverProtocol.state() == DemoClientProtocol::State::Running )
+		{
+			finishHandshake();
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+
+void DemoMulticastClient::finishHandshake()
+{
+	m_handshakeTimer.stop();
+
+	if( m_localServer.listen( QHostAddress::LocalHost, 0 ) == false )
+	{
+		vWarning() << "could not listen for local viewer";
+		fail();
+		return;
+	}
+
+	m_state = State::WaitingForViewer;
+
+	Q_EMIT ready( m_localServer.serverPort() );
+}
+
+
+
+bool DemoMulticastClient::receiveServerMessage()
+{
+	char messageType = 0;
+	if( m_serverSocket->peek( &messageType, sizeof(messageType) ) != sizeof(messageType) )
+	{
+		return false;
+	}
+
+	switch( messageType )
+	{
+	case DemoMulticastStream::SubscriptionInfo:
+		return receiveSubscriptionInfo();
+
+	case DemoMulticastStream::RepairedMessage:
+		return receiveRepairedMessage();
+
+	default:
+		break;
+	}
+
+	vCritical() << "received unexpected message type:" << static_cast<int>( messageType );
+	m_serverSocket->close();
+
+	return false;
+}
+
+
+
+bool DemoMulticastClient::receiveSubscriptionInfo()
+{
+	if( m_serverSocket->bytesAvailable() < DemoMulticastStream::SubscriptionInfoSize )
+	{
+		return false;
+	}
+
+	const auto info = m_serverSocket->read( DemoMulticastStream::SubscriptionInfoSize );
+	const auto available = info[1] != 0;
+	const auto port = qFromBigEndian<quint16>( info.constData() + 2 );
+	const QHostAddress group( qFromBigEndian<quint32>( info.constData() + 4 ) );
+
+	if( available == false )
+	{
+		// everything following is a plain RFB stream
+		startRelay();
+		return false;
+	}
+
+	if( m_state == State::Unsubscribing )
+	{
+		// reply to an earlier subscription request
+		return true;
+	}
+
+	if( m_multicastSocket == nullptr && joinMulticastGroup( group, port ) == false )
+	{
+		m_serverSocket->write( DemoMulticastStream::unsubscribeRequest() );
+		m_state = State::Unsubscribing;
+		return true;
+	}
+
+	m_state = State::Multicast;
+
+	return true;
+}
+
+
+
+bool DemoMulticastClient::receiveRepairedMessage()
+{
+	if( m_serverSocket->bytesAvailable() < DemoMulticastStream::RepairedMessageHeaderSize )
+	{
+		return false;
+	}
+
+	const auto header = m_serverSocket->peek( DemoMulticastStream::RepairedMessageHeaderSize );
+	const auto flags = qFromBigEndian<quint16>( header.constData() + 2 );
+	const auto sequence = qFromBigEndian<DemoMulticastStream::Sequence>( header.constData() + 4 );
+	const auto size = qFromBigEndian<quint32>( header.constData() + 8 );
+
+	if( m_serverSocket->bytesAvailable() < DemoMulticastStream::RepairedMessageHeaderSize + qint64(size) )
+	{
+		return false;
+	}
+
+	m_serverSocket->read( DemoMulticastStream::RepairedMessageHeaderSize );
+	const auto message = m_serverSocket->read( size );
+
+	if( flags & DemoMulticastStream::Snapshot )
+	{
+		m_stream.reset( sequence );
+		m_synchronizing = false;
+
+		if( message.isEmpty() == false )
+		{
+			m_viewerSocket->write( message );
+		}
+	}
+	else
+	{
+		m_stream.addMessage( sequence, message );
+	}
+
+	deliverMessages();
+
+	return true;
+}
+
+
+
+void DemoMulticastClient::acceptViewerConnection()
+{
+	auto socket = m_localServer.nextPendingConnection();
+	if( socket == nullptr )
+	{
+		return;
+	}
+
+	if( m_viewerSocket )
+	{
+		// only serve the viewer which connected first
+		socket->close();
+		socket->deleteLater();
+		return;
+	}
+
+	m_viewerSocket = socket;
+	m_viewerSocket->setParent( this );
+
+	connect( m_viewerSocket, &QTcpSocket::readyRead, this, &DemoMulticastClient::readFromViewer );
+
+	m_viewerProtocol = new DemoServerProtocol( m_authentication, m_viewerSocket, &m_viewerClient );
+	m_viewerProtocol->setServerInitMessage( m_serverProtocol.serverInitMessage() );
+	m_viewerProtocol->start();
+}
+
+
+
+void DemoMulticastClient::readFromViewer()
+{
+	if( m_viewerProtocol->state() != VncServerProtocol::State::Running )
+	{
+		while( m_viewerProtocol->read() )
+		{
+		}
+
+		if( m_viewerProtocol->state() == VncServerProtocol::State::Running && m_state == State::WaitingForViewer )
+		{
+			subscribe();
+		}
+	}
+
+	if( m_viewerProtocol->state() != VncServerProtocol::State::Running )
+	{
+		return;
+	}
+
+	if( m_state == State::Relay )
+	{
+		m_serverSocket->write( m_viewerSocket->readAll() );
+	}
+	else
+	{
+		// updates are pushed without being requested, so ignore framebuffer
+		// update requests and all other messages of the viewer
+		m_viewerSocket->readAll();
+	}
+}
+
+
+
+void DemoMulticastClient::subscribe()
+{
+	m_synchronizing = true;
+	m_serverSocket->write( DemoMulticastStream::subscribeRequest() );
+
+	if( m_state == State::WaitingForViewer )
+	{
+		m_state = State::Subscribing;
+	}
+}
+
+
+
+bool DemoMulticastClient::joinMulticastGroup( const QHostAddress& group, quint16 port )
+{
+	auto socket = new QUdpSocket( this );
+	if( socket->bind( QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint ) == false ||
+		socket->joinMulticastGroup( group ) == false )
+	{
+		vWarning() << "could not join multicast group" << group << "port" << port << socket->errorString();
+		delete socket;
+		return false;
+	}
+
+	socket->setSocketOption( QAbstractSocket::ReceiveBufferSizeSocketOption, SocketReceiveBufferSize );
+
+	connect( socket, &QUdpSocket::readyRead, this, &DemoMulticastClient::readDatagrams );
+
+	m_multicastSocket = socket;
+	m_multicastGroup = group;
+
+	m_lastDatagramTimer.restart();
+	m_repairTimer.start( RepairInterval );
+
+	vDebug() << "joined multicast group" << group << "port" << port;
+
+	return true;
+}
+
+
+
+void DemoMulticastClient::readDatagrams()
+{
+	while( m_multicastSocket->hasPendingDatagrams() )
+	{
+		QByteArray datagram( static_cast<int>( m_multicastSocket->pendingDatagramSize() ), 0 );
+		m_multicastSocket->readDatagram( datagram.data(), datagram.size() );
+
+		if( m_stream.addDatagram( datagram ) )
+		{
+			m_lastDatagramTimer.restart();
+		}
+	}
+
+	if( m_state == State::Multicast )
+	{
+		deliverMessages();
+	}
+}
+
+
+
+void DemoMulticastClient::deliverMessages()
+{
+	QByteArray message;
+	while( m_stream.takeMessage( message ) )
+	{
+		m_viewerSocket->write( message );
+	}
+
+	if( m_stream.isSynchronized() == false && m_synchronizing == false && m_state == State::Multicast )
+	{
+		vDebug() << "lost synchronization with multicast stream";
+		subscribe();
+	}
+}
+
+
+
+void DemoMulticastClient::requestRepairs()
+{
+	if( m_state != State::Multicast )
+	{
+		return;
+	}
+
+	if( m_lastDatagramTimer.elapsed() > MulticastTimeout )
+	{
+		// the server sends heartbeats, so multicast traffic is not reaching us
+		vWarning() << "no datagrams received from multicast group - switching to unicast";
+		m_serverSocket->write( DemoMulticastStream::unsubscribeRequest() );
+		m_state = State::Unsubscribing;
+		return;
+	}
+
+	const auto missingSequences = m_stream.missingSequences( MaximumRepairRequestSequences );
+	if( missingSequences.isEmpty() == false )
+	{
+		m_serverSocket->write( DemoMulticastStream::repairRequest( missingSequences ) );
+	}
+}
+
+
+
+void DemoMulticastClient::startRelay()
+{
+	vDebug() << "relaying updates from demo server";
+
+	m_state = State::Relay;
+	m_repairTimer.stop();
+
+	if( m_multicastSocket )
+	{
+		m_multicastSocket->leaveMulticastGroup( m_multicastGroup );
+		m_multicastSocket->deleteLater();
+		m_multicastSocket = nullptr;
+	}
+
+	m_stream.desynchronize();
+
+	// the server continues with a snapshot as soon as it receives a framebuffer update request
+	rfbFramebufferUpdateRequestMsg request{};
+	request.type = rfbFramebufferUpdateRequest;
+	request.incremental = 1;
+	m_serverSocket->write( reinterpret_cast<const char *>( &request ), sz_rfbFramebufferUpdateRequestMsg );
+
+	if( m_serverSocket->bytesAvailable() > 0 )
+	{
+		m_viewerSocket->write( m_serverSocket->readAll() );
+	}
+}
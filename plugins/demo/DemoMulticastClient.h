@@ -0,0 +1,115 @@
+/*
+ * DemoMulticastClient.h - declaration of DemoMulticastClient class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTimer>
+
+#include "DemoClientProtocol.h"
+#include "DemoMulticastStream.h"
+#include "VncServerClient.h"
+
+class DemoAuthentication;
+class DemoServerProtocol;
+class QTcpSocket;
+class QUdpSocket;
+
+// connects to the demo server and subscribes to its multicast stream - the
+// received updates are served to the local VNC viewer through a local demo
+// server socket while lost ones are requested via the TCP connection; if no
+// datagrams arrive at all, updates are relayed from the TCP connection instead
+class DemoMulticastClient : public QObject
+{
+	Q_OBJECT
+public:
+	DemoMulticastClient( const QString& host, int port, const DemoAuthentication& authentication, QObject* parent = nullptr );
+	~DemoMulticastClient() override;
+
+Q_SIGNALS:
+	// local viewer can connect to given port on the loopback interface
+	void ready( int localPort );
+	void failed();
+
+private:
+	enum class State
+	{
+		Connecting,
+		Handshake,
+		WaitingForViewer,
+		Subscribing,
+		Multicast,
+		Unsubscribing,
+		Relay,
+		Failed
+	};
+
+	void fail();
+
+	void readFromServer();
+	void finishHandshake();
+	bool receiveServerMessage();
+	bool receiveSubscriptionInfo();
+	bool receiveRepairedMessage();
+
+	void acceptViewerConnection();
+	void readFromViewer();
+
+	void subscribe();
+	bool joinMulticastGroup( const QHostAddress& group, quint16 port );
+	void readDatagrams();
+	void deliverMessages();
+	void requestRepairs();
+	void startRelay();
+
+	static constexpr int HandshakeTimeout = 10000;
+	static constexpr int RepairInterval = 100;
+	static constexpr int MaximumRepairRequestSequences = 64;
+	static constexpr int MulticastTimeout = 3000;
+	static constexpr int SocketReceiveBufferSize = 4*1024*1024;
+
+	const DemoAuthentication& m_authentication;
+
+	State m_state{State::Connecting};
+
+	QTcpSocket* m_serverSocket;
+	DemoClientProtocol m_serverProtocol;
+
+	QTcpServer m_localServer{this};
+	QTcpSocket* m_viewerSocket{nullptr};
+	VncServerClient m_viewerClient{};
+	DemoServerProtocol* m_viewerProtocol{nullptr};
+
+	QUdpSocket* m_multicastSocket{nullptr};
+	QHostAddress m_multicastGroup{};
+	DemoMulticastStream m_stream{};
+	bool m_synchronizing{false};
+
+	QTimer m_handshakeTimer{this};
+	QTimer m_repairTimer{this};
+	QElapsedTimer m_lastDatagramTimer{};
+
+} ;
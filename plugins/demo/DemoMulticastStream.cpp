@@ -0,0 +1,392 @@
+/*
+ * DemoMulticastStream.cpp - implementation of DemoMulticastStream class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QDataStream>
+#include <QMessageAuthenticationCode>
+
+#include "DemoMulticastStream.h"
+#include "VeyonCore.h"
+
+
+QByteArray DemoMulticastStream::deriveKey( const QByteArray& accessToken )
+{
+	return QMessageAuthenticationCode::hash( QByteArrayLiteral("VeyonDemoMulticastStream"), accessToken,
+											 QCryptographicHash::Sha256 );
+}
+
+
+
+QVector<QByteArray> DemoMulticastStream::packetize( const QByteArray& key, Sequence sequence, bool keyFrame, const QByteArray& message )
+{
+	const auto fragmentCount = qMax( 1, ( message.size() + MaximumPayloadSize - 1 ) / MaximumPayloadSize );
+	if( fragmentCount > MaximumFragmentCount )
+	{
+		vWarning() << "message too large:" << message.size();
+		return {};
+	}
+
+	QVector<QByteArray> datagrams;
+	datagrams.reserve( fragmentCount );
+
+	for( int i = 0; i < fragmentCount; ++i )
+	{
+		const auto offset = i * MaximumPayloadSize;
+		const auto payloadSize = qMin( int(MaximumPayloadSize), message.size() - offset );
+
+		datagrams.append( buildDatagram( key, sequence, quint16(i), quint16(fragmentCount), keyFrame ? KeyFrame : 0,
+										 message.constData() + offset, payloadSize ) );
+	}
+
+	return datagrams;
+}
+
+
+
+QByteArray DemoMulticastStream::heartbeat( const QByteArray& key, Sequence nextSequence )
+{
+	return buildDatagram( key, nextSequence, 0, 0, Heartbeat, nullptr, 0 );
+}
+
+
+
+QByteArray DemoMulticastStream::subscribeRequest()
+{
+	QByteArray request( SubscribeRequestSize, 0 );
+	request[0] = char(SubscribeRequest);
+
+	return request;
+}
+
+
+
+QByteArray DemoMulticastStream::unsubscribeRequest()
+{
+	QByteArray request( UnsubscribeRequestSize, 0 );
+	request[0] = char(UnsubscribeRequest);
+
+	return request;
+}
+
+
+
+QByteArray DemoMulticastStream::relayRequest()
+{
+	QByteArray request( RelayRequestSize, 0 );
+	request[0] = char(RelayRequest);
+
+	return request;
+}
+
+
+
+QByteArray DemoMulticastStream::repairRequest( const QVector<Sequence>& sequences )
+{
+	QByteArray request;
+
+	QDataStream stream( &request, QIODevice::WriteOnly );
+	stream << quint8(RepairRequest) << quint8(0) << quint16(sequences.size());
+
+	for( const auto sequence : sequences )
+	{
+		stream << sequence;
+	}
+
+	return request;
+}
+
+
+
+QByteArray DemoMulticastStream::subscriptionInfo( const QHostAddress& group, quint16 port )
+{
+	QByteArray info;
+
+	QDataStream stream( &info, QIODevice::WriteOnly );
+	stream << quint8(SubscriptionInfo) << quint8(group.isNull() ? 0 : 1) << port << quint32(group.toIPv4Address());
+
+	return info;
+}
+
+
+
+QByteArray DemoMulticastStream::repairedMessage( Sequence sequence, uint16_t flags, const QByteArray& message )
+{
+	QByteArray repairedMessage;
+	repairedMessage.reserve( RepairedMessageHeaderSize + message.size() );
+
+	repairedMessage.append( repairedMessageHeader( sequence, flags, message.size() ) );
+	repairedMessage.append( message );
+
+	return repairedMessage;
+}
+
+
+
+QByteArray DemoMulticastStream::repairedMessageHeader( Sequence sequence, uint16_t flags, int messageSize )
+{
+	QByteArray header;
+
+	QDataStream stream( &header, QIODevice::WriteOnly );
+	stream << quint8(RepairedMessage) << quint8(0) << quint16(flags) << sequence << quint32(messageSize);
+
+	return header;
+}
+
+
+
+void DemoMulticastStream::reset( Sequence nextSequence )
+{
+	m_nextSequence = nextSequence;
+	m_synchronized = true;
+
+	while( m_pendingMessages.isEmpty() == false && m_pendingMessages.firstKey() < nextSequence )
+	{
+		m_pendingMessages.erase( m_pendingMessages.begin() );
+	}
+}
+
+
+
+void DemoMulticastStream::desynchronize()
+{
+	m_synchronized = false;
+	m_pendingMessages.clear();
+}
+
+
+
+bool DemoMulticastStream::addDatagram( const QByteArray& datagram )
+{
+	if( datagram.size() < DatagramHeaderSize || m_key.isEmpty() )
+	{
+		return false;
+	}
+
+	const auto mac = datagramMac( m_key, datagram.constData(), datagram.constData() + DatagramHeaderSize,
+								  datagram.size() - DatagramHeaderSize );
+
+	// compare in constant time in order to not reveal how much of a forged MAC is valid
+	char difference = 0;
+	for( int i = 0; i < DatagramMacSize; ++i )
+	{
+		difference |= mac[i] ^ datagram[DatagramFieldsSize + i];
+	}
+
+	if( difference != 0 )
+	{
+		return false;
+	}
+
+	QDataStream stream( datagram );
+
+	quint32 magic = 0;
+	Sequence sequence = 0;
+	quint16 fragmentIndex = 0;
+	quint16 fragmentCount = 0;
+	quint16 flags = 0;
+	quint16 reserved = 0;
+
+	stream >> magic >> sequence >> fragmentIndex >> fragmentCount >> flags >> reserved;
+
+	if( magic == Magic && ( flags & Heartbeat ) )
+	{
+		// allows detecting lost messages even if no further messages follow
+		m_announcedSequence = qMax( m_announcedSequence, sequence );
+		return true;
+	}
+
+	if( magic != Magic || fragmentCount == 0 || fragmentIndex >= fragmentCount )
+	{
+		return false;
+	}
+
+	if( m_synchronized && sequence < m_nextSequence )
+	{
+		// already processed or skipped
+		return true;
+	}
+
+	auto& pendingMessage = m_pendingMessages[sequence];
+	if( pendingMessage.fragments.size() != fragmentCount )
+	{
+		pendingMessage.fragments = QVector<QByteArray>( fragmentCount );
+		pendingMessage.receivedFragments = 0;
+	}
+
+	auto& fragment = pendingMessage.fragments[fragmentIndex];
+	if( fragment.isNull() )
+	{
+		fragment = QByteArray( datagram.constData() + DatagramHeaderSize, datagram.size() - DatagramHeaderSize );
+		++pendingMessage.receivedFragments;
+	}
+
+	if( flags & KeyFrame )
+	{
+		pendingMessage.keyFrame = true;
+	}
+
+	if( m_pendingMessages.size() > MaximumPendingMessages )
+	{
+		vDebug() << "too many pending messages - resynchronization required";
+		desynchronize();
+	}
+
+	return true;
+}
+
+
+
+void DemoMulticastStream::addMessage( Sequence sequence, const QByteArray& message )
+{
+	if( m_synchronized && sequence < m_nextSequence )
+	{
+		return;
+	}
+
+	auto& pendingMessage = m_pendingMessages[sequence];
+	pendingMessage.fragments = { message };
+	pendingMessage.receivedFragments = 1;
+}
+
+
+
+bool DemoMulticastStream::takeMessage( QByteArray& message )
+{
+	if( m_synchronized == false )
+	{
+		return false;
+	}
+
+	auto it = m_pendingMessages.find( m_nextSequence );
+	if( it == m_pendingMessages.end() || it->isComplete() == false )
+	{
+		// a complete key frame supersedes all missing messages before it
+		auto keyFrame = m_pendingMessages.upperBound( m_nextSequence );
+		while( keyFrame != m_pendingMessages.end() &&
+			   ( keyFrame->keyFrame == false || keyFrame->isComplete() == false ) )
+		{
+			++keyFrame;
+		}
+
+		if( keyFrame == m_pendingMessages.end() )
+		{
+			return false;
+		}
+
+		vDebug() << "resynchronizing from" << m_nextSequence << "to key frame" << keyFrame.key();
+
+		reset( keyFrame.key() );
+
+		it = m_pendingMessages.find( m_nextSequence );
+	}
+
+	message = joinFragments( *it );
+
+	m_pendingMessages.erase( it );
+	++m_nextSequence;
+
+	return true;
+}
+
+
+
+QVector<DemoMulticastStream::Sequence> DemoMulticastStream::missingSequences( int maximumCount ) const
+{
+	QVector<Sequence> sequences;
+
+	if( m_synchronized == false )
+	{
+		return sequences;
+	}
+
+	auto lastSequence = m_announcedSequence;
+	if( m_pendingMessages.isEmpty() == false )
+	{
+		lastSequence = qMax( lastSequence, m_pendingMessages.lastKey() );
+	}
+
+	for( auto sequence = m_nextSequence; sequence < lastSequence && sequences.size() < maximumCount; ++sequence )
+	{
+		const auto it = m_pendingMessages.constFind( sequence );
+		if( it == m_pendingMessages.constEnd() || it->isComplete() == false )
+		{
+			sequences.append( sequence );
+		}
+	}
+
+	return sequences;
+}
+
+
+
+QByteArray DemoMulticastStream::joinFragments( const PendingMessage& pendingMessage )
+{
+	if( pendingMessage.fragments.size() == 1 )
+	{
+		return pendingMessage.fragments.first();
+	}
+
+	int size = 0;
+	for( const auto& fragment : pendingMessage.fragments )
+	{
+		size += fragment.size();
+	}
+
+	QByteArray message;
+	message.reserve( size );
+
+	for( const auto& fragment : pendingMessage.fragments )
+	{
+		message.append( fragment );
+	}
+
+	return message;
+}
+
+
+
+QByteArray DemoMulticastStream::datagramMac( const QByteArray& key, const char* fields, const char* payload, int payloadSize )
+{
+	QMessageAuthenticationCode mac( QCryptographicHash::Sha256, key );
+	mac.addData( fields, DatagramFieldsSize );
+	mac.addData( payload, payloadSize );
+
+	return mac.result().left( DatagramMacSize );
+}
+
+
+
+QByteArray DemoMulticastStream::buildDatagram( const QByteArray& key, Sequence sequence, quint16 fragmentIndex, quint16 fragmentCount,
+											   quint16 flags, const char* payload, int payloadSize )
+{
+	QByteArray datagram;
+	datagram.reserve( DatagramHeaderSize + payloadSize );
+
+	QDataStream stream( &datagram, QIODevice::WriteOnly );
+	stream << quint32(Magic) << sequence << fragmentIndex << fragmentCount << flags << quint16(0);
+
+	datagram.append( datagramMac( key, datagram.constData(), payload, payloadSize ) );
+	datagram.append( payload, payloadSize );
+
+	return datagram;
+}
@@ -0,0 +1,156 @@
+/*
+ * DemoMulticastStream.h - declaration of DemoMulticastStream class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QHostAddress>
+#include <QMap>
+#include <QVector>
+
+// wire format of multicast demo streams and in-order reassembly of received
+// framebuffer update messages - each message carries a sequence number and is
+// split into datagrams, lost messages are requested again through the demo
+// server's TCP connection (see DemoServerConnection and DemoMulticastClient);
+// every datagram is authenticated with a key derived from the demo access token
+// as anyone in the network can send datagrams to the multicast group
+class DemoMulticastStream
+{
+public:
+	using Sequence = quint32;
+
+	// RFB message types sent from demo clients to the demo server
+	enum ClientMessage : uint8_t
+	{
+		SubscribeRequest = 42,
+		RepairRequest = 43,
+		UnsubscribeRequest = 44,
+		// receive all messages as sequenced messages through the TCP connection (demo relays)
+		RelayRequest = 45,
+	};
+
+	// RFB message types sent from the demo server to demo clients
+	enum ServerMessage : uint8_t
+	{
+		SubscriptionInfo = 42,
+		RepairedMessage = 43,
+	};
+
+	enum Flag : uint16_t
+	{
+		KeyFrame = 0x01,
+		// snapshot of the framebuffer, continue with given sequence
+		Snapshot = 0x02,
+		// datagram without payload announcing the next sequence
+		Heartbeat = 0x04,
+	};
+
+	static constexpr quint32 Magic = 0x56444d43;
+	static constexpr int DatagramFieldsSize = 16;
+	static constexpr int DatagramMacSize = 16;
+	static constexpr int DatagramHeaderSize = DatagramFieldsSize + DatagramMacSize;
+	static constexpr int MaximumDatagramSize = 1400;
+	static constexpr int MaximumPayloadSize = MaximumDatagramSize - DatagramHeaderSize;
+	static constexpr int MaximumFragmentCount = 65535;
+	static constexpr int MaximumPendingMessages = 1024;
+
+	static constexpr int SubscribeRequestSize = 4;
+	static constexpr int UnsubscribeRequestSize = 4;
+	static constexpr int RelayRequestSize = 4;
+	static constexpr int RepairRequestHeaderSize = 4;
+	static constexpr int SubscriptionInfoSize = 8;
+	static constexpr int RepairedMessageHeaderSize = 12;
+
+	static QByteArray deriveKey( const QByteArray& accessToken );
+
+	static QVector<QByteArray> packetize( const QByteArray& key, Sequence sequence, bool keyFrame, const QByteArray& message );
+
+	static QByteArray heartbeat( const QByteArray& key, Sequence nextSequence );
+
+	static QByteArray subscribeRequest();
+	static QByteArray unsubscribeRequest();
+	static QByteArray relayRequest();
+	static QByteArray repairRequest( const QVector<Sequence>& sequences );
+	static QByteArray subscriptionInfo( const QHostAddress& group, quint16 port );
+	static QByteArray repairedMessage( Sequence sequence, uint16_t flags, const QByteArray& message );
+	static QByteArray repairedMessageHeader( Sequence sequence, uint16_t flags, int messageSize );
+
+	bool isSynchronized() const
+	{
+		return m_synchronized;
+	}
+
+	Sequence nextSequence() const
+	{
+		return m_nextSequence;
+	}
+
+	int pendingMessageCount() const
+	{
+		return m_pendingMessages.size();
+	}
+
+	// datagrams not authenticated with this key are dropped
+	void setKey( const QByteArray& key )
+	{
+		m_key = key;
+	}
+
+	// drop all messages before given sequence and continue with it
+	void reset( Sequence nextSequence );
+	void desynchronize();
+
+	bool addDatagram( const QByteArray& datagram );
+	void addMessage( Sequence sequence, const QByteArray& message );
+
+	// returns next message in order, skipping to complete key frames if earlier messages are missing
+	bool takeMessage( QByteArray& message );
+
+	QVector<Sequence> missingSequences( int maximumCount ) const;
+
+private:
+	struct PendingMessage
+	{
+		QVector<QByteArray> fragments;
+		int receivedFragments{0};
+		bool keyFrame{false};
+
+		bool isComplete() const
+		{
+			return receivedFragments == fragments.size();
+		}
+	};
+
+	static QByteArray joinFragments( const PendingMessage& pendingMessage );
+
+	static QByteArray datagramMac( const QByteArray& key, const char* fields, const char* payload, int payloadSize );
+	static QByteArray buildDatagram( const QByteArray& key, Sequence sequence, quint16 fragmentIndex, quint16 fragmentCount,
+									 quint16 flags, const char* payload, int payloadSize );
+
+	QByteArray m_key{};
+	QMap<Sequence, PendingMessage> m_pendingMessages;
+	Sequence m_nextSequence{0};
+	Sequence m_announcedSequence{0};
+	bool m_synchronized{false};
+
+} ;
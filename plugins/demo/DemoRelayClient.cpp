@@ -0,0 +1,206 @@
+/*
+ * DemoRelayClient.cpp - implementation of DemoRelayClient class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include "DemoMulticastStream.h"
+#include "DemoRelayClient.h"
+
+
+DemoRelayClient::DemoRelayClient( const DemoServerAddressList& servers, const DemoAuthentication& authentication,
+								  QObject* parent ) :
+	QObject( parent ),
+	m_servers( servers ),
+	m_socket( new QTcpSocket( this ) ),
+	m_protocol( authentication, m_socket )
+{
+	connect( m_socket, &QTcpSocket::connected, this, [this]() { m_protocol.start(); } );
+	connect( m_socket, &QTcpSocket::readyRead, this, &DemoRelayClient::readFromServer );
+	connect( m_socket, &QTcpSocket::stateChanged, this, [this]( QAbstractSocket::SocketState state ) {
+		if( state == QAbstractSocket::UnconnectedState )
+		{
+			connectToNextServer();
+		}
+	} );
+
+	m_handshakeTimer.setSingleShot( true );
+	connect( &m_handshakeTimer, &QTimer::timeout, this, [this]() {
+		vWarning() << "handshake with upstream demo server timed out";
+		connectToNextServer();
+	} );
+
+	connectToServer();
+}
+
+
+
+DemoRelayClient::~DemoRelayClient()
+{
+	m_socket->disconnect( this );
+}
+
+
+
+QSize DemoRelayClient::framebufferSize() const
+{
+	const auto& serverInitMessage = m_protocol.serverInitMessage();
+	if( serverInitMessage.size() < sz_rfbServerInitMsg )
+	{
+		return {};
+	}
+
+	const auto message = reinterpret_cast<const rfbServerInitMsg *>( serverInitMessage.constData() );
+
+	return { qFromBigEndian( message->framebufferWidth ), qFromBigEndian( message->framebufferHeight ) };
+}
+
+
+
+void DemoRelayClient::requestFramebufferUpdate()
+{
+	if( isRunning() == false || m_updateRequested )
+	{
+		return;
+	}
+
+	rfbFramebufferUpdateRequestMsg request{};
+	request.type = rfbFramebufferUpdateRequest;
+	request.incremental = 1;
+	m_socket->write( reinterpret_cast<const char *>( &request ), sz_rfbFramebufferUpdateRequestMsg );
+
+	m_updateRequested = true;
+}
+
+
+
+void DemoRelayClient::connectToServer()
+{
+	const auto& server = m_servers.value( m_currentServer );
+
+	vDebug() << "connecting to upstream demo server" << server.host << server.port;
+
+	m_reconnectPending = false;
+	m_updateRequested = false;
+	m_handshakeTimer.start( HandshakeTimeout );
+
+	m_socket->connectToHost( server.host, static_cast<quint16>( server.port ) );
+}
+
+
+
+void DemoRelayClient::connectToNextServer()
+{
+	// aborting the connection triggers this function again
+	if( m_reconnectPending )
+	{
+		return;
+	}
+
+	m_reconnectPending = true;
+
+	m_handshakeTimer.stop();
+	m_protocol.start();
+
+	m_socket->abort();
+
+	if( m_servers.size() > 1 )
+	{
+		m_currentServer = ( m_currentServer + 1 ) % m_servers.size();
+	}
+
+	QTimer::singleShot( ReconnectDelay, this, &DemoRelayClient::connectToServer );
+}
+
+
+
+void DemoRelayClient::readFromServer()
+{
+	if( isRunning() == false )
+	{
+		while( m_protocol.read() )
+		{
+		}
+
+		if( m_protocol.state() == DemoClientProtocol::State::Failed )
+		{
+			connectToNextServer();
+			return;
+		}
+
+		if( isRunning() == false )
+		{
+			return;
+		}
+
+		m_handshakeTimer.stop();
+
+		m_socket->write( DemoMulticastStream::relayRequest() );
+
+		Q_EMIT connected();
+
+		requestFramebufferUpdate();
+	}
+
+	while( receiveMessage() )
+	{
+	}
+}
+
+
+
+bool DemoRelayClient::receiveMessage()
+{
+	if( m_socket->bytesAvailable() < DemoMulticastStream::RepairedMessageHeaderSize )
+	{
+		return false;
+	}
+
+	const auto header = m_socket->peek( DemoMulticastStream::RepairedMessageHeaderSize );
+	if( header[0] != char(DemoMulticastStream::RepairedMessage) )
+	{
+		vCritical() << "received unexpected message type:" << static_cast<int>( header[0] );
+		m_socket->close();
+		return false;
+	}
+
+	const auto flags = qFromBigEndian<quint16>( header.constData() + 2 );
+	const auto size = qFromBigEndian<quint32>( header.constData() + 8 );
+
+	if( m_socket->bytesAvailable() < DemoMulticastStream::RepairedMessageHeaderSize + qint64(size) )
+	{
+		return false;
+	}
+
+	m_socket->read( DemoMulticastStream::RepairedMessageHeaderSize );
+	const auto message = m_socket->read( size );
+
+	m_updateRequested = false;
+
+	Q_EMIT messageReceived( message, flags & ( DemoMulticastStream::KeyFrame | DemoMulticastStream::Snapshot ) );
+
+	return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * DemoRelayClient.h - declaration of DemoRelayClient class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QSize>
+#include <QTimer>
+
+#include "DemoClientProtocol.h"
+#include "DemoServerAddress.h"
+
+class QTcpSocket;
+
+// receives the stream of the upstream demo server for a relaying demo server,
+// i.e. all framebuffer update messages along with key frame information - if
+// the connection breaks, the next upstream server is tried
+class DemoRelayClient : public QObject
+{
+	Q_OBJECT
+public:
+	DemoRelayClient( const DemoServerAddressList& servers, const DemoAuthentication& authentication, QObject* parent );
+	~DemoRelayClient() override;
+
+	bool isRunning() const
+	{
+		return m_protocol.state() == DemoClientProtocol::State::Running;
+	}
+
+	const QByteArray& serverInitMessage() const
+	{
+		return m_protocol.serverInitMessage();
+	}
+
+	QSize framebufferSize() const;
+
+	// only sent if the previous request has been answered already
+	void requestFramebufferUpdate();
+
+Q_SIGNALS:
+	void connected();
+	void messageReceived( const QByteArray& message, bool keyFrame );
+
+private:
+	void connectToServer();
+	void connectToNextServer();
+	void readFromServer();
+	bool receiveMessage();
+
+	static constexpr int HandshakeTimeout = 10000;
+	static constexpr int ReconnectDelay = 1000;
+
+	const DemoServerAddressList m_servers;
+	int m_currentServer{0};
+
+	QTcpSocket* m_socket;
+	DemoClientProtocol m_protocol;
+
+	bool m_updateRequested{false};
+	bool m_reconnectPending{false};
+
+	QTimer m_handshakeTimer{this};
+
+} ;
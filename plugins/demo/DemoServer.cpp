@@ -25,9 +25,13 @@
 
 #include "rfb/rfbproto.h"
 
+#include <QImageWriter>
 #include <QTcpSocket>
+#include <QUdpSocket>
 
+#include "DemoAuthentication.h"
 #include "DemoConfiguration.h"
+#include "DemoRelayClient.h"
 #include "DemoServer.h"
 #include "DemoServerConnection.h"
 #include "VeyonConfiguration.h"
@@ -35,30 +39,75 @@
 
 
 DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoAuthentication& authentication,
+						const DemoConfiguration& configuration, int demoServerPort, const QRect& viewport, QObject *parent ) :
+	DemoServer( vncServerPort, vncServerPassword, {}, authentication, configuration, demoServerPort, viewport, parent )
+{
+}
+
+
+
+DemoServer::DemoServer( const DemoServerAddressList& upstreamServers, const DemoAuthentication& authentication,
 						const DemoConfiguration& configuration, int demoServerPort, QObject *parent ) :
+	DemoServer( 0, {}, upstreamServers, authentication, configuration, demoServerPort, {}, parent )
+{
+}
+
+
+
+DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoServerAddressList& upstreamServers,
+						const DemoAuthentication& authentication, const DemoConfiguration& configuration,
+						int demoServerPort, const QRect& viewport, QObject *parent ) :
 	QTcpServer( parent ),
 	m_authentication( authentication ),
 	m_configuration( configuration ),
 	m_memoryLimit( m_configuration.memoryLimit() * 1024*1024 ),
 	m_keyFrameInterval( m_configuration.keyFrameInterval() * 1000 ),
 	m_vncServerPort( vncServerPort ),
-	m_vncServerSocket( new QTcpSocket( this ) ),
-	m_vncClientProtocol( new VncClientProtocol( m_vncServerSocket, vncServerPassword ) )
+	// relays forward the messages of the upstream server as they are
+	m_lossyEncoding( upstreamServers.isEmpty() && m_configuration.lossyEncoding() && isLossyEncodingSupported() ),
+	m_jpegQuality( qBound( int(MinimumJpegQuality), m_configuration.jpegQuality(), 100 ) ),
+	m_framebufferUpdateInterval( m_configuration.framebufferUpdateInterval() ),
+	m_requestedViewport( viewport ),
+	m_vncServerSocket( upstreamServers.isEmpty() ? new QTcpSocket( this ) : nullptr ),
+	m_vncClientProtocol( m_vncServerSocket ? new VncClientProtocol( m_vncServerSocket, vncServerPassword ) : nullptr ),
+	m_encodingQuality( m_jpegQuality )
 {
-	connect( m_vncServerSocket, &QTcpSocket::readyRead, this, &DemoServer::readFromVncServer );
-	connect( m_vncServerSocket, &QTcpSocket::disconnected, this, &DemoServer::reconnectToVncServer );
+	if( m_vncServerSocket )
+	{
+		connect( m_vncServerSocket, &QTcpSocket::readyRead, this, &DemoServer::readFromVncServer );
+		connect( m_vncServerSocket, &QTcpSocket::disconnected, this, &DemoServer::reconnectToVncServer );
+	}
 
 	connect( &m_framebufferUpdateTimer, &QTimer::timeout, this, &DemoServer::requestFramebufferUpdate );
 
+	setIOThreadCount( ioThreadCount() );
+
+	// multicast streams of relays would interfere with the stream of the upstream server
+	if( m_configuration.multicastEnabled() && upstreamServers.isEmpty() )
+	{
+		initMulticast( demoServerPort );
+	}
+
 	if( listen( QHostAddress::Any, demoServerPort ) == false )
 	{
 		vCritical() << "could not listen on demo server port";
 		return;
 	}
 
-	m_framebufferUpdateTimer.start( m_configuration.framebufferUpdateInterval() );
+	m_encodingStatisticsTimer.start();
+
+	m_framebufferUpdateTimer.start( m_framebufferUpdateInterval );
 
-	reconnectToVncServer();
+	if( upstreamServers.isEmpty() )
+	{
+		reconnectToVncServer();
+	}
+	else
+	{
+		m_relayClient = new DemoRelayClient( upstreamServers, m_authentication, this );
+		connect( m_relayClient, &DemoRelayClient::connected, this, &DemoServer::startRelay );
+		connect( m_relayClient, &DemoRelayClient::messageReceived, this, &DemoServer::enqueueFramebufferUpdateMessage );
+	}
 }
 
 
@@ -66,17 +115,28 @@ DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, co
 DemoServer::~DemoServer()
 {
 	vDebug() << "disconnecting signals";
-	m_vncServerSocket->disconnect( this );
+	if( m_vncServerSocket )
+	{
+		m_vncServerSocket->disconnect( this );
+	}
+
+	if( m_relayClient )
+	{
+		m_relayClient->disconnect( this );
+	}
 
 	vDebug() << "deleting connections";
 
-	QList<DemoServerConnection *> l;
-	while( !( l = findChildren<DemoServerConnection *>() ).isEmpty() )
+	// connections are deleted when their I/O thread finishes
+	for( auto thread : qAsConst(m_ioThreads) )
 	{
-		l.front()->quit();
-		l.front()->wait( ConnectionThreadWaitTime );
-		l.front()->terminate();
-		l.front()->deleteLater();
+		thread->quit();
+		if( thread->wait( ConnectionThreadWaitTime ) == false )
+		{
+			thread->terminate();
+			thread->wait();
+		}
+		delete thread;
 	}
 
 	vDebug() << "deleting VNC client protocol";
@@ -90,25 +150,148 @@ DemoServer::~DemoServer()
 
 
 
-const QByteArray& DemoServer::serverInitMessage() const
+bool DemoServer::isUpstreamRunning() const
+{
+	if( isRelay() )
+	{
+		return m_serverInitMessage.isEmpty() == false;
+	}
+
+	return m_vncClientProtocol->state() == VncClientProtocol::State::Running;
+}
+
+
+
+QSize DemoServer::framebufferSize() const
+{
+	if( isRelay() )
+	{
+		return m_relayClient->framebufferSize();
+	}
+
+	return { m_vncClientProtocol->framebufferWidth(), m_vncClientProtocol->framebufferHeight() };
+}
+
+
+
+void DemoServer::setIOThreadCount( int count )
+{
+	while( m_ioThreads.count() > count )
+	{
+		auto thread = m_ioThreads.takeLast();
+		thread->quit();
+		thread->wait();
+		delete thread;
+	}
+
+	m_ioThreads.reserve( count );
+	while( m_ioThreads.count() < count )
+	{
+		auto thread = new QThread;
+		thread->setObjectName( QStringLiteral("DemoServerIO%1").arg( m_ioThreads.count() ) );
+		thread->start();
+		m_ioThreads.append( thread );
+	}
+
+	m_nextIOThread = 0;
+
+	vDebug() << "serving clients from" << count << "I/O threads";
+}
+
+
+
+DemoUpdateSegmentPointer DemoServer::currentSegment()
+{
+	QMutexLocker locker( &m_segmentMutex );
+
+	return m_segment;
+}
+
+
+
+QByteArray DemoServer::serverInitMessage()
 {
-	return m_vncClientProtocol->serverInitMessage();
+	QMutexLocker locker( &m_framebufferMutex );
+
+	return m_serverInitMessage;
+}
+
+
+
+void DemoServer::sendMulticastHeartbeat()
+{
+	if( m_multicastSubscribers.loadAcquire() > 0 )
+	{
+		const auto segment = currentSegment();
+		m_multicastSocket->writeDatagram( DemoMulticastStream::heartbeat( m_multicastKey, segment->firstSequence() + quint32( segment->count() ) ),
+										  m_multicastGroup, m_multicastPort );
+	}
+}
+
+
+
+void DemoServer::addMulticastSubscriber()
+{
+	m_multicastSubscribers.ref();
+}
+
+
+
+void DemoServer::removeMulticastSubscriber()
+{
+	m_multicastSubscribers.deref();
+}
+
+
+
+void DemoServer::setClientLagging( const QString& client, bool lagging )
+{
+	QMetaObject::invokeMethod( this, [=]() {
+		if( lagging )
+		{
+			m_laggingClients.append( client );
+		}
+		else
+		{
+			m_laggingClients.removeOne( client );
+		}
+
+		auto clients = m_laggingClients;
+		clients.removeDuplicates();
+
+		Q_EMIT laggingClientsChanged( clients );
+	}, Qt::QueuedConnection );
 }
 
 
 
-void DemoServer::lockDataForRead()
+QByteArray DemoServer::framebufferSnapshot( DemoUpdateSegmentPointer& segment, int& messageIndex )
 {
-	QElapsedTimer readLockTimer;
-	readLockTimer.restart();
+	QMutexLocker locker( &m_framebufferMutex );
 
-	m_dataLock.lockForRead();
+	if( m_framebuffer.isValid() == false )
+	{
+		return {};
+	}
 
-	if( readLockTimer.elapsed() > 100 )
+	const auto messageCount = m_segment->count();
+
+	// share snapshot between all clients joining at the same state
+	if( m_snapshotKeyFrame != m_segment->keyFrame() ||
+		m_snapshotMessageCount != messageCount )
+	{
+		m_snapshot = m_framebuffer.encodeSnapshot( m_lossyEncoding ? m_encodingQuality : 0 );
+		m_snapshotKeyFrame = m_segment->keyFrame();
+		m_snapshotMessageCount = messageCount;
+	}
+
+	if( m_snapshot.isEmpty() == false )
 	{
-		vDebug() << "locking for read took" << readLockTimer.elapsed() << "ms in thread"
-				 << QThread::currentThreadId();
+		segment = m_segment;
+		messageIndex = messageCount;
 	}
+
+	return m_snapshot;
 }
 
 
@@ -119,7 +302,7 @@ void DemoServer::incomingConnection( qintptr socketDescriptor )
 
 	m_pendingConnections.append( socketDescriptor );
 
-	if( m_vncClientProtocol->state() == VncClientProtocol::State::Running )
+	if( isUpstreamRunning() )
 	{
 		acceptPendingConnections();
 	}
@@ -131,7 +314,14 @@ void DemoServer::acceptPendingConnections()
 {
 	while( m_pendingConnections.isEmpty() == false )
 	{
-		new DemoServerConnection( this, m_authentication, m_pendingConnections.takeFirst() );
+		auto thread = m_ioThreads[m_nextIOThread];
+		m_nextIOThread = ( m_nextIOThread + 1 ) % m_ioThreads.count();
+
+		auto connection = new DemoServerConnection( this, m_authentication, m_pendingConnections.takeFirst() );
+		connection->moveToThread( thread );
+		connect( thread, &QThread::finished, connection, &QObject::deleteLater );
+
+		QMetaObject::invokeMethod( connection, [connection]() { connection->start(); }, Qt::QueuedConnection );
 	}
 }
 
@@ -171,6 +361,12 @@ void DemoServer::readFromVncServer()
 
 void DemoServer::requestFramebufferUpdate()
 {
+	if( isRelay() )
+	{
+		m_relayClient->requestFramebufferUpdate();
+		return;
+	}
+
 	if( m_vncClientProtocol->state() != VncClientProtocol::State::Running )
 	{
 		return;
@@ -180,13 +376,13 @@ void DemoServer::requestFramebufferUpdate()
 		m_lastFullFramebufferUpdate.elapsed() >= m_keyFrameInterval )
 	{
 		vDebug() << "Requesting full framebuffer update";
-		m_vncClientProtocol->requestFramebufferUpdate( false );
+		m_vncClientProtocol->requestFramebufferUpdate( false, m_viewport );
 		m_lastFullFramebufferUpdate.restart();
 		m_requestFullFramebufferUpdate = false;
 	}
 	else
 	{
-		m_vncClientProtocol->requestFramebufferUpdate( true );
+		m_vncClientProtocol->requestFramebufferUpdate( true, m_viewport );
 	}
 }
 
@@ -198,7 +394,10 @@ bool DemoServer::receiveVncServerMessage()
 	{
 		if( m_vncClientProtocol->lastMessageType() == rfbFramebufferUpdate )
 		{
-			enqueueFramebufferUpdateMessage( m_vncClientProtocol->lastMessage() );
+			const auto updateArea = isCropping() ? m_viewport : QRect( QPoint( 0, 0 ), framebufferSize() );
+
+			enqueueFramebufferUpdateMessage( m_vncClientProtocol->lastMessage(),
+											 m_vncClientProtocol->lastUpdatedRect().contains( updateArea ) );
 		}
 		else
 		{
@@ -213,27 +412,42 @@ bool DemoServer::receiveVncServerMessage()
 
 
 
-void DemoServer::enqueueFramebufferUpdateMessage( const QByteArray& message )
+void DemoServer::startRelay()
 {
-	QElapsedTimer writeLockTime;
-	writeLockTime.start();
-
-	m_dataLock.lockForWrite();
+	vDebug();
 
-	if( writeLockTime.elapsed() > 10 )
+	// all upstream servers send the same stream, i.e. connected clients can continue
+	if( m_serverInitMessage.isEmpty() )
 	{
-		vDebug() << "locking for write took" << writeLockTime.elapsed() << "ms";
+		QMutexLocker locker( &m_framebufferMutex );
+		m_serverInitMessage = m_relayClient->serverInitMessage();
 	}
 
-	const auto lastUpdatedRect = m_vncClientProtocol->lastUpdatedRect();
+	requestFramebufferUpdate();
+
+	acceptPendingConnections();
+}
+
+
+
+void DemoServer::enqueueFramebufferUpdateMessage( const QByteArray& message, bool isFullUpdate )
+{
+	QElapsedTimer lockTime;
+	lockTime.start();
+
+	QMutexLocker locker( &m_framebufferMutex );
 
-	const bool isFullUpdate = ( lastUpdatedRect.x() == 0 && lastUpdatedRect.y() == 0 &&
-								lastUpdatedRect.width() == m_vncClientProtocol->framebufferWidth() &&
-								lastUpdatedRect.height() == m_vncClientProtocol->framebufferHeight() );
+	if( lockTime.elapsed() > 10 )
+	{
+		vDebug() << "locking framebuffer took" << lockTime.elapsed() << "ms";
+	}
 
-	const auto queueSize = framebufferUpdateMessageQueueSize();
+	const auto queueSize = m_segment->size();
 
-	if( isFullUpdate || queueSize > m_memoryLimit*2 )
+	// new segments start with a full update so that connections can switch to
+	// them at any time - only a segment running full before the requested full
+	// update arrives is continued by a segment connections have to catch up with
+	if( isFullUpdate || m_segment->isFull() )
 	{
 		if( m_keyFrameTimer.elapsed() > 1 )
 		{
@@ -243,35 +457,216 @@ void DemoServer::enqueueFramebufferUpdateMessage( const QByteArray& message )
 					 << "   KB/s:" << ( memTotal * 1000 ) / m_keyFrameTimer.elapsed();
 		}
 		m_keyFrameTimer.restart();
-		++m_keyFrame;
 
-		m_framebufferUpdateMessages.clear();
+		// previous segment is released as soon as all connections moved on
+		const auto segment = DemoUpdateSegmentPointer::create( m_segment->keyFrame() + 1,
+															   m_segment->firstSequence() + quint32( m_segment->count() ),
+															   isFullUpdate );
+
+		m_segmentMutex.lock();
+		m_segment = segment;
+		m_segmentMutex.unlock();
+
+		m_keyFrame.storeRelease( segment->keyFrame() );
+	}
+
+	if( isFullUpdate )
+	{
+		const auto size = framebufferSize();
+		m_framebuffer.reset( size.width(), size.height() );
+	}
+
+	QElapsedTimer processingTimer;
+	processingTimer.start();
+
+	QByteArray outgoingMessage;
+	if( isCropping() )
+	{
+		// updates have to be re-encoded in order to translate and clip them to the viewport
+		if( m_framebuffer.applyUpdate( message ) )
+		{
+			outgoingMessage = m_framebuffer.encodeRegion( m_framebuffer.lastUpdatedRegion(),
+														  m_lossyEncoding ? m_encodingQuality : 0 );
+		}
+		else
+		{
+			m_requestFullFramebufferUpdate = true;
+		}
+	}
+	else
+	{
+		outgoingMessage = m_framebuffer.applyUpdate( message ) && m_lossyEncoding ? encodeLossy( message ) : message;
+	}
+
+	m_processingTime += processingTimer.nsecsElapsed();
+
+	if( outgoingMessage.isEmpty() )
+	{
+		// nothing changed inside the viewport
+		return;
+	}
+
+	m_processedBytes += outgoingMessage.size();
+
+	if( m_encodingStatisticsTimer.elapsed() >= EncodingStatisticsInterval )
+	{
+		adjustEncoding();
 	}
 
-	m_framebufferUpdateMessages.append( message );
+	m_segment->append( outgoingMessage );
 
-	m_dataLock.unlock();
+	const auto sequence = m_segment->firstSequence() + quint32( m_segment->count() - 1 );
 
-	// we're about to reach memory limits?
-	if( framebufferUpdateMessageQueueSize() > m_memoryLimit )
+	// we're about to reach memory limits or the segment's capacity?
+	if( m_segment->size() > m_memoryLimit || m_segment->count() > DemoUpdateSegment::Capacity / 2 )
 	{
-		// then request a full update so we can clear our queue
+		// then request a full update so we can start a new segment
 		m_requestFullFramebufferUpdate = true;
 	}
+
+	locker.unlock();
+
+	if( m_multicastSubscribers.loadAcquire() > 0 )
+	{
+		sendMulticastMessage( sequence, isFullUpdate, outgoingMessage );
+	}
+}
+
+
+
+QByteArray DemoServer::encodeLossy( const QByteArray& message )
+{
+	const auto lossyMessage = m_framebuffer.encodeRegion( m_framebuffer.lastUpdatedRegion(), m_encodingQuality );
+
+	// small updates such as text changes are often encoded more efficiently without loss
+	if( lossyMessage.isEmpty() || lossyMessage.size() >= message.size() )
+	{
+		return message;
+	}
+
+	return lossyMessage;
+}
+
+
+
+void DemoServer::adjustEncoding()
+{
+	const auto elapsed = m_encodingStatisticsTimer.nsecsElapsed();
+
+	// CPU time spent for processing updates in percent of one core
+	const auto cpuLoad = int( m_processingTime * 100 / elapsed );
+	const auto bandwidth = int( m_processedBytes * 8 * 1000 / elapsed ); // Mbit/s
+
+	const auto cpuBudget = m_configuration.encodingCpuBudget();
+	const auto bandwidthLimit = m_configuration.bandwidthLimit();
+
+	const auto overloaded = cpuLoad > cpuBudget || ( bandwidthLimit > 0 && bandwidth > bandwidthLimit );
+	const auto relaxed = cpuLoad < cpuBudget / 2 && ( bandwidthLimit <= 0 || bandwidth < bandwidthLimit / 2 );
+
+	const auto previousQuality = m_encodingQuality;
+	const auto previousIntervalFactor = m_updateIntervalFactor;
+
+	if( overloaded )
+	{
+		// reduce quality first and only then the frame rate
+		if( m_lossyEncoding && m_encodingQuality > MinimumJpegQuality )
+		{
+			m_encodingQuality = qMax( int(MinimumJpegQuality), m_encodingQuality - JpegQualityStep );
+		}
+		else if( m_updateIntervalFactor < MaximumUpdateIntervalFactor )
+		{
+			m_updateIntervalFactor *= 2;
+		}
+	}
+	else if( relaxed )
+	{
+		if( m_updateIntervalFactor > 1 )
+		{
+			m_updateIntervalFactor /= 2;
+		}
+		else if( m_encodingQuality < m_jpegQuality )
+		{
+			m_encodingQuality = qMin( m_jpegQuality, m_encodingQuality + JpegQualityStep );
+		}
+	}
+
+	if( m_encodingQuality != previousQuality || m_updateIntervalFactor != previousIntervalFactor )
+	{
+		vDebug() << "CPU load:" << cpuLoad << "bandwidth:" << bandwidth
+				 << "quality:" << m_encodingQuality << "update interval:" << m_framebufferUpdateInterval * m_updateIntervalFactor;
+
+		m_framebufferUpdateTimer.setInterval( m_framebufferUpdateInterval * m_updateIntervalFactor );
+	}
+
+	m_processingTime = 0;
+	m_processedBytes = 0;
+	m_encodingStatisticsTimer.restart();
+}
+
+
+
+bool DemoServer::isLossyEncodingSupported()
+{
+	if( QImageWriter::supportedImageFormats().contains( QByteArrayLiteral("jpeg") ) )
+	{
+		return true;
+	}
+
+	vWarning() << "JPEG image format not available - using lossless encoding";
+
+	return false;
+}
+
+
+
+void DemoServer::sendMulticastMessage( DemoMulticastStream::Sequence sequence, bool keyFrame, const QByteArray& message )
+{
+	const auto datagrams = DemoMulticastStream::packetize( m_multicastKey, sequence, keyFrame, message );
+
+	for( const auto& datagram : datagrams )
+	{
+		if( m_multicastSocket->writeDatagram( datagram, m_multicastGroup, m_multicastPort ) < 0 )
+		{
+			// lost datagrams are repaired through the clients' TCP connections
+			vDebug() << "failed to send datagram:" << m_multicastSocket->errorString();
+			break;
+		}
+	}
 }
 
 
 
-qint64 DemoServer::framebufferUpdateMessageQueueSize() const
+void DemoServer::initMulticast( int demoServerPort )
 {
-	qint64 size = 0;
+	const QHostAddress group( m_configuration.multicastGroupAddress() );
+	if( group.protocol() != QAbstractSocket::IPv4Protocol || group.isMulticast() == false )
+	{
+		vWarning() << "invalid multicast group address" << m_configuration.multicastGroupAddress();
+		return;
+	}
 
-	for( const auto& message : qAsConst( m_framebufferUpdateMessages ) )
+	auto socket = new QUdpSocket( this );
+	if( socket->bind( QHostAddress::AnyIPv4, 0 ) == false )
 	{
-		size += message.size();
+		vWarning() << "could not bind multicast socket:" << socket->errorString();
+		delete socket;
+		return;
 	}
 
-	return size;
+	socket->setSocketOption( QAbstractSocket::MulticastTtlOption, m_configuration.multicastTimeToLive() );
+	socket->setSocketOption( QAbstractSocket::MulticastLoopbackOption, 1 );
+	socket->setSocketOption( QAbstractSocket::SendBufferSizeSocketOption, MulticastSocketBufferSize );
+
+	m_multicastSocket = socket;
+	m_multicastKey = DemoMulticastStream::deriveKey( m_authentication.accessToken().toByteArray() );
+	m_multicastGroup = group;
+	// UDP port numbers are independent of TCP ones so simply use the same port
+	m_multicastPort = static_cast<quint16>( demoServerPort );
+
+	connect( &m_multicastHeartbeatTimer, &QTimer::timeout, this, &DemoServer::sendMulticastHeartbeat );
+	m_multicastHeartbeatTimer.start( MulticastHeartbeatInterval );
+
+	vDebug() << "distributing updates via multicast group" << m_multicastGroup << "port" << m_multicastPort;
 }
 
 
@@ -283,6 +678,8 @@ void DemoServer::start()
 	setVncServerPixelFormat();
 	setVncServerEncodings();
 
+	updateViewport();
+
 	m_requestFullFramebufferUpdate = true;
 
 	requestFramebufferUpdate();
@@ -335,3 +732,39 @@ bool DemoServer::setVncServerEncodings()
 							  rfbEncodingLastRect
 						  } );
 }
+
+
+
+void DemoServer::updateViewport()
+{
+	const QRect framebufferRect( 0, 0, m_vncClientProtocol->framebufferWidth(), m_vncClientProtocol->framebufferHeight() );
+
+	m_viewport = {};
+
+	auto serverInitMessage = m_vncClientProtocol->serverInitMessage();
+
+	if( m_requestedViewport.isEmpty() == false && m_requestedViewport != framebufferRect )
+	{
+		m_viewport = m_requestedViewport.intersected( framebufferRect );
+		if( m_viewport.isEmpty() )
+		{
+			vWarning() << "viewport" << m_requestedViewport << "outside of framebuffer" << framebufferRect;
+		}
+	}
+
+	if( isCropping() )
+	{
+		vDebug() << "forwarding updates for viewport" << m_viewport;
+
+		// announce the size of the viewport instead of the whole framebuffer
+		auto message = reinterpret_cast<rfbServerInitMsg *>( serverInitMessage.data() );
+		message->framebufferWidth = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_viewport.width() ) );
+		message->framebufferHeight = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_viewport.height() ) );
+	}
+
+	// connections in I/O threads copy the message while starting, so never modify it in place
+	QMutexLocker locker( &m_framebufferMutex );
+	m_serverInitMessage = serverInitMessage;
+	m_framebuffer.setViewport( m_viewport );
+	m_snapshotKeyFrame = -1;
+}
@@ -26,16 +26,24 @@
 #pragma once
 
 #include <QElapsedTimer>
-#include <QReadWriteLock>
+#include <QHostAddress>
+#include <QMutex>
 #include <QTcpServer>
+#include <QThread>
 #include <QTimer>
 
 #include "CryptoCore.h"
+#include "DemoFramebuffer.h"
+#include "DemoMulticastStream.h"
+#include "DemoServerAddress.h"
+#include "DemoUpdateSegment.h"
 
 class DemoAuthentication;
 class DemoConfiguration;
+class DemoRelayClient;
 class QTcpServer;
 class QTcpSocket;
+class QUdpSocket;
 class VncClientProtocol;
 
 class DemoServer : public QTcpServer
@@ -43,10 +51,14 @@ class DemoServer : public QTcpServer
 	Q_OBJECT
 public:
 	using Password = CryptoCore::PlaintextPassword;
-	using MessageList = QVector<QByteArray>;
 
 	DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoAuthentication& authentication,
+				const DemoConfiguration& configuration, int demoServerPort, const QRect& viewport, QObject *parent );
+
+	// relays the stream of the first available upstream demo server
+	DemoServer( const DemoServerAddressList& upstreamServers, const DemoAuthentication& authentication,
 				const DemoConfiguration& configuration, int demoServerPort, QObject *parent );
+
 	~DemoServer() override;
 
 	const DemoConfiguration& configuration() const
@@ -54,26 +66,65 @@ public:
 		return m_configuration;
 	}
 
-	const QByteArray& serverInitMessage() const;
-
-	void lockDataForRead();
+	// thread-safe, may be called from connections in I/O threads
+	QByteArray serverInitMessage();
 
-	void unlockData()
+	static int ioThreadCount()
 	{
-		m_dataLock.unlock();
+		return qBound( 1, QThread::idealThreadCount(), int(MaximumIOThreadCount) );
 	}
 
+	// must not be called once connections have been accepted
+	void setIOThreadCount( int count );
+
 	int keyFrame() const
 	{
-		return m_keyFrame;
+		return m_keyFrame.loadAcquire();
+	}
+
+	DemoUpdateSegmentPointer currentSegment();
+
+	bool isMulticastAvailable() const
+	{
+		return m_multicastSocket != nullptr;
+	}
+
+	const QHostAddress& multicastGroup() const
+	{
+		return m_multicastGroup;
 	}
 
-	const MessageList& framebufferUpdateMessages() const
+	quint16 multicastPort() const
 	{
-		return m_framebufferUpdateMessages;
+		return m_multicastPort;
 	}
 
+	void addMulticastSubscriber();
+	void removeMulticastSubscriber();
+
+	// thread-safe, may be called from connections in I/O threads
+	void setClientLagging( const QString& client, bool lagging );
+
+	// returns an empty array if no snapshot is available, otherwise segment and
+	// message index at which to continue after sending the snapshot
+	QByteArray framebufferSnapshot( DemoUpdateSegmentPointer& segment, int& messageIndex );
+
+Q_SIGNALS:
+	void laggingClientsChanged( const QStringList& clients );
+
 private:
+	DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoServerAddressList& upstreamServers,
+				const DemoAuthentication& authentication, const DemoConfiguration& configuration,
+				int demoServerPort, const QRect& viewport, QObject *parent );
+
+	bool isRelay() const
+	{
+		return m_relayClient != nullptr;
+	}
+
+	bool isUpstreamRunning() const;
+	QSize framebufferSize() const;
+
 	void incomingConnection( qintptr socketDescriptor ) override;
 	void acceptPendingConnections();
 	void reconnectToVncServer();
@@ -81,33 +132,88 @@ private:
 	void requestFramebufferUpdate();
 
 	bool receiveVncServerMessage();
-	void enqueueFramebufferUpdateMessage( const QByteArray& message );
+	void startRelay();
+	void enqueueFramebufferUpdateMessage( const QByteArray& message, bool isFullUpdate );
+	QByteArray encodeLossy( const QByteArray& message );
+	void adjustEncoding();
+
+	static bool isLossyEncodingSupported();
 
-	qint64 framebufferUpdateMessageQueueSize() const;
+	void initMulticast( int demoServerPort );
+	void sendMulticastMessage( DemoMulticastStream::Sequence sequence, bool keyFrame, const QByteArray& message );
+	void sendMulticastHeartbeat();
 
 	void start();
 	bool setVncServerPixelFormat();
 	bool setVncServerEncodings();
+	void updateViewport();
+	bool isCropping() const
+	{
+		return m_viewport.isEmpty() == false;
+	}
 
 	static constexpr auto ConnectionThreadWaitTime = 5000;
+	static constexpr auto MaximumIOThreadCount = 4;
+	static constexpr auto MulticastSocketBufferSize = 4*1024*1024;
+	static constexpr auto MulticastHeartbeatInterval = 1000;
+	static constexpr auto EncodingStatisticsInterval = 1000;
+	static constexpr auto MinimumJpegQuality = 20;
+	static constexpr auto JpegQualityStep = 10;
+	static constexpr auto MaximumUpdateIntervalFactor = 4;
 
 	const DemoAuthentication& m_authentication;
 	const DemoConfiguration& m_configuration;
 	const qint64 m_memoryLimit;
 	const int m_keyFrameInterval;
 	const int m_vncServerPort;
+	const bool m_lossyEncoding;
+	const int m_jpegQuality;
+	const int m_framebufferUpdateInterval;
+
+	// part of the framebuffer to request and forward, i.e. the demo clients
+	// only receive the viewport translated to the origin
+	const QRect m_requestedViewport;
+	QRect m_viewport{};
 
 	QList<quintptr> m_pendingConnections;
-	QTcpSocket* m_vncServerSocket;
-	VncClientProtocol* m_vncClientProtocol;
+	QVector<QThread *> m_ioThreads;
+	int m_nextIOThread{0};
+	QTcpSocket* m_vncServerSocket{nullptr};
+	VncClientProtocol* m_vncClientProtocol{nullptr};
+	DemoRelayClient* m_relayClient{nullptr};
 
-	QReadWriteLock m_dataLock{};
 	QTimer m_framebufferUpdateTimer{this};
 	QElapsedTimer m_lastFullFramebufferUpdate{};
 	QElapsedTimer m_keyFrameTimer{};
 	bool m_requestFullFramebufferUpdate{false};
 
-	int m_keyFrame{0};
-	MessageList m_framebufferUpdateMessages{};
+	QAtomicInt m_keyFrame{0};
+	QMutex m_segmentMutex{};
+	DemoUpdateSegmentPointer m_segment{DemoUpdateSegmentPointer::create( 0, 0, false )};
+
+	// protects the decoded framebuffer in order to keep it consistent with the
+	// segment while encoding a snapshot as well as the server init message
+	QMutex m_framebufferMutex{};
+	QByteArray m_serverInitMessage{};
+	DemoFramebuffer m_framebuffer{};
+	QByteArray m_snapshot{};
+	int m_snapshotKeyFrame{-1};
+	int m_snapshotMessageCount{0};
+
+	// adjusted automatically depending on CPU load and bandwidth usage
+	int m_encodingQuality;
+	int m_updateIntervalFactor{1};
+	QElapsedTimer m_encodingStatisticsTimer{};
+	qint64 m_processingTime{0};
+	qint64 m_processedBytes{0};
+
+	QUdpSocket* m_multicastSocket{nullptr};
+	QByteArray m_multicastKey{};
+	QHostAddress m_multicastGroup{};
+	quint16 m_multicastPort{0};
+	QAtomicInt m_multicastSubscribers{0};
+	QTimer m_multicastHeartbeatTimer{this};
+
+	QStringList m_laggingClients{};
 
 } ;
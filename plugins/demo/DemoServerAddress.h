@@ -0,0 +1,38 @@
+/*
+ * DemoServerAddress.h - declaration of DemoServerAddress struct
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct DemoServerAddress
+{
+	QString host;
+	int port{0};
+};
+
+// demo servers in order of preference, i.e. clients of a relay which drops out
+// continue with the servers the relay itself received the stream from
+using DemoServerAddressList = QVector<DemoServerAddress>;
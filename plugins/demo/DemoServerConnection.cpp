@@ -26,8 +26,18 @@
 #include "rfb/rfbproto.h"
 
 #include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <array>
+#include <cerrno>
+#endif
 
 #include "DemoConfiguration.h"
+#include "DemoMulticastStream.h"
 #include "DemoServer.h"
 #include "DemoServerConnection.h"
 
@@ -35,7 +45,7 @@
 DemoServerConnection::DemoServerConnection( DemoServer* demoServer,
 											const DemoAuthentication& authentication,
 											quintptr socketDescriptor ) :
-	QThread(),
+	QObject(),
 	m_authentication( authentication ),
 	m_demoServer( demoServer ),
 	m_socketDescriptor( socketDescriptor ),
@@ -45,44 +55,60 @@ DemoServerConnection::DemoServerConnection( DemoServer* demoServer,
 									 std::pair<int, int>( rfbKeyEvent, sz_rfbKeyEventMsg ),
 									 std::pair<int, int>( rfbPointerEvent, sz_rfbPointerEventMsg ),
 									 } ),
-	m_framebufferUpdateInterval( m_demoServer->configuration().framebufferUpdateInterval() )
+	m_framebufferUpdateInterval( m_demoServer->configuration().framebufferUpdateInterval() ),
+	m_maximumLag( m_demoServer->configuration().maximumClientLag() )
+{
+}
+
+
+
+DemoServerConnection::~DemoServerConnection()
 {
-	start();
+	if( m_multicastSubscribed )
+	{
+		m_demoServer->removeMulticastSubscriber();
+	}
+
+	setLagging( false );
+
+	delete m_serverProtocol;
 }
 
 
 
-void DemoServerConnection::run()
+void DemoServerConnection::start()
 {
 	vDebug() << m_socketDescriptor;
 
-	m_socket = new QTcpSocket;
+	m_socket = new QTcpSocket( this );
 
 	if( m_socket->setSocketDescriptor( m_socketDescriptor ) == false )
 	{
 		vCritical() << "failed to set socket descriptor";
-		delete m_socket;
-		m_socket = nullptr;
 		deleteLater();
 		return;
 	}
 
-	connect( m_socket, &QTcpSocket::readyRead, this, &DemoServerConnection::processClient, Qt::DirectConnection );
-	connect( m_socket, &QTcpSocket::disconnected, this, &DemoServerConnection::quit );
-
-	m_serverProtocol = new DemoServerProtocol( m_authentication, m_socket, &m_vncServerClient ),
+	connect( m_socket, &QTcpSocket::readyRead, this, &DemoServerConnection::processClient );
+	connect( m_socket, &QTcpSocket::disconnected, this, &DemoServerConnection::deleteLater );
+	connect( m_socket, &QTcpSocket::bytesWritten, this, &DemoServerConnection::resumeFramebufferUpdate );
 
-	m_serverProtocol->setServerInitMessage( m_demoServer->serverInitMessage() );
-	m_serverProtocol->start();
-
-	exec();
+	m_peerAddress = m_socket->peerAddress().toString();
 
-	delete m_serverProtocol;
-	delete m_socket;
+	m_lastCaughtUpTimer.start();
 
-	m_socket = nullptr;
+	// notice clients which stopped receiving data entirely
+	connect( &m_lagCheckTimer, &QTimer::timeout, this, [this]() {
+		if( m_updatePending )
+		{
+			updateLagState();
+		}
+	} );
+	m_lagCheckTimer.start( m_maximumLag );
 
-	deleteLater();
+	m_serverProtocol = new DemoServerProtocol( m_authentication, m_socket, &m_vncServerClient );
+	m_serverProtocol->setServerInitMessage( m_demoServer->serverInitMessage() );
+	m_serverProtocol->start();
 }
 
 
@@ -91,16 +117,15 @@ void DemoServerConnection::processClient()
 {
 	if( m_serverProtocol->state() != VncServerProtocol::State::Running )
 	{
+		// the demo server protocol has no external dependencies, i.e. it only
+		// stops when waiting for further data from the client
 		while( m_serverProtocol->read() )
 		{
 		}
-
-		// try again later in case we could not proceed because of
-		// external protocol dependencies or in case we're finished
-		// and already have RFB messages in receive queue
-		QTimer::singleShot( ProtocolRetryTime, [this]() { processClient(); } );
 	}
-	else
+
+	// handle RFB messages which might already be in receive queue
+	if( m_serverProtocol->state() == VncServerProtocol::State::Running )
 	{
 		while( receiveClientMessage() )
 		{
@@ -135,6 +160,37 @@ bool DemoServerConnection::receiveClientMessage()
 		}
 		break;
 
+	case DemoMulticastStream::SubscribeRequest:
+		if( m_socket->bytesAvailable() >= DemoMulticastStream::SubscribeRequestSize )
+		{
+			m_socket->read( DemoMulticastStream::SubscribeRequestSize );
+			subscribeMulticast();
+			return true;
+		}
+		break;
+
+	case DemoMulticastStream::UnsubscribeRequest:
+		if( m_socket->bytesAvailable() >= DemoMulticastStream::UnsubscribeRequestSize )
+		{
+			m_socket->read( DemoMulticastStream::UnsubscribeRequestSize );
+			unsubscribeMulticast();
+			return true;
+		}
+		break;
+
+	case DemoMulticastStream::RepairRequest:
+		return receiveRepairRequest();
+
+	case DemoMulticastStream::RelayRequest:
+		if( m_socket->bytesAvailable() >= DemoMulticastStream::RelayRequestSize )
+		{
+			m_socket->read( DemoMulticastStream::RelayRequestSize );
+			vDebug() << "relaying stream to" << m_peerAddress;
+			m_relaying = true;
+			return true;
+		}
+		break;
+
 	default:
 		if( m_rfbClientToServerMessageSizes.contains( messageType ) == false )
 		{
@@ -151,7 +207,7 @@ bool DemoServerConnection::receiveClientMessage()
 
 		m_socket->read( m_rfbClientToServerMessageSizes[messageType] );
 
-		if( messageType == rfbFramebufferUpdateRequest )
+		if( messageType == rfbFramebufferUpdateRequest && m_multicastSubscribed == false )
 		{
 			sendFramebufferUpdate();
 		}
@@ -164,33 +220,336 @@ bool DemoServerConnection::receiveClientMessage()
 
 
 
+bool DemoServerConnection::receiveRepairRequest()
+{
+	if( m_socket->bytesAvailable() < DemoMulticastStream::RepairRequestHeaderSize )
+	{
+		return false;
+	}
+
+	const auto header = m_socket->peek( DemoMulticastStream::RepairRequestHeaderSize );
+	const auto sequenceCount = qFromBigEndian<quint16>( header.constData() + 2 );
+	const qint64 totalSize = DemoMulticastStream::RepairRequestHeaderSize + sequenceCount * qint64( sizeof(DemoMulticastStream::Sequence) );
+
+	if( m_socket->bytesAvailable() < totalSize )
+	{
+		return false;
+	}
+
+	const auto request = m_socket->read( totalSize );
+
+	if( m_multicastSubscribed == false )
+	{
+		return true;
+	}
+
+	m_segment = m_demoServer->currentSegment();
+
+	const auto firstSequence = m_segment->firstSequence();
+	const auto messageCount = quint32( m_segment->count() );
+
+	QVector<QByteArray> messages;
+	messages.reserve( sequenceCount );
+
+	for( int i = 0; i < sequenceCount; ++i )
+	{
+		const auto sequence = qFromBigEndian<DemoMulticastStream::Sequence>(
+								  request.constData() + DemoMulticastStream::RepairRequestHeaderSize + i * int( sizeof(DemoMulticastStream::Sequence) ) );
+
+		if( sequence < firstSequence )
+		{
+			// message belongs to an earlier segment which is gone already
+			sendMulticastSynchronization();
+			return true;
+		}
+
+		const auto index = sequence - firstSequence;
+		if( index < messageCount )
+		{
+			messages.append( DemoMulticastStream::repairedMessage( sequence, 0, m_segment->message( int(index) ) ) );
+		}
+	}
+
+	if( messages.isEmpty() == false )
+	{
+		writeMessages( messages );
+	}
+
+	return true;
+}
+
+
+
+void DemoServerConnection::subscribeMulticast()
+{
+	if( m_demoServer->isMulticastAvailable() == false )
+	{
+		writeMessages( { DemoMulticastStream::subscriptionInfo( {}, 0 ) } );
+		return;
+	}
+
+	// register before synchronizing so that each message is either
+	// part of the synchronization or sent via multicast
+	if( m_multicastSubscribed == false )
+	{
+		m_multicastSubscribed = true;
+		m_demoServer->addMulticastSubscriber();
+	}
+
+	writeMessages( { DemoMulticastStream::subscriptionInfo( m_demoServer->multicastGroup(), m_demoServer->multicastPort() ) } );
+
+	sendMulticastSynchronization();
+}
+
+
+
+void DemoServerConnection::unsubscribeMulticast()
+{
+	if( m_multicastSubscribed )
+	{
+		m_multicastSubscribed = false;
+		m_demoServer->removeMulticastSubscriber();
+	}
+
+	// continue with a snapshot with the next framebuffer update request
+	m_segment.reset();
+
+	writeMessages( { DemoMulticastStream::subscriptionInfo( {}, 0 ) } );
+}
+
+
+
+void DemoServerConnection::sendMulticastSynchronization()
+{
+	m_segment = m_demoServer->currentSegment();
+	m_framebufferUpdateMessageIndex = 0;
+
+	QByteArray snapshot;
+	if( m_segment->count() > 1 || m_segment->startsWithKeyFrame() == false )
+	{
+		snapshot = m_demoServer->framebufferSnapshot( m_segment, m_framebufferUpdateMessageIndex );
+	}
+
+	const auto firstSequence = m_segment->firstSequence();
+	const auto messageCount = m_segment->count();
+
+	QVector<QByteArray> messages;
+	messages.reserve( messageCount - m_framebufferUpdateMessageIndex + 1 );
+
+	// an empty snapshot just tells the client where to continue
+	messages.append( DemoMulticastStream::repairedMessage( firstSequence + quint32(m_framebufferUpdateMessageIndex),
+														   DemoMulticastStream::Snapshot, snapshot ) );
+
+	for( int i = m_framebufferUpdateMessageIndex; i < messageCount; ++i )
+	{
+		messages.append( DemoMulticastStream::repairedMessage( firstSequence + quint32(i), 0, m_segment->message( i ) ) );
+	}
+
+	writeMessages( messages );
+}
+
+
+
 void DemoServerConnection::sendFramebufferUpdate()
 {
-	m_demoServer->lockDataForRead();
+	if( m_multicastSubscribed )
+	{
+		return;
+	}
 
-	const auto& framebufferUpdateMessages = m_demoServer->framebufferUpdateMessages();
+	m_updatePending = false;
 
-	const int framebufferUpdateMessageCount = framebufferUpdateMessages.count();
+	updateLagState();
 
-	if( m_demoServer->keyFrame() != m_keyFrame ||
-			m_framebufferUpdateMessageIndex > framebufferUpdateMessageCount )
+	if( m_socket->bytesToWrite() > SendBufferHighWatermark )
 	{
-		m_framebufferUpdateMessageIndex = 0;
-		m_keyFrame = m_demoServer->keyFrame();
+		// do not queue further messages for clients which can't keep up,
+		// continue as soon as the send buffer drained
+		m_updatePending = true;
+		return;
 	}
 
-	bool sentUpdates = false;
-	for( ; m_framebufferUpdateMessageIndex < framebufferUpdateMessageCount; ++m_framebufferUpdateMessageIndex )
+	QVector<QByteArray> messages;
+	qint64 size = 0;
+
+	const auto appendMessage = [&]( const QByteArray& message, uint16_t flags ) {
+		if( m_relaying )
+		{
+			// relays need sequences and key frames in order to serve the stream themselves
+			messages.append( DemoMulticastStream::repairedMessageHeader( m_segment->firstSequence() + quint32(m_framebufferUpdateMessageIndex),
+																		 flags, message.size() ) );
+		}
+		messages.append( message );
+		size += message.size();
+	};
+
+	if( m_segment.isNull() || m_segment->keyFrame() != m_demoServer->keyFrame() )
 	{
-		m_socket->write( framebufferUpdateMessages[m_framebufferUpdateMessageIndex] );
-		sentUpdates = true;
+		const auto segment = m_demoServer->currentSegment();
+
+		// segments without a key frame only continue the previous segment, i.e.
+		// all messages of the previous segment have to be sent before switching
+		const auto finishedSegment = m_segment.isNull() == false &&
+									 m_framebufferUpdateMessageIndex >= m_segment->count();
+		const auto continuesSegment = finishedSegment &&
+									  segment->firstSequence() == m_segment->firstSequence() + quint32( m_segment->count() );
+
+		if( segment != m_segment &&
+			( m_segment.isNull() || finishedSegment || segment->startsWithKeyFrame() ) )
+		{
+			m_segment = segment;
+			m_framebufferUpdateMessageIndex = 0;
+
+			// send a compact snapshot of the current framebuffer to joining clients
+			// instead of replaying all updates since the last key frame
+			if( continuesSegment == false &&
+				( m_segment->count() > 1 || m_segment->startsWithKeyFrame() == false ) )
+			{
+				const auto snapshot = m_demoServer->framebufferSnapshot( m_segment, m_framebufferUpdateMessageIndex );
+				if( snapshot.isEmpty() == false )
+				{
+					appendMessage( snapshot, DemoMulticastStream::Snapshot );
+				}
+			}
+		}
 	}
 
-	m_demoServer->unlockData();
+	const auto framebufferUpdateMessageCount = m_segment->count();
+
+	// remaining messages are sent with the next framebuffer update request
+	for( ; m_framebufferUpdateMessageIndex < framebufferUpdateMessageCount && size < SendBufferHighWatermark;
+		 ++m_framebufferUpdateMessageIndex )
+	{
+		appendMessage( m_segment->message( m_framebufferUpdateMessageIndex ),
+					   m_framebufferUpdateMessageIndex == 0 && m_segment->startsWithKeyFrame() ?
+						   DemoMulticastStream::KeyFrame : 0 );
+	}
 
-	if( sentUpdates == false )
+	if( messages.isEmpty() )
 	{
 		// did not send updates but client still waiting for update? then try again soon
-		QTimer::singleShot( m_framebufferUpdateInterval, [this]() { sendFramebufferUpdate(); } );
+		QTimer::singleShot( m_framebufferUpdateInterval, this, &DemoServerConnection::sendFramebufferUpdate );
+		return;
+	}
+
+	writeMessages( messages );
+}
+
+
+
+void DemoServerConnection::resumeFramebufferUpdate()
+{
+	if( m_updatePending && m_socket->bytesToWrite() <= SendBufferLowWatermark )
+	{
+		sendFramebufferUpdate();
+	}
+}
+
+
+
+void DemoServerConnection::updateLagState()
+{
+	if( m_socket->bytesToWrite() <= SendBufferLowWatermark )
+	{
+		// client keeps up with the stream
+		m_lastCaughtUpTimer.restart();
+		setLagging( false );
+		return;
+	}
+
+	if( m_lagging == false && m_lastCaughtUpTimer.elapsed() > m_maximumLag )
+	{
+		vDebug() << "client" << m_peerAddress << "lags behind - skipping to current framebuffer";
+
+		setLagging( true );
+
+		// drop all messages not queued yet and continue with a snapshot
+		m_segment.reset();
+	}
+}
+
+
+
+void DemoServerConnection::setLagging( bool lagging )
+{
+	if( lagging != m_lagging )
+	{
+		m_lagging = lagging;
+		m_demoServer->setClientLagging( m_peerAddress, lagging );
+	}
+}
+
+
+
+void DemoServerConnection::writeMessages( const QVector<QByteArray>& messages )
+{
+	int index = 0;
+	int offset = 0;
+
+#ifdef Q_OS_UNIX
+	// pass the shared message buffers to the kernel without copying them into the
+	// socket's write buffer first unless previously queued data is still pending
+	if( m_socket->bytesToWrite() == 0 )
+	{
+#ifdef MSG_NOSIGNAL
+		static constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+		static constexpr int SendFlags = 0;
+#endif
+		const auto socketDescriptor = static_cast<int>( m_socket->socketDescriptor() );
+
+		while( index < messages.count() )
+		{
+			std::array<iovec, MaximumIOVectorCount> vectors{};
+			size_t vectorCount = 0;
+
+			for( int i = index; i < messages.count() && vectorCount < vectors.size(); ++i )
+			{
+				const auto skip = i == index ? offset : 0;
+				vectors[vectorCount].iov_base = const_cast<char *>( messages[i].constData() + skip );
+				vectors[vectorCount].iov_len = static_cast<size_t>( messages[i].size() - skip );
+				++vectorCount;
+			}
+
+			msghdr header{};
+			header.msg_iov = vectors.data();
+			header.msg_iovlen = vectorCount;
+
+			auto written = ::sendmsg( socketDescriptor, &header, SendFlags );
+			if( written < 0 && errno == EINTR )
+			{
+				continue;
+			}
+
+			// socket buffer full or error - leave everything else to the socket
+			if( written <= 0 )
+			{
+				break;
+			}
+
+			while( written > 0 && index < messages.count() )
+			{
+				const auto remaining = messages[index].size() - offset;
+				if( written >= remaining )
+				{
+					written -= remaining;
+					offset = 0;
+					++index;
+				}
+				else
+				{
+					offset += static_cast<int>( written );
+					written = 0;
+				}
+			}
+		}
+	}
+#endif
+
+	// queue remaining data which is written as soon as the socket becomes writable again
+	for( ; index < messages.count(); ++index )
+	{
+		m_socket->write( messages[index].constData() + offset, messages[index].size() - offset );
+		offset = 0;
 	}
 }
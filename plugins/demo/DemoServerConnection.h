@@ -24,46 +24,75 @@
 
 #pragma once
 
+#include <QElapsedTimer>
+#include <QTimer>
+
 #include "DemoServerProtocol.h"
+#include "DemoUpdateSegment.h"
 
 class DemoServer;
 
-// clazy:excludeall=ctor-missing-parent-argument
-
-// the demo server creates an instance of this class for each client connection,
-// i.e. each client is connected to a different server thread for best
-// performance
-class DemoServerConnection : public QThread
+// the demo server creates an instance of this class for each client connection
+// and moves it to one of its I/O threads, i.e. all clients are served by a small
+// number of threads each running an event loop for many connections
+class DemoServerConnection : public QObject
 {
 	Q_OBJECT
 public:
-	static constexpr int ProtocolRetryTime = 250;
-
 	DemoServerConnection( DemoServer* demoServer, const DemoAuthentication& authentication, quintptr socketDescriptor );
-	~DemoServerConnection() = default;
+	~DemoServerConnection() override;
 
-private:
-	void run() override;
+	// has to be called in the I/O thread the connection has been moved to
+	void start();
 
+private:
 	void processClient();
 	void sendFramebufferUpdate();
+	void resumeFramebufferUpdate();
+	void updateLagState();
+	void setLagging( bool lagging );
+	void writeMessages( const QVector<QByteArray>& messages );
 
 	bool receiveClientMessage();
+	bool receiveRepairRequest();
+
+	void subscribeMulticast();
+	void unsubscribeMulticast();
+	void sendMulticastSynchronization();
+
+	static constexpr int MaximumIOVectorCount = 64;
+
+	// limits for data queued in the socket because the client can't keep up
+	static constexpr qint64 SendBufferHighWatermark = 4*1024*1024;
+	static constexpr qint64 SendBufferLowWatermark = 1024*1024;
 
 	const DemoAuthentication& m_authentication;
 	DemoServer* m_demoServer;
 
 	quintptr m_socketDescriptor;
 	QTcpSocket* m_socket{nullptr};
+	QString m_peerAddress{};
 
 	VncServerClient m_vncServerClient{};
 	DemoServerProtocol* m_serverProtocol{nullptr};
 
 	const QMap<int, int> m_rfbClientToServerMessageSizes;
 
-	int m_keyFrame{-1};
+	DemoUpdateSegmentPointer m_segment{};
 	int m_framebufferUpdateMessageIndex{0};
 
+	// updates are received via multicast and only lost ones are sent through the connection
+	bool m_multicastSubscribed{false};
+
+	// client is a relay which re-serves the stream and therefore receives sequenced messages
+	bool m_relaying{false};
+
 	const int m_framebufferUpdateInterval;
+	const int m_maximumLag;
+
+	bool m_updatePending{false};
+	bool m_lagging{false};
+	QElapsedTimer m_lastCaughtUpTimer{};
+	QTimer m_lagCheckTimer{this};
 
 } ;
@@ -0,0 +1,117 @@
+/*
+ * DemoUpdateSegment.h - declaration of DemoUpdateSegment class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include <vector>
+
+// append-only list of the framebuffer update messages following a key frame -
+// the demo server thread is the only writer while connection threads read all
+// messages up to the published tail without any locking; storage is allocated
+// upfront so that appending never moves messages which are being read
+class DemoUpdateSegment
+{
+public:
+	static constexpr int Capacity = 4096;
+
+	DemoUpdateSegment( int keyFrame, quint32 firstSequence, bool startsWithKeyFrame ) :
+		m_keyFrame( keyFrame ),
+		m_firstSequence( firstSequence ),
+		m_startsWithKeyFrame( startsWithKeyFrame ),
+		m_messages( Capacity )
+	{
+	}
+
+	int keyFrame() const
+	{
+		return m_keyFrame;
+	}
+
+	// whether the first message is a full framebuffer update - otherwise the
+	// segment directly continues the previous one because that one ran full
+	bool startsWithKeyFrame() const
+	{
+		return m_startsWithKeyFrame;
+	}
+
+	// sequence number of the first message, used for multicast distribution
+	quint32 firstSequence() const
+	{
+		return m_firstSequence;
+	}
+
+	// number of messages which are safe to read from any thread
+	int count() const
+	{
+		return m_count.loadAcquire();
+	}
+
+	const QByteArray& message( int index ) const
+	{
+		return m_messages[static_cast<size_t>(index)];
+	}
+
+	bool isFull() const
+	{
+		return m_count.loadAcquire() >= Capacity;
+	}
+
+	// total size of all messages, only to be used by the writer
+	qint64 size() const
+	{
+		return m_size;
+	}
+
+	bool append( const QByteArray& message )
+	{
+		const auto index = m_count.loadAcquire();
+		if( index >= Capacity )
+		{
+			return false;
+		}
+
+		m_messages[static_cast<size_t>(index)] = message;
+		m_size += message.size();
+
+		// publish message to readers
+		m_count.storeRelease( index + 1 );
+
+		return true;
+	}
+
+private:
+	const int m_keyFrame;
+	const quint32 m_firstSequence;
+	const bool m_startsWithKeyFrame;
+	std::vector<QByteArray> m_messages;
+	QAtomicInt m_count{0};
+	qint64 m_size{0};
+
+} ;
+
+using DemoUpdateSegmentPointer = QSharedPointer<DemoUpdateSegment>;
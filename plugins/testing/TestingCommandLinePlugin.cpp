@@ -22,6 +22,9 @@
  *
  */
 
+#include <QBuffer>
+#include <QElapsedTimer>
+
 #include "CommandLineIO.h"
 #include "AccessControlProvider.h"
 #include "TestingCommandLinePlugin.h"
@@ -34,6 +37,9 @@ TestingCommandLinePlugin::TestingCommandLinePlugin( QObject* parent ) :
 { QStringLiteral("authorizedgroups"), QStringLiteral( "check if specified user is in authorized groups [ACCESSING USER]" ) },
 { QStringLiteral("accesscontrolrules"), QStringLiteral( "process access control rules with arguments [ACCESSING USER] [ACCESSING COMPUTER] [LOCAL USER] [LOCAL COMPUTER] [CONNECTED USER] [AUTH METHOD UID]" ) },
 { QStringLiteral("isaccessdeniedbylocalstate"), QStringLiteral( "check if access would be denied by local state") },
+{ QStringLiteral("benchmarkfeaturemessages"), QStringLiteral( "measure encoding and decoding of feature messages with arguments [ITERATIONS]" ) },
+{ QStringLiteral("benchmarkbroadcastencoding"), QStringLiteral( "measure only the encoding (no network I/O) of feature messages sent to many computers with arguments [COMPUTERS] [ITERATIONS]" ) },
+{ QStringLiteral("benchmarkaccess"), QStringLiteral( "measure access checks per second with arguments [ACCESSING USER] [ACCESSING COMPUTER] [CONNECTED USER] [AUTH METHOD UID] [ITERATIONS]" ) },
 				} )
 {
 }
@@ -119,3 +125,180 @@ CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_isaccessd
 
 	return Successful;
 }
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkaccess( const QStringList& arguments )
+{
+	static constexpr int DefaultIterations = 1000;
+
+	const auto iterations = qMax( 1, arguments.value( 4, QString::number( DefaultIterations ) ).toInt() );
+
+	// simulate connections from different masters by constructing a new
+	// provider for every check just like the server does
+	const auto runChecks = [&arguments]( int count ) {
+		QElapsedTimer timer;
+		timer.start();
+
+		for( int i = 0; i < count; ++i )
+		{
+			AccessControlProvider().checkAccess( arguments.value( 0 ), arguments.value( 1 ),
+												 { arguments.value( 2 ) }, arguments.value( 3 ) );
+		}
+
+		return qMax<qint64>( 1, timer.nsecsElapsed() );
+	};
+
+	const auto firstCheckTime = runChecks( 1 );
+	const auto totalTime = runChecks( iterations );
+
+	printf( "[TEST]: BenchmarkAccess: first check took %.3f ms\n", double(firstCheckTime) / 1000000 );
+	printf( "[TEST]: BenchmarkAccess: %d checks took %.3f ms (%.1f checks per second)\n",
+			iterations, double(totalTime) / 1000000, double(iterations) * 1000000000 / double(totalTime) );
+
+	return Successful;
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkfeaturemessages( const QStringList& arguments )
+{
+	static constexpr int DefaultIterations = 10000;
+	static constexpr int FileChunkSize = 256*1024;
+
+	const auto iterations = qMax( 1, arguments.value( 0, QString::number( DefaultIterations ) ).toInt() );
+	const auto featureUid = Feature::Uid::createUuid();
+
+	benchmarkFeatureMessage( QStringLiteral("empty"), FeatureMessage( featureUid, FeatureMessage::DefaultCommand ), iterations );
+
+	FeatureMessage textMessage( featureUid, FeatureMessage::DefaultCommand );
+	textMessage.addArgument( 0, QStringLiteral("Please save your work, the lesson ends in five minutes.") )
+			.addArgument( 1, 1 );
+	benchmarkFeatureMessage( QStringLiteral("text message"), textMessage, iterations );
+
+	FeatureMessage fileChunkMessage( featureUid, FeatureMessage::DefaultCommand );
+	fileChunkMessage.addArgument( 0, QUuid::createUuid() )
+			.addArgument( 1, QByteArray( FileChunkSize, 'x' ) );
+	benchmarkFeatureMessage( QStringLiteral("256 KiB file chunk"), fileChunkMessage, qMax( 1, iterations / 100 ) );
+
+	return Successful;
+}
+
+
+
+void TestingCommandLinePlugin::benchmarkFeatureMessage( const QString& name, const FeatureMessage& message, int iterations )
+{
+	const std::array<std::pair<FeatureMessage::Codec, const char*>, 2> codecs{ {
+		{ FeatureMessage::Codec::DataStream, "DataStream" },
+		{ FeatureMessage::Codec::Binary, "Binary" },
+	} };
+
+	for( const auto& codec : codecs )
+	{
+		QBuffer buffer;
+		buffer.open( QBuffer::ReadWrite );
+
+		QElapsedTimer timer;
+		timer.start();
+
+		for( int i = 0; i < iterations; ++i )
+		{
+			message.send( &buffer, codec.first );
+		}
+
+		const auto encodeTime = timer.nsecsElapsed();
+
+		buffer.seek( 0 );
+		timer.restart();
+
+		FeatureMessage receivedMessage;
+		for( int i = 0; i < iterations; ++i )
+		{
+			receivedMessage.receive( &buffer, codec.first );
+		}
+
+		const auto decodeTime = timer.nsecsElapsed();
+
+		printf( "[TEST]: BenchmarkFeatureMessages: %s (%s): %lld bytes, encode %.3f us, decode %.3f us\n",
+				qUtf8Printable(name), codec.second, buffer.size() / iterations,
+				double(encodeTime) / iterations / 1000, double(decodeTime) / iterations / 1000 );
+
+		if( receivedMessage.arguments() != message.arguments() )
+		{
+			printf( "[TEST]: BenchmarkFeatureMessages: %s (%s): DECODED ARGUMENTS DIFFER\n",
+					qUtf8Printable(name), codec.second );
+		}
+	}
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkbroadcastencoding( const QStringList& arguments )
+{
+	static constexpr int DefaultInterfaces = 500;
+	static constexpr int DefaultIterations = 100;
+	static constexpr int FileChunkSize = 256*1024;
+
+	const auto interfaces = qMax( 1, arguments.value( 0, QString::number( DefaultInterfaces ) ).toInt() );
+	const auto iterations = qMax( 1, arguments.value( 1, QString::number( DefaultIterations ) ).toInt() );
+	const auto featureUid = Feature::Uid::createUuid();
+
+	FeatureMessage textMessage( featureUid, FeatureMessage::DefaultCommand );
+	textMessage.addArgument( 0, QStringLiteral("Please save your work, the lesson ends in five minutes.") )
+			.addArgument( 1, 1 );
+	benchmarkBroadcastEncoding( QStringLiteral("text message"), textMessage, interfaces, iterations );
+
+	FeatureMessage fileChunkMessage( featureUid, FeatureMessage::DefaultCommand );
+	fileChunkMessage.addArgument( 0, QUuid::createUuid() )
+			.addArgument( 1, QByteArray( FileChunkSize, 'x' ) );
+	benchmarkBroadcastEncoding( QStringLiteral("256 KiB file chunk"), fileChunkMessage, interfaces, qMax( 1, iterations / 10 ) );
+
+	return Successful;
+}
+
+
+
+void TestingCommandLinePlugin::benchmarkBroadcastEncoding( const QString& name, const FeatureMessage& message, int interfaces, int iterations )
+{
+	// ComputerControlInterface only sends messages through connected VNC connections,
+	// so this covers the encoding part of FeatureProviderInterface::sendFeatureMessage() only
+	static constexpr auto codec = FeatureMessage::LatestCodec;
+
+	qint64 bytes = 0;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// previous behaviour: every computer encodes the message on its own
+	for( int i = 0; i < iterations; ++i )
+	{
+		for( int j = 0; j < interfaces; ++j )
+		{
+			bytes += EncodedFeatureMessage( message ).data( codec ).size();
+		}
+	}
+
+	const auto perInterfaceTime = timer.nsecsElapsed();
+
+	timer.restart();
+
+	for( int i = 0; i < iterations; ++i )
+	{
+		const EncodedFeatureMessagePointer encodedMessage( new EncodedFeatureMessage( message ) );
+		for( int j = 0; j < interfaces; ++j )
+		{
+			bytes -= encodedMessage->data( codec ).size();
+		}
+	}
+
+	const auto sharedTime = timer.nsecsElapsed();
+
+	printf( "[TEST]: BenchmarkBroadcastEncoding: %s to %d computers (encoding only, no network I/O): encode per computer %.3f ms, encode once %.3f ms\n",
+			qUtf8Printable(name), interfaces,
+			double(perInterfaceTime) / iterations / 1000000, double(sharedTime) / iterations / 1000000 );
+
+	if( bytes != 0 )
+	{
+		printf( "[TEST]: BenchmarkBroadcastEncoding: %s: ENCODED DATA DIFFERS\n", qUtf8Printable(name) );
+	}
+}
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "CommandLinePluginInterface.h"
+#include "EncodedFeatureMessage.h"
 #include "VeyonConfiguration.h"
 
 class TestingCommandLinePlugin : public QObject, CommandLinePluginInterface, PluginInterface
@@ -84,8 +85,14 @@ public Q_SLOTS:
 	CommandLinePluginInterface::RunResult handle_authorizedgroups( const QStringList& arguments );
 	CommandLinePluginInterface::RunResult handle_accesscontrolrules( const QStringList& arguments );
 	CommandLinePluginInterface::RunResult handle_isaccessdeniedbylocalstate( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkaccess( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkfeaturemessages( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkbroadcastencoding( const QStringList& arguments );
 
 private:
+	static void benchmarkFeatureMessage( const QString& name, const FeatureMessage& message, int iterations );
+	static void benchmarkBroadcastEncoding( const QString& name, const FeatureMessage& message, int interfaces, int iterations );
+
 	QMap<QString, QString> m_commands;
 
 };
@@ -0,0 +1,164 @@
+/*
+ * BandwidthShaper.cpp - implementation of the BandwidthShaper class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "BandwidthShaper.h"
+#include "VeyonConfiguration.h"
+
+
+BandwidthShaper::BandwidthShaper( QObject* parent ) :
+	QObject( parent ),
+	m_rate( qMax<qint64>( 0, VeyonCore::config().bandwidthLimit() ) * 1024 )
+{
+	if( isEnabled() == false )
+	{
+		return;
+	}
+
+	static constexpr qint64 MinimumCapacity = 64 * 1024;
+
+	m_capacity = qMax( MinimumCapacity, m_rate * BurstDuration / 1000 );
+	m_tokens = m_capacity;
+
+	const auto reservePercentage = [this]( int value ) {
+		return m_capacity * qBound( 0, value, 100 ) / 100;
+	};
+
+	m_reserves[static_cast<int>(TrafficClass::Interactive)] =
+			reservePercentage( VeyonCore::config().interactiveBandwidthReserve() );
+	m_reserves[static_cast<int>(TrafficClass::FeatureMessages)] =
+			reservePercentage( VeyonCore::config().featureMessagesBandwidthReserve() );
+
+	m_refillTimer.start();
+
+	m_refillTrigger.setInterval( RefillInterval );
+	connect( &m_refillTrigger, &QTimer::timeout, this, [this]() {
+		refill();
+
+		if( m_pendingAcquires && m_tokens > 0 )
+		{
+			m_pendingAcquires = false;
+			Q_EMIT tokensAvailable();
+		}
+
+		if( m_pendingAcquires == false && m_tokens >= m_capacity )
+		{
+			m_refillTrigger.stop();
+		}
+	} );
+
+	vDebug() << "limiting bandwidth to" << m_rate << "bytes per second";
+}
+
+
+
+bool BandwidthShaper::acquire( TrafficClass trafficClass )
+{
+	if( isEnabled() == false )
+	{
+		return true;
+	}
+
+	markActive( trafficClass );
+	refill();
+
+	if( m_tokens > reservedTokens( trafficClass ) )
+	{
+		return true;
+	}
+
+	m_pendingAcquires = true;
+	m_refillTrigger.start();
+
+	return false;
+}
+
+
+
+void BandwidthShaper::consume( TrafficClass trafficClass, qint64 bytes )
+{
+	if( isEnabled() == false )
+	{
+		return;
+	}
+
+	markActive( trafficClass );
+	refill();
+
+	// allow going into debt so that messages larger than the bucket can pass
+	m_tokens -= bytes;
+
+	if( m_refillTrigger.isActive() == false )
+	{
+		m_refillTrigger.start();
+	}
+}
+
+
+
+void BandwidthShaper::markActive( TrafficClass trafficClass )
+{
+	m_lastActivity[static_cast<int>(trafficClass)].restart();
+}
+
+
+
+void BandwidthShaper::refill()
+{
+	const auto elapsed = m_refillTimer.nsecsElapsed();
+	const auto newTokens = m_rate * elapsed / 1000000000;
+
+	// only restart timer if at least one token has been generated in order
+	// to not lose fractions at low rates
+	if( newTokens > 0 )
+	{
+		m_refillTimer.restart();
+		m_tokens = qMin( m_capacity, m_tokens + newTokens );
+	}
+}
+
+
+
+qint64 BandwidthShaper::reservedTokens( TrafficClass trafficClass ) const
+{
+	qint64 reserved = 0;
+
+	for( int i = 0; i < static_cast<int>( trafficClass ); ++i )
+	{
+		if( isActive( TrafficClass(i) ) )
+		{
+			reserved += m_reserves[i];
+		}
+	}
+
+	return reserved;
+}
+
+
+
+bool BandwidthShaper::isActive( TrafficClass trafficClass ) const
+{
+	const auto& lastActivity = m_lastActivity[static_cast<int>(trafficClass)];
+
+	return lastActivity.isValid() && lastActivity.elapsed() < ActivityTimeout;
+}
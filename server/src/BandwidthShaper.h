@@ -0,0 +1,83 @@
+/*
+ * BandwidthShaper.h - header file for the BandwidthShaper class
+ *
+ * Copyright (c) 2021 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "VeyonCore.h"
+
+// token bucket shared by all proxy connections of a server - each traffic class
+// may only drain the bucket down to the amount reserved for the (recently active)
+// classes with higher priority
+class BandwidthShaper : public QObject
+{
+	Q_OBJECT
+public:
+	enum class TrafficClass
+	{
+		Interactive,
+		FeatureMessages,
+		Monitoring,
+		Count
+	} ;
+	Q_ENUM(TrafficClass)
+
+	static constexpr int RefillInterval = 20;
+	static constexpr int BurstDuration = 100;
+	static constexpr int ActivityTimeout = 1000;
+
+	explicit BandwidthShaper( QObject* parent = nullptr );
+
+	bool isEnabled() const
+	{
+		return m_rate > 0;
+	}
+
+	bool acquire( TrafficClass trafficClass );
+	void consume( TrafficClass trafficClass, qint64 bytes );
+	void markActive( TrafficClass trafficClass );
+
+Q_SIGNALS:
+	void tokensAvailable();
+
+private:
+	void refill();
+	qint64 reservedTokens( TrafficClass trafficClass ) const;
+	bool isActive( TrafficClass trafficClass ) const;
+
+	static constexpr auto ClassCount = static_cast<int>( TrafficClass::Count );
+
+	qint64 m_rate{0};
+	qint64 m_capacity{0};
+	qint64 m_tokens{0};
+	std::array<qint64, ClassCount> m_reserves{};
+	std::array<QElapsedTimer, ClassCount> m_lastActivity{};
+
+	bool m_pendingAcquires{false};
+	QElapsedTimer m_refillTimer{};
+	QTimer m_refillTrigger{};
+
+} ;
@@ -34,7 +34,7 @@ ComputerControlClient::ComputerControlClient( ComputerControlServer* server,
 											  int vncServerPort,
 											  const Password& vncServerPassword,
 											  QObject* parent ) :
-	VncProxyConnection( clientSocket, vncServerPort, parent ),
+	VncProxyConnection( clientSocket, vncServerPort, &server->bandwidthShaper(), parent ),
 	m_server( server ),
 	m_serverProtocol( clientSocket,
 					  &m_serverClient,
@@ -65,7 +65,7 @@ bool ComputerControlClient::receiveClientMessage()
 
 	if( messageType == FeatureMessage::RfbMessageType )
 	{
-		return m_server->handleFeatureMessage( socket );
+		return m_server->handleFeatureMessage( socket, m_serverClient.featureMessageCodec() );
 	}
 
 	return VncProxyConnection::receiveClientMessage();
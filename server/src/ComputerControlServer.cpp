@@ -30,6 +30,7 @@
 #include "ComputerControlServer.h"
 #include "FeatureMessage.h"
 #include "HostAddress.h"
+#include "HostAddressResolver.h"
 #include "VeyonConfiguration.h"
 #include "SystemTrayIcon.h"
 
@@ -57,6 +58,18 @@ ComputerControlServer::ComputerControlServer( QObject* parent ) :
 			 this, &ComputerControlServer::showAccessControlMessage );
 
 	connect( &m_vncProxyServer, &VncProxyServer::connectionClosed, this, &ComputerControlServer::updateTrayIconToolTip );
+
+	connect( &VeyonCore::hostAddressResolver(), &HostAddressResolver::lookupFinished, this,
+			 [this]( const QString& name ) {
+				 for( const auto* client : m_vncProxyServer.clients() )
+				 {
+					 if( client->proxyClientSocket()->peerAddress().toString() == name )
+					 {
+						 updateTrayIconToolTip();
+						 break;
+					 }
+				 }
+			 } );
 }
 
 
@@ -101,7 +114,7 @@ VncProxyConnection* ComputerControlServer::createVncProxyConnection( QTcpSocket*
 
 
 
-bool ComputerControlServer::handleFeatureMessage( QTcpSocket* socket )
+bool ComputerControlServer::handleFeatureMessage( QTcpSocket* socket, FeatureMessage::Codec codec )
 {
 	char messageType;
 	if( socket->getChar( &messageType ) == false )
@@ -118,9 +131,18 @@ bool ComputerControlServer::handleFeatureMessage( QTcpSocket* socket )
 		return false;
 	}
 
-	featureMessage.receive( socket );
+	// there's no way to find the start of the next message after an oversized or
+	// malformed one reliably, so drop the connection instead of parsing garbage
+	if( featureMessage.receive( socket, codec ) == false )
+	{
+		vWarning() << "closing connection after receiving malformed feature message";
+		socket->abort();
+		return false;
+	}
+
+	m_featureManager.handleFeatureMessage( *this, MessageContext( socket, codec ), featureMessage );
 
-	return m_featureManager.handleFeatureMessage( *this, MessageContext( socket ), featureMessage );
+	return true;
 }
 
 
@@ -129,10 +151,18 @@ bool ComputerControlServer::sendFeatureMessageReply( const MessageContext& conte
 {
 	vDebug() << reply.featureUid() << reply.command() << reply.arguments();
 
+	const auto bytesQueued = context.ioDevice()->bytesToWrite();
+
 	char rfbMessageType = FeatureMessage::RfbMessageType;
 	context.ioDevice()->write( &rfbMessageType, sizeof(rfbMessageType) );
 
-	return reply.send( context.ioDevice() );
+	const auto result = reply.send( context.ioDevice(), context.codec() );
+
+	// feature messages are never delayed but account for the bandwidth they use
+	m_bandwidthShaper.consume( BandwidthShaper::TrafficClass::FeatureMessages,
+							   qMax<qint64>( 0, context.ioDevice()->bytesToWrite() - bytesQueued ) );
+
+	return result;
 }
 
 
@@ -166,13 +196,15 @@ void ComputerControlServer::showAuthenticationMessage( VncServerClient* client )
 			{
 				m_failedAuthHosts += client->hostAddress();
 
-				const auto fqdn = HostAddress( client->hostAddress() ).tryConvert( HostAddress::Type::FullyQualifiedDomainName );
+				const auto username = client->username();
 
-				VeyonCore::builtinFeatures().systemTrayIcon().showMessage(
-							tr( "Authentication error" ),
-							tr( "User \"%1\" at host \"%2\" attempted to access this computer "
-								"but could not authenticate successfully." ).arg( client->username(), fqdn ),
-							m_featureWorkerManager );
+				resolveHostName( client->hostAddress(), [=]( const QString& fqdn ) {
+					VeyonCore::builtinFeatures().systemTrayIcon().showMessage(
+								tr( "Authentication error" ),
+								tr( "User \"%1\" at host \"%2\" attempted to access this computer "
+									"but could not authenticate successfully." ).arg( username, fqdn ),
+								m_featureWorkerManager );
+				} );
 			}
 		}
 	}
@@ -189,13 +221,15 @@ void ComputerControlServer::showAccessControlMessage( VncServerClient* client )
 
 		if( VeyonCore::config().remoteConnectionNotificationsEnabled() )
 		{
-			const auto fqdn = HostAddress( client->hostAddress() ).tryConvert( HostAddress::Type::FullyQualifiedDomainName );
+			const auto username = client->username();
 
-			VeyonCore::builtinFeatures().systemTrayIcon().showMessage(
-						tr( "Remote access" ),
-						tr( "User \"%1\" at host \"%2\" is now accessing this computer." ).
-						arg( client->username(), fqdn ),
-						m_featureWorkerManager );
+			resolveHostName( client->hostAddress(), [=]( const QString& fqdn ) {
+				VeyonCore::builtinFeatures().systemTrayIcon().showMessage(
+							tr( "Remote access" ),
+							tr( "User \"%1\" at host \"%2\" is now accessing this computer." ).
+							arg( username, fqdn ),
+							m_featureWorkerManager );
+			} );
 		}
 
 		updateTrayIconToolTip();
@@ -212,14 +246,16 @@ void ComputerControlServer::showAccessControlMessage( VncServerClient* client )
 			{
 				m_failedAccessControlHosts += client->hostAddress();
 
-				const auto fqdn = HostAddress( client->hostAddress() ).tryConvert( HostAddress::Type::FullyQualifiedDomainName );
+				const auto username = client->username();
 
-				VeyonCore::builtinFeatures().systemTrayIcon().showMessage(
-							tr( "Access control error" ),
-							tr( "User \"%1\" at host \"%2\" attempted to access this computer "
-								"but has been blocked due to access control settings." ).
-							arg( client->username(), fqdn ),
-							m_featureWorkerManager );
+				resolveHostName( client->hostAddress(), [=]( const QString& fqdn ) {
+					VeyonCore::builtinFeatures().systemTrayIcon().showMessage(
+								tr( "Access control error" ),
+								tr( "User \"%1\" at host \"%2\" attempted to access this computer "
+									"but has been blocked due to access control settings." ).
+								arg( username, fqdn ),
+								m_featureWorkerManager );
+				} );
 			}
 		}
 	}
@@ -227,6 +263,22 @@ void ComputerControlServer::showAccessControlMessage( VncServerClient* client )
 
 
 
+void ComputerControlServer::resolveHostName( const QString& hostAddress,
+											 const std::function<void(const QString&)>& callback )
+{
+	const auto convert = [=]() {
+		callback( HostAddress( hostAddress ).tryConvert( HostAddress::Type::FullyQualifiedDomainName,
+														 HostAddress::LookupMode::CachedOnly ) );
+	};
+
+	if( VeyonCore::hostAddressResolver().lookup( hostAddress, this, convert ) )
+	{
+		convert();
+	}
+}
+
+
+
 void ComputerControlServer::updateTrayIconToolTip()
 {
 	auto toolTip = tr( "%1 Service %2 at %3:%4" ).arg( VeyonCore::applicationName(), VeyonCore::versionString(),
@@ -236,8 +288,10 @@ void ComputerControlServer::updateTrayIconToolTip()
 	QStringList clients;
 	for( const auto* client : m_vncProxyServer.clients() )
 	{
+		// never block on DNS lookups here - tool tip is updated again once lookups have finished
 		const auto clientAddress = HostAddress( client->proxyClientSocket()->peerAddress().toString() );
-		clients.append( clientAddress.tryConvert( HostAddress::Type::FullyQualifiedDomainName ) );
+		clients.append( clientAddress.tryConvert( HostAddress::Type::FullyQualifiedDomainName,
+												  HostAddress::LookupMode::CachedOnly ) );
 	}
 
 	if( clients.isEmpty() == false )
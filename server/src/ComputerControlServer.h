@@ -27,6 +27,7 @@
 #include <QtCore/QMutex>
 #include <QtCore/QStringList>
 
+#include "BandwidthShaper.h"
 #include "FeatureManager.h"
 #include "FeatureWorkerManager.h"
 #include "ServerAuthenticationManager.h"
@@ -60,7 +61,12 @@ public:
 		return m_serverAccessControlManager;
 	}
 
-	bool handleFeatureMessage( QTcpSocket* socket );
+	BandwidthShaper& bandwidthShaper()
+	{
+		return m_bandwidthShaper;
+	}
+
+	bool handleFeatureMessage( QTcpSocket* socket, FeatureMessage::Codec codec );
 
 	bool sendFeatureMessageReply( const MessageContext& context, const FeatureMessage& reply ) override;
 
@@ -79,6 +85,8 @@ private:
 	void showAuthenticationMessage( VncServerClient* client );
 	void showAccessControlMessage( VncServerClient* client );
 
+	void resolveHostName( const QString& hostAddress, const std::function<void(const QString&)>& callback );
+
 	void updateTrayIconToolTip();
 
 	QMutex m_dataMutex{};
@@ -93,6 +101,8 @@ private:
 	ServerAuthenticationManager m_serverAuthenticationManager;
 	ServerAccessControlManager m_serverAccessControlManager;
 
+	BandwidthShaper m_bandwidthShaper{};
+
 	VncServer m_vncServer{};
 	VncProxyServer m_vncProxyServer;
 
@@ -26,6 +26,8 @@
 #include "AccessControlProvider.h"
 #include "AuthenticationManager.h"
 #include "DesktopAccessDialog.h"
+#include "HostAddress.h"
+#include "HostAddressResolver.h"
 #include "VeyonConfiguration.h"
 
 
@@ -70,6 +72,7 @@ void ServerAccessControlManager::addClient( VncServerClient* client )
 void ServerAccessControlManager::removeClient( VncServerClient* client )
 {
 	m_clients.removeAll( client );
+	m_waitingClients.removeAll( client );
 
 	// force all remaining clients to pass access control again as conditions might
 	// have changed (e.g. AccessControlRule::Condition::AccessFromAlreadyConnectedUser)
@@ -95,29 +98,27 @@ void ServerAccessControlManager::removeClient( VncServerClient* client )
 
 void ServerAccessControlManager::performAccessControl( VncServerClient* client )
 {
-	// implement access control wait for connections other than the one an
-	// access dialog is currently active for
-	switch( client->accessControlState() )
+	// access control rules may query host names of the accessing and the local computer - resolve
+	// them asynchronously for new connections so we never block on DNS lookups
+	const auto waitForLookups = client->protocolState() == VncServerProtocol::State::AccessControl;
+
+	auto resolved = resolveHostAddress( client->hostAddress(), client, waitForLookups );
+	resolved &= resolveHostAddress( HostAddress::localFQDN(), client, waitForLookups );
+
+	if( resolved == false && waitForLookups )
 	{
-	case VncServerClient::AccessControlState::Init:
-		client->accessControlTimer().restart();
-		break;
-	case VncServerClient::AccessControlState::Waiting:
-		if( client->accessControlTimer().elapsed() < ClientWaitInterval )
-		{
-			return;
-		}
-		client->accessControlTimer().restart();
-		break;
-	default:
-		break;
+		client->setAccessControlState( VncServerClient::AccessControlState::Waiting );
+		return;
 	}
 
+	// existing connections being checked again can't wait, so only fall back to
+	// blocking lookups if cache entries have been evicted in the meantime
 	const auto accessResult =
-			AccessControlProvider().checkAccess( client->username(),
-												 client->hostAddress(),
-												 connectedUsers(),
-												 client->authMethodUid() );
+			AccessControlProvider( resolved ? HostAddress::LookupMode::CachedOnly : HostAddress::LookupMode::Blocking )
+				.checkAccess( client->username(),
+							  client->hostAddress(),
+							  connectedUsers(),
+							  client->authMethodUid() );
 
 	switch( accessResult )
 	{
@@ -140,6 +141,48 @@ void ServerAccessControlManager::performAccessControl( VncServerClient* client )
 
 
 
+bool ServerAccessControlManager::resolveHostAddress( const QString& address, VncServerClient* client, bool waitForLookup )
+{
+	auto& resolver = VeyonCore::hostAddressResolver();
+
+	const auto lookup = [&]( const QString& name ) {
+		if( waitForLookup )
+		{
+			return resolver.lookup( name, client, [client]() {
+				client->setAccessControlState( VncServerClient::AccessControlState::Init );
+			} );
+		}
+		return resolver.isCached( name );
+	};
+
+	const HostAddress hostAddress( address );
+
+	switch( hostAddress.type() )
+	{
+	case HostAddress::Type::IpAddress:
+		return lookup( address );
+
+	case HostAddress::Type::HostName:
+	{
+		// host names are converted to an FQDN via their IP address
+		if( lookup( address ) == false )
+		{
+			return false;
+		}
+
+		const auto ipAddress = hostAddress.convert( HostAddress::Type::IpAddress, HostAddress::LookupMode::CachedOnly );
+		return ipAddress.isEmpty() || lookup( ipAddress );
+	}
+
+	default:
+		break;
+	}
+
+	return true;
+}
+
+
+
 VncServerClient::AccessControlState ServerAccessControlManager::confirmDesktopAccess( VncServerClient* client )
 {
 	const HostUserPair hostUserPair( client->username(), client->hostAddress() );
@@ -158,7 +201,11 @@ VncServerClient::AccessControlState ServerAccessControlManager::confirmDesktopAc
 	// already an access dialog running?
 	if( m_desktopAccessDialog.isBusy( &m_featureWorkerManager ) )
 	{
-		// then close connection so that client has to try again later
+		// then let client wait until the active dialog has finished
+		if( m_waitingClients.contains( client ) == false )
+		{
+			m_waitingClients.append( client );
+		}
 		return VncServerClient::AccessControlState::Waiting;
 	}
 
@@ -209,6 +256,15 @@ void ServerAccessControlManager::finishDesktopAccessConfirmation( VncServerClien
 		client->setAccessControlState( VncServerClient::AccessControlState::Failed );
 		client->setProtocolState( VncServerProtocol::State::Close );
 	}
+
+	// make waiting clients retry access control, which notifies their connections
+	const auto waitingClients = m_waitingClients;
+	m_waitingClients.clear();
+
+	for( auto waitingClient : waitingClients )
+	{
+		waitingClient->setAccessControlState( VncServerClient::AccessControlState::Init );
+	}
 }
 
 
@@ -45,9 +45,8 @@ Q_SIGNALS:
 	void finished( VncServerClient* client );
 
 private:
-	static constexpr int ClientWaitInterval = 1000;
-
 	void performAccessControl( VncServerClient* client );
+	bool resolveHostAddress( const QString& address, VncServerClient* client, bool waitForLookup );
 	VncServerClient::AccessControlState confirmDesktopAccess( VncServerClient* client );
 	void finishDesktopAccessConfirmation( VncServerClient* client );
 
@@ -57,6 +56,7 @@ private:
 	DesktopAccessDialog& m_desktopAccessDialog;
 
 	VncServerClientList m_clients{};
+	VncServerClientList m_waitingClients{};
 
 	using HostUserPair = QPair<QString, QString>;
 	using DesktopAccessChoiceMap = QMap<HostUserPair, DesktopAccessDialog::Choice>;
@@ -22,6 +22,11 @@
  *
  */
 
+#include <QBuffer>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QtConcurrent>
+
 #include "AuthenticationManager.h"
 #include "ServerAuthenticationManager.h"
 #include "VeyonConfiguration.h"
@@ -44,17 +49,95 @@ void ServerAuthenticationManager::processAuthenticationMessage( VncServerClient*
 
 	auto authPlugin = VeyonCore::authenticationManager().plugins().value( client->authMethodUid() );
 
-	if( authPlugin &&
-		VeyonCore::authenticationManager().isEnabled( client->authMethodUid() ) )
+	if( authPlugin == nullptr ||
+		VeyonCore::authenticationManager().isEnabled( client->authMethodUid() ) == false )
 	{
-		client->setAuthState( authPlugin->performAuthentication( client, message ) );
+		finishStage( client, VncServerClient::AuthState::Failed );
+		return;
 	}
-	else
+
+	const auto messageData = message.data();
+
+	if( authPlugin->isReentrant() == false )
 	{
-		client->setAuthState( VncServerClient::AuthState::Failed );
+		// plugin may access shared state which is not safe to use from other threads
+		const auto result = performStage( authPlugin, client, messageData );
+
+		message.ioDevice()->write( result.replies );
+
+		finishStage( client, result.authState );
+		return;
 	}
 
-	switch( client->authState() )
+	// authentication plugins may perform expensive crypto operations or block while
+	// talking to external services, so run the current stage in a worker thread on
+	// a detached copy of the client and collect all replies in a buffer
+	QSharedPointer<VncServerClient> stageClient( new VncServerClient, &QObject::deleteLater );
+	stageClient->setAuthState( client->authState() );
+	stageClient->setAuthMethodUid( client->authMethodUid() );
+	stageClient->setUsername( client->username() );
+	stageClient->setHostAddress( client->hostAddress() );
+	stageClient->setChallenge( client->challenge() );
+	stageClient->setPrivateKey( client->privateKey() );
+
+	const QPointer<VncServerClient> clientPointer( client );
+	const QPointer<QIODevice> socket( message.ioDevice() );
+
+	client->setAuthState( VncServerClient::AuthState::Pending );
+
+	auto watcher = new QFutureWatcher<StageResult>( this );
+
+	connect( watcher, &QFutureWatcherBase::finished, this, [=]() {
+		watcher->deleteLater();
+
+		// connection closed in the meantime?
+		if( clientPointer.isNull() || socket.isNull() )
+		{
+			return;
+		}
+
+		const auto result = watcher->result();
+
+		socket->write( result.replies );
+
+		clientPointer->setUsername( stageClient->username() );
+		clientPointer->setChallenge( stageClient->challenge() );
+		clientPointer->setPrivateKey( stageClient->privateKey() );
+
+		finishStage( clientPointer, result.authState );
+	} );
+
+	watcher->setFuture( QtConcurrent::run( &m_threadPool, [=]() {
+		return performStage( authPlugin, stageClient.data(), messageData );
+	} ) );
+}
+
+
+
+ServerAuthenticationManager::StageResult ServerAuthenticationManager::performStage( const AuthenticationPluginInterface* authPlugin,
+																					 VncServerClient* client,
+																					 const QByteArray& messageData )
+{
+	QBuffer replyBuffer;
+	replyBuffer.open( QBuffer::WriteOnly );
+
+	VariantArrayMessage stageMessage( &replyBuffer, messageData );
+
+	StageResult result;
+	result.authState = authPlugin->performAuthentication( client, stageMessage );
+	result.replies = replyBuffer.data();
+
+	return result;
+}
+
+
+
+void ServerAuthenticationManager::finishStage( VncServerClient* client, VncServerClient::AuthState authState )
+{
+	// changing the state resumes the protocol state machine of the client
+	client->setAuthState( authState );
+
+	switch( authState )
 	{
 	case VncServerClient::AuthState::Failed:
 	case VncServerClient::AuthState::Successful:
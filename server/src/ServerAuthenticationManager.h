@@ -26,9 +26,11 @@
 
 #include <QMutex>
 #include <QStringList>
+#include <QThreadPool>
 
 #include "VncServerClient.h"
 
+class AuthenticationPluginInterface;
 class VariantArrayMessage;
 
 class ServerAuthenticationManager : public QObject
@@ -50,4 +52,18 @@ public:
 Q_SIGNALS:
 	void finished( VncServerClient* client );
 
+private:
+	struct StageResult
+	{
+		VncServerClient::AuthState authState{VncServerClient::AuthState::Failed};
+		QByteArray replies{};
+	};
+
+	static StageResult performStage( const AuthenticationPluginInterface* authPlugin,
+									 VncServerClient* client,
+									 const QByteArray& messageData );
+	void finishStage( VncServerClient* client, VncServerClient::AuthState authState );
+
+	QThreadPool m_threadPool{};
+
 } ;
@@ -25,19 +25,21 @@
 #include <QBuffer>
 #include <QHostAddress>
 #include <QTcpSocket>
-#include <QTimer>
 
 #include "VncClientProtocol.h"
 #include "VncProxyConnection.h"
+#include "VncServerClient.h"
 #include "VncServerProtocol.h"
 
 VncProxyConnection::VncProxyConnection( QTcpSocket* clientSocket,
 										int vncServerPort,
+										BandwidthShaper* bandwidthShaper,
 										QObject* parent ) :
 	QObject( parent ),
 	m_vncServerPort( vncServerPort ),
 	m_proxyClientSocket( clientSocket ),
 	m_vncServerSocket( new QTcpSocket( this ) ),
+	m_bandwidthShaper( bandwidthShaper ),
 	m_rfbClientToServerMessageSizes( {
 		{ rfbSetPixelFormat, sz_rfbSetPixelFormatMsg },
 		{ rfbFramebufferUpdateRequest, sz_rfbFramebufferUpdateRequestMsg },
@@ -51,6 +53,23 @@ VncProxyConnection::VncProxyConnection( QTcpSocket* clientSocket,
 
 	connect( m_vncServerSocket, &QTcpSocket::disconnected, this, &VncProxyConnection::clientConnectionClosed );
 	connect( m_proxyClientSocket, &QTcpSocket::disconnected, this, &VncProxyConnection::serverConnectionClosed );
+
+	m_setupTimer.start();
+
+	if( m_bandwidthShaper )
+	{
+		connect( m_bandwidthShaper, &BandwidthShaper::tokensAvailable, this, [this]() {
+			if( m_serverReadThrottled )
+			{
+				m_serverReadThrottled = false;
+
+				// let socket receive data from the network again
+				m_vncServerSocket->setReadBufferSize( 0 );
+
+				readFromServer();
+			}
+		} );
+	}
 }
 
 
@@ -69,6 +88,11 @@ VncProxyConnection::~VncProxyConnection()
 
 void VncProxyConnection::start()
 {
+	// continue protocol processing as soon as external dependencies such as
+	// authentication or access control change the state of the client
+	connect( serverProtocol().client(), &VncServerClient::stateChanged,
+			 this, &VncProxyConnection::readFromClient, Qt::QueuedConnection );
+
 	serverProtocol().start();
 }
 
@@ -82,22 +106,23 @@ void VncProxyConnection::readFromClient()
 		{
 		}
 
-		// try again later in case we could not proceed because of
-		// external protocol dependencies or in case we're finished
-		// and already have RFB messages in receive queue
-		readFromClientLater();
+		// did we just finish the handshake? then forward data which the
+		// server might have sent in the meantime
+		if( serverProtocol().state() == VncServerProtocol::State::Running )
+		{
+			readFromServer();
+		}
 	}
-	else if( clientProtocol().state() == VncClientProtocol::State::Running )
+
+	// process RFB messages already in receive queue - if client connection is not yet
+	// ready, readFromServer() calls us again once the client protocol is running
+	if( serverProtocol().state() == VncServerProtocol::State::Running &&
+		clientProtocol().state() == VncClientProtocol::State::Running )
 	{
 		while( receiveClientMessage() )
 		{
 		}
 	}
-	else
-	{
-		// try again as client connection is not yet ready and we can't forward data
-		readFromClientLater();
-	}
 
 	if( serverProtocol().state() == VncServerProtocol::State::FramebufferInit &&
 		clientProtocol().state() == VncClientProtocol::State::Disconnected )
@@ -118,16 +143,14 @@ void VncProxyConnection::readFromServer()
 		{
 		}
 
-		// did we finish client protocol initialization? then we must not miss this
-		// read signaĺ from server but process it as the server is still waiting
-		// for our response
+		// did we finish client protocol initialization? then we have the server
+		// init message which we can forward to the real client which is still
+		// waiting in framebuffer init state
 		if( clientProtocol().state() == VncClientProtocol::State::Running )
 		{
-			// if client protocol is running we have the server init message which
-			// we can forward to the real client
 			serverProtocol().setServerInitMessage( clientProtocol().serverInitMessage() );
 
-			readFromServerLater();
+			readFromClient();
 		}
 	}
 	else if( serverProtocol().state() == VncServerProtocol::State::Running )
@@ -136,11 +159,8 @@ void VncProxyConnection::readFromServer()
 		{
 		}
 	}
-	else
-	{
-		// try again as server connection is not yet ready and we can't forward data
-		readFromServerLater();
-	}
+
+	// otherwise keep data in socket buffer until readFromClient() finishes the server protocol
 }
 
 
@@ -177,20 +197,6 @@ bool VncProxyConnection::forwardDataToServer( qint64 size )
 
 
 
-void VncProxyConnection::readFromServerLater()
-{
-	QTimer::singleShot( ProtocolRetryTime, this, &VncProxyConnection::readFromServer );
-}
-
-
-
-void VncProxyConnection::readFromClientLater()
-{
-	QTimer::singleShot( ProtocolRetryTime, this, &VncProxyConnection::readFromClient );
-}
-
-
-
 bool VncProxyConnection::receiveClientMessage()
 {
 	auto socket = proxyClientSocket();
@@ -216,7 +222,12 @@ bool VncProxyConnection::receiveClientMessage()
 					socket->close();
 					return false;
 				}
-				return forwardDataToServer( sz_rfbSetEncodingsMsg + nEncodings * sizeof(uint32_t) );
+				const qint64 messageSize = sz_rfbSetEncodingsMsg + nEncodings * sizeof(uint32_t);
+				if( socket->bytesAvailable() >= messageSize )
+				{
+					updateTrafficClass( socket->peek( messageSize ) );
+				}
+				return forwardDataToServer( messageSize );
 			}
 		}
 		break;
@@ -229,6 +240,13 @@ bool VncProxyConnection::receiveClientMessage()
 			return false;
 		}
 
+		if( ( messageType == rfbKeyEvent || messageType == rfbPointerEvent ) && m_bandwidthShaper )
+		{
+			// user input implies an interactive session regardless of the negotiated encodings
+			m_trafficClass = TrafficClass::Interactive;
+			m_bandwidthShaper->markActive( m_trafficClass );
+		}
+
 		return forwardDataToServer( m_rfbClientToServerMessageSizes[messageType] );
 	}
 
@@ -239,12 +257,61 @@ bool VncProxyConnection::receiveClientMessage()
 
 bool VncProxyConnection::receiveServerMessage()
 {
+	if( m_vncServerSocket->bytesAvailable() <= 0 )
+	{
+		return false;
+	}
+
+	if( m_bandwidthShaper && m_bandwidthShaper->acquire( m_trafficClass ) == false )
+	{
+		// leave data in socket buffer until shaper signals available tokens and limit the
+		// buffer so that the socket stops reading and TCP flow control slows down the sender
+		m_serverReadThrottled = true;
+		m_vncServerSocket->setReadBufferSize( ThrottledReadBufferSize );
+		return false;
+	}
+
 	if( clientProtocol().receiveMessage() )
 	{
-		m_proxyClientSocket->write( clientProtocol().lastMessage() );
+		const auto& message = clientProtocol().lastMessage();
+
+		m_proxyClientSocket->write( message );
+
+		if( m_setupFinished == false && clientProtocol().lastMessageType() == rfbFramebufferUpdate )
+		{
+			m_setupFinished = true;
+			Q_EMIT setupFinished( m_setupTimer.elapsed() );
+		}
+
+		if( m_bandwidthShaper )
+		{
+			m_bandwidthShaper->consume( m_trafficClass, message.size() );
+		}
 
 		return true;
 	}
 
 	return false;
 }
+
+
+
+void VncProxyConnection::updateTrafficClass( const QByteArray& setEncodingsMessage )
+{
+	// remote control sessions (VncConnection::Quality::RemoteControl) request cursor
+	// pseudo encodings while monitoring connections do not
+	const auto encodings = setEncodingsMessage.constData() + sz_rfbSetEncodingsMsg;
+	const auto encodingCount = ( setEncodingsMessage.size() - sz_rfbSetEncodingsMsg ) / int(sizeof(uint32_t));
+
+	for( int i = 0; i < encodingCount; ++i )
+	{
+		const auto encoding = qFromBigEndian<uint32_t>( encodings + i * int(sizeof(uint32_t)) );
+		if( encoding == rfbEncodingXCursor || encoding == rfbEncodingRichCursor )
+		{
+			m_trafficClass = TrafficClass::Interactive;
+			return;
+		}
+	}
+
+	m_trafficClass = TrafficClass::Monitoring;
+}
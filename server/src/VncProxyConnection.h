@@ -24,7 +24,9 @@
 
 #pragma once
 
-#include "VeyonCore.h"
+#include <QElapsedTimer>
+
+#include "BandwidthShaper.h"
 
 class QBuffer;
 class QTcpSocket;
@@ -36,7 +38,10 @@ class VncProxyConnection : public QObject
 {
 	Q_OBJECT
 public:
-	VncProxyConnection( QTcpSocket* clientSocket, int vncServerPort, QObject* parent );
+	using TrafficClass = BandwidthShaper::TrafficClass;
+
+	VncProxyConnection( QTcpSocket* clientSocket, int vncServerPort,
+						BandwidthShaper* bandwidthShaper, QObject* parent );
 	~VncProxyConnection() override;
 
 	void start();
@@ -51,6 +56,11 @@ public:
 		return m_vncServerSocket;
 	}
 
+	TrafficClass trafficClass() const
+	{
+		return m_trafficClass;
+	}
+
 protected Q_SLOTS:
 	void readFromClient();
 	void readFromServer();
@@ -59,27 +69,39 @@ protected:
 	bool forwardDataToClient( qint64 size );
 	bool forwardDataToServer( qint64 size );
 
-	void readFromServerLater();
-	void readFromClientLater();
-
 	virtual bool receiveClientMessage();
 	virtual bool receiveServerMessage();
 
+	BandwidthShaper* bandwidthShaper() const
+	{
+		return m_bandwidthShaper;
+	}
+
+	void updateTrafficClass( const QByteArray& setEncodingsMessage );
+
 	virtual VncClientProtocol& clientProtocol() = 0;
 	virtual VncServerProtocol& serverProtocol() = 0;
 
 private:
-	static constexpr int ProtocolRetryTime = 250;
+	static constexpr qint64 ThrottledReadBufferSize = 64*1024;
 
 	const int m_vncServerPort;
 
 	QTcpSocket* m_proxyClientSocket;
 	QTcpSocket* m_vncServerSocket;
 
+	BandwidthShaper* m_bandwidthShaper;
+	TrafficClass m_trafficClass{TrafficClass::Monitoring};
+	bool m_serverReadThrottled{false};
+
+	QElapsedTimer m_setupTimer{};
+	bool m_setupFinished{false};
+
 	const QMap<int, int> m_rfbClientToServerMessageSizes;
 
 Q_SIGNALS:
 	void clientConnectionClosed();
 	void serverConnectionClosed();
+	void setupFinished( qint64 latency );
 
 } ;
@@ -103,6 +103,10 @@ void VncProxyServer::acceptConnection()
 
 	connect( connection, &VncProxyConnection::clientConnectionClosed, this, [=]() { closeConnection( connection ); } );
 	connect( connection, &VncProxyConnection::serverConnectionClosed, this, [=]() { closeConnection( connection ); } );
+	connect( connection, &VncProxyConnection::setupFinished, this, [=]( qint64 latency ) {
+		m_connectionSetupLatency.add( latency );
+		vDebug() << m_connectionSetupLatency.toString();
+	} );
 
 	connection->start();
 
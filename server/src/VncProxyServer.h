@@ -28,6 +28,7 @@
 #include <QVector>
 
 #include "CryptoCore.h"
+#include "LatencyHistogram.h"
 
 class QTcpServer;
 class VncProxyConnection;
@@ -54,6 +55,11 @@ public:
 		return m_connections;
 	}
 
+	const LatencyHistogram& connectionSetupLatency() const
+	{
+		return m_connectionSetupLatency;
+	}
+
 Q_SIGNALS:
 	void connectionClosed( VncProxyConnection* connection );
 
@@ -69,5 +75,6 @@ private:
 	QTcpServer* m_server;
 	VncProxyConnectionFactory* m_connectionFactory;
 	VncProxyConnectionList m_connections;
+	LatencyHistogram m_connectionSetupLatency{QStringLiteral("connection setup latency")};
 
 } ;
@@ -45,7 +45,8 @@ VncServer::VncServer( QObject* parent ) :
 
 	VncServerPluginInterfaceList defaultVncServerPlugins;
 
-	for( auto pluginObject : qAsConst( VeyonCore::pluginManager().pluginObjects() ) )
+	const auto pluginObjects = VeyonCore::pluginManager().pluginObjects( VncServerPluginInterface_iid );
+	for( auto pluginObject : pluginObjects )
 	{
 		auto pluginInterface = qobject_cast<PluginInterface *>( pluginObject );
 		auto vncServerPluginInterface = qobject_cast<VncServerPluginInterface *>( pluginObject );
@@ -23,15 +23,14 @@
  */
 
 #include <QCoreApplication>
-#include <QHostAddress>
 
 #include "FeatureManager.h"
+#include "FeatureWorkerManager.h"
 #include "FeatureWorkerManagerConnection.h"
-#include "VeyonConfiguration.h"
 
 
 FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInterface& worker,
-																FeatureManager& featureManager,
+																FeatureManager* featureManager,
 																Feature::Uid featureUid,
 																QObject* parent ) :
 	QObject( parent ),
@@ -42,13 +41,13 @@ FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInter
 {
 	connect( &m_connectTimer, &QTimer::timeout, this, &FeatureWorkerManagerConnection::tryConnection );
 
-	connect( &m_socket, &QTcpSocket::connected,
+	connect( &m_socket, &QLocalSocket::connected,
 			 this, &FeatureWorkerManagerConnection::sendInitMessage );
 
-	connect( &m_socket, &QTcpSocket::disconnected,
+	connect( &m_socket, &QLocalSocket::disconnected,
 			 QCoreApplication::instance(), &QCoreApplication::quit );
 
-	connect( &m_socket, &QTcpSocket::readyRead,
+	connect( &m_socket, &QLocalSocket::readyRead,
 			 this, &FeatureWorkerManagerConnection::receiveMessage );
 
 	tryConnection();
@@ -58,20 +57,20 @@ FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInter
 
 bool FeatureWorkerManagerConnection::sendMessage( const FeatureMessage& message )
 {
-	return message.send( &m_socket );
+	return message.send( &m_socket, FeatureMessage::LatestCodec );
 }
 
 
 
 void FeatureWorkerManagerConnection::tryConnection()
 {
-	if( m_socket.state() != QTcpSocket::ConnectedState )
+	if( m_socket.state() != QLocalSocket::ConnectedState )
 	{
-		const auto port = quint16( VeyonCore::config().featureWorkerManagerPort() + VeyonCore::sessionId() );
+		const auto serverName = FeatureWorkerManager::serverName();
 
-		vDebug() << "connecting to FeatureWorkerManager at port" << port;
+		vDebug() << "connecting to FeatureWorkerManager at" << serverName;
 
-		m_socket.connectToHost( QHostAddress::LocalHost, port );
+		m_socket.connectToServer( serverName );
 		m_connectTimer.start( ConnectTimeout );
 	}
 }
@@ -84,7 +83,16 @@ void FeatureWorkerManagerConnection::sendInitMessage()
 
 	m_connectTimer.stop();
 
-	FeatureMessage( m_featureUid, FeatureMessage::InitCommand ).send( &m_socket );
+	// make sure not to talk to a server impersonating the Veyon Server
+	if( FeatureWorkerManager::isTrustedPeer( &m_socket ) == false )
+	{
+		vCritical() << "FeatureWorkerManager is not trusted";
+		m_socket.abort();
+		QCoreApplication::quit();
+		return;
+	}
+
+	FeatureMessage( m_featureUid, FeatureMessage::InitCommand ).send( &m_socket, FeatureMessage::LatestCodec );
 }
 
 
@@ -95,9 +103,27 @@ void FeatureWorkerManagerConnection::receiveMessage()
 
 	while( featureMessage.isReadyForReceive( &m_socket ) )
 	{
-		if( featureMessage.receive( &m_socket ) )
+		if( featureMessage.receive( &m_socket, FeatureMessage::LatestCodec ) == false )
+		{
+			continue;
+		}
+
+		if( m_featureManager == nullptr )
+		{
+			// idle pooled worker waiting for a feature to be assigned
+			if( featureMessage.command() == FeatureMessage::InitCommand )
+			{
+				m_featureUid = featureMessage.featureUid();
+				Q_EMIT featureAssigned( m_featureUid );
+			}
+			else
+			{
+				vWarning() << "ignoring message for feature" << featureMessage.featureUid() << "as no feature has been assigned yet";
+			}
+		}
+		else
 		{
-			m_featureManager.handleFeatureMessage( m_worker, featureMessage );
+			m_featureManager->handleFeatureMessage( m_worker, featureMessage );
 		}
 	}
 }
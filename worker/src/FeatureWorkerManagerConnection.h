@@ -24,7 +24,7 @@
 
 #pragma once
 
-#include <QTcpSocket>
+#include <QLocalSocket>
 #include <QTimer>
 
 #include "Feature.h"
@@ -38,13 +38,21 @@ class FeatureWorkerManagerConnection : public QObject
 	Q_OBJECT
 public:
 	FeatureWorkerManagerConnection( VeyonWorkerInterface& worker,
-									FeatureManager& featureManager,
+									FeatureManager* featureManager,
 									Feature::Uid featureUid,
 									QObject* parent = nullptr );
 
 
 	bool sendMessage( const FeatureMessage& message );
 
+	void setFeatureManager( FeatureManager* featureManager )
+	{
+		m_featureManager = featureManager;
+	}
+
+Q_SIGNALS:
+	void featureAssigned( Feature::Uid featureUid );
+
 private:
 	static constexpr auto ConnectTimeout = 3000;
 
@@ -53,8 +61,8 @@ private:
 	void receiveMessage();
 
 	VeyonWorkerInterface& m_worker;
-	FeatureManager& m_featureManager;
-	QTcpSocket m_socket;
+	FeatureManager* m_featureManager;
+	QLocalSocket m_socket;
 	Feature::Uid m_featureUid;
 	QTimer m_connectTimer{this};
 
@@ -29,15 +29,41 @@
 #include "VeyonWorker.h"
 
 
-VeyonWorker::VeyonWorker( const QString& featureUid, QObject* parent ) :
+VeyonWorker::VeyonWorker( const QString& uid, Mode mode, QObject* parent ) :
 	QObject( parent ),
 	m_core( QCoreApplication::instance(),
 			VeyonCore::Component::Worker,
-			QStringLiteral( "FeatureWorker-" ) + VeyonCore::formattedUuid( featureUid ) )
+			mode == Mode::Pooled ? QStringLiteral( "FeatureWorker-Pool" ) :
+								   QStringLiteral( "FeatureWorker-" ) + VeyonCore::formattedUuid( uid ) )
 {
+	if( mode == Mode::Feature )
+	{
+		initFeature( Feature::Uid( uid ) );
+	}
+
+	// pooled workers register with their token until a feature gets assigned
+	m_workerManagerConnection = new FeatureWorkerManagerConnection( *this, m_featureManager, Feature::Uid( uid ), this );
+
+	connect( m_workerManagerConnection, &FeatureWorkerManagerConnection::featureAssigned,
+			 this, &VeyonWorker::initFeature );
+}
+
+
+
+bool VeyonWorker::sendFeatureMessageReply( const FeatureMessage& reply )
+{
+	return m_workerManagerConnection->sendMessage( reply );
+}
+
+
+
+void VeyonWorker::initFeature( Feature::Uid featureUid )
+{
+	m_featureManager = new FeatureManager( featureUid, this );
+
 	const Feature* workerFeature = nullptr;
 
-	for( const auto& feature : m_featureManager.features() )
+	for( const auto& feature : m_featureManager->features() )
 	{
 		if( feature.uid() == featureUid )
 		{
@@ -50,19 +76,15 @@ VeyonWorker::VeyonWorker( const QString& featureUid, QObject* parent ) :
 		qFatal( "Could not find specified feature" );
 	}
 
-	if( VeyonCore::config().disabledFeatures().contains( featureUid ) )
+	if( VeyonCore::config().disabledFeatures().contains( featureUid.toString() ) )
 	{
 		qFatal( "Specified feature is disabled by configuration!" );
 	}
 
-	m_workerManagerConnection = new FeatureWorkerManagerConnection( *this, m_featureManager, featureUid, this );
+	if( m_workerManagerConnection )
+	{
+		m_workerManagerConnection->setFeatureManager( m_featureManager );
+	}
 
 	vInfo() << "Running worker for feature" << workerFeature->name();
 }
-
-
-
-bool VeyonWorker::sendFeatureMessageReply( const FeatureMessage& reply )
-{
-	return m_workerManagerConnection->sendMessage( reply );
-}
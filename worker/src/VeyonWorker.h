@@ -33,7 +33,12 @@ class VeyonWorker : public QObject, VeyonWorkerInterface
 {
 	Q_OBJECT
 public:
-	explicit VeyonWorker( const QString& featureUid, QObject* parent = nullptr );
+	enum class Mode {
+		Feature,
+		Pooled
+	};
+
+	explicit VeyonWorker( const QString& uid, Mode mode = Mode::Feature, QObject* parent = nullptr );
 
 	bool sendFeatureMessageReply( const FeatureMessage& reply ) override;
 
@@ -43,8 +48,10 @@ public:
 	}
 
 private:
+	void initFeature( Feature::Uid featureUid );
+
 	VeyonCore m_core;
-	FeatureManager m_featureManager{};
+	FeatureManager* m_featureManager{nullptr};
 	FeatureWorkerManagerConnection* m_workerManagerConnection{nullptr};
 
 } ;
@@ -24,6 +24,7 @@
 
 #include <QApplication>
 
+#include "FeatureWorkerManager.h"
 #include "VeyonWorker.h"
 
 
@@ -39,6 +40,20 @@ int main( int argc, char **argv )
 		qFatal( "Not enough arguments (feature)" );
 	}
 
+	// pooled workers initialize in advance and get a feature assigned later on
+	if( arguments[1] == FeatureWorkerManager::poolWorkerArgument() )
+	{
+		const auto token = arguments.value( 2 );
+		if( QUuid( token ).isNull() )
+		{
+			qFatal( "Invalid pool token given" );
+		}
+
+		VeyonWorker worker( token, VeyonWorker::Mode::Pooled );
+
+		return worker.core().exec();
+	}
+
 	const auto featureUid = arguments[1];
 	if( QUuid( featureUid ).isNull() )
 	{